@@ -0,0 +1,46 @@
+#pragma once
+
+#include <KIT/KXF/KXFAnimation.hpp>
+#include <KIT/KXF/KXFSkeleton.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace clips
+{
+  /** Tolerated errors of a reduced animation: position in scene units, rotation in radians, scale as a factor */
+  struct ReductionSettings
+  {
+    float position = 0.001f;
+    float rotation = 0.001f;
+    float scale = 0.0001f;
+  };
+
+  struct ReductionStatistics
+  {
+    uint64_t keysBefore = 0;
+    uint64_t keysAfter = 0;
+
+    /** Tracks collapsed to a single key */
+    uint32_t constantTracks = 0;
+  };
+
+  /**
+   * Removes the keys of every track that interpolating their neighbours reproduces within the tolerances, and collapses tracks
+   * that never leave them to a single key. The first and last key of a track are always kept.
+   *
+   * Errors are measured in bone space, but a bone carries its children: an error in its rotation or scale moves them by up to
+   * its extent, the length of the longest chain of bone offsets below it, and errors add up along a chain. Channels matching a
+   * bone of the skeletons by name therefore share the position tolerance evenly with the bones of their longest chain, and keep
+   * their rotation and scale within that share over their extent.
+   */
+  ReductionStatistics reduceKeys(KXF::Animation *animation, std::vector<KXF::Skeleton *> const &skeletons, ReductionSettings const &settings);
+
+  /**
+   * Smallest three encoding of a rotation in 48 bits: the index of the largest component in the lowest 2, the other three in
+   * 15 bits each over [-1/sqrt(2), 1/sqrt(2)]. The largest one is made positive and rebuilt from the others when unpacking.
+   */
+  void packSmallestThree(glm::quat const &rotation, uint16_t packed[3]);
+
+  glm::quat unpackSmallestThree(uint16_t const packed[3]);
+} // namespace clips
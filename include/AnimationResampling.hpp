@@ -0,0 +1,49 @@
+#pragma once
+
+#include <KIT/KXF/KXFAnimation.hpp>
+#include <KIT/KXF/KXFSkeleton.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace clips
+{
+  constexpr float defaultSampleRate = 30.0f;
+
+  /** Channels of a frame are padded to a multiple of this with identity transforms, so every stream is whole SIMD registers */
+  constexpr uint32_t uniformLaneWidth = 4;
+
+  /** Streams of a frame, in order: translation x y z, rotation x y z w, scale x y z */
+  constexpr uint32_t uniformStreamCount = 10;
+
+  /**
+   * Animation sampled at a fixed rate, with whole poses stored frame after frame. A frame is uniformStreamCount streams of
+   * laneCount floats, each holding one component of every channel, so a pose is found at frame index time * sampleRate and
+   * blended with the next one by the fraction, component by component, without searching any keys.
+   *
+   * Rotations of a channel keep to the hemisphere of its previous frame, which makes a normalized lerp between neighbouring
+   * frames take the short way.
+   */
+  struct UniformClip
+  {
+    float sampleRate = defaultSampleRate;
+
+    /** Frames at every multiple of 1 / sampleRate up to the first one at or past the duration, which holds the last keys */
+    uint32_t frameCount = 0;
+
+    /** Channels rounded up to a multiple of uniformLaneWidth */
+    uint32_t laneCount = 0;
+
+    /** Channel names in lane order */
+    std::vector<std::string> channels;
+
+    std::vector<float> frames;
+  };
+
+  /**
+   * Samples every channel of the animation at the rate, interpolating its keys like they are between them. Components of a
+   * channel without keys hold the bind pose of the bone of the same name in the skeletons.
+   */
+  void resampleUniform(UniformClip &output, KXF::Animation const *animation, std::vector<KXF::Skeleton *> const &skeletons, float sampleRate);
+} // namespace clips
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Command.hpp"
+
+class Command_BenchSkinning : public Command
+{
+public:
+  virtual ~Command_BenchSkinning();
+
+  virtual std::string const name() const override;
+  virtual bool execute(std::vector<std::string> args) const override;
+
+  virtual uint64_t requiredArguments() const override;
+
+protected:
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "Command.hpp"
+
+class Command_ImportVector : public Command
+{
+public:
+  virtual ~Command_ImportVector();
+
+  virtual std::string const name() const override;
+  virtual bool execute(std::vector<std::string> args) const override;
+
+  virtual std::string const imports() const override
+  {
+    return "Vector";
+  }
+
+  virtual uint64_t requiredArguments() const override;
+
+protected:
+};
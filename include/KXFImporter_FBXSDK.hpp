@@ -2,6 +2,9 @@
 #ifdef KIT_USE_FBXSDK
 #pragma once
 
+#include "MeshOptimization.hpp"
+#include "MeshWelding.hpp"
+
 #include <KIT/Export.hpp>
 
 #include <WIR/Math.hpp>
@@ -31,6 +34,12 @@ namespace KXF
 
     void importFromFile(std::string const &fbxFilePath, KXF::Document *outputDocument);
 
+    /** Whether and how the vertices of the imported submeshes are welded, see meshing::weldVertices. Welds with the default settings unless set */
+    void setWeld(bool weld, meshing::WeldSettings const &settings);
+
+    /** Whether the imported submeshes are reordered for the GPU and the overdraw threshold to do it with, see meshing::optimizeSubmesh. Optimizes with the default threshold unless set */
+    void setOptimize(bool optimize, float overdrawThreshold);
+
   protected:
     void importGeometry();
     void importSkeletons();
@@ -44,6 +53,12 @@ namespace KXF
     fbxsdk::FbxScene *m_fbxScene = nullptr;
 
     std::set<fbxsdk::FbxCluster *> m_usedBones;
+
+    bool m_weld = true;
+    meshing::WeldSettings m_weldSettings;
+
+    bool m_optimize = true;
+    float m_overdrawThreshold = meshing::defaultOverdrawThreshold;
   };
 } // namespace KXF
 #endif
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <KIT/KXF/KXFMesh.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace meshing
+{
+  /** Limits that fit mesh shader output on every vendor, with local indices fitting a byte */
+  constexpr uint32_t defaultMeshletVertices = 64;
+  constexpr uint32_t defaultMeshletTriangles = 124;
+
+  struct Meshlet
+  {
+    /** Range in MeshletData::vertices */
+    uint32_t vertexOffset = 0;
+    uint32_t vertexCount = 0;
+
+    /** Range in triangles, each one three bytes in MeshletData::triangles */
+    uint32_t triangleOffset = 0;
+    uint32_t triangleCount = 0;
+
+    /** Bounding sphere, for frustum and occlusion culling */
+    glm::vec3 center;
+    float radius = 0.0f;
+
+    /** Normal cone, every triangle faces away from the eye if dot(normalize(coneApex - eye), coneAxis) >= coneCutoff */
+    glm::vec3 coneApex;
+    glm::vec3 coneAxis;
+    float coneCutoff = 1.0f;
+  };
+
+  struct MeshletData
+  {
+    std::vector<Meshlet> meshlets;
+
+    /** Submesh vertex indices of every meshlet */
+    std::vector<uint32_t> vertices;
+
+    /** Triangles of every meshlet, as indices into its vertices */
+    std::vector<uint8_t> triangles;
+  };
+
+  /**
+   * Partitions the triangles of a submesh into meshlets of at most maxVertices vertices and maxTriangles triangles.
+   * Meshlets grow over connected triangles, preferring those that add the fewest vertices and stay close to the meshlet center
+   * and normal, which keeps the bounds and normal cones tight.
+   */
+  void buildMeshlets(MeshletData &output, KXF::Submesh const *submesh, uint32_t maxVertices = defaultMeshletVertices, uint32_t maxTriangles = defaultMeshletTriangles);
+} // namespace meshing
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace meshing
+{
+  /**
+   * Geometry codecs run ahead of the generic compression in utils::writeAsset. They don't shrink the data themselves, but turn
+   * it into long runs of small and repeating bytes that compress far better than interleaved vertices and raw indices.
+   *
+   * Vertices are split per byte of the stride: every byte becomes the zigzag encoded difference to the same byte of the
+   * previous vertex, and the differences of one byte are stored together as a plane, per block of 256 vertices so decoding
+   * reads the data in order. Indices are the zigzag encoded difference to the previous index, split into planes the same way
+   * over the whole buffer. The encoded size always equals the decoded size, and the decoders use SSE2 where available.
+   */
+  void encodeVertexBuffer(std::vector<uint8_t> &output, uint8_t const *vertices, size_t vertexCount, size_t stride);
+
+  /** Decodes vertices encoded by encodeVertexBuffer, returns false if data doesn't have the size of the vertices */
+  bool decodeVertexBuffer(uint8_t *vertices, size_t vertexCount, size_t stride, uint8_t const *data, size_t size);
+
+  /** Encodes indices stored with indexSize bytes, 2 or 4 */
+  void encodeIndexBuffer(std::vector<uint8_t> &output, std::vector<uint32_t> const &indices, uint32_t indexSize);
+
+  /** Decodes indices encoded by encodeIndexBuffer into indexSize byte indices, returns false if data doesn't have their size */
+  bool decodeIndexBuffer(void *indices, size_t indexCount, uint32_t indexSize, uint8_t const *data, size_t size);
+} // namespace meshing
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <KIT/KXF/KXFMesh.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace meshing
+{
+  /** Size of the simulated post-transform cache, a conservative value for current hardware */
+  constexpr uint32_t defaultCacheSize = 16;
+
+  /** How much overdraw sorting may worsen the vertex cache efficiency, as a factor of the optimized ACMR */
+  constexpr float defaultOverdrawThreshold = 1.05f;
+
+  /** Post-transform cache efficiency of a triangle list, simulated on a FIFO cache */
+  struct VertexCacheStatistics
+  {
+    uint64_t misses = 0;
+
+    /** Average cache miss ratio, transformed vertices per triangle. 0.5 is the optimum for a regular grid, 3 the worst case */
+    float acmr = 0.0f;
+
+    /** Average transform to vertex ratio, transformed vertices per referenced vertex. 1 is the optimum */
+    float atvr = 0.0f;
+  };
+
+  VertexCacheStatistics analyzeVertexCache(std::vector<uint32_t> const &indices, size_t vertexCount, uint32_t cacheSize = defaultCacheSize);
+
+  /** Reorders the triangles for the post-transform cache, using Tipsify (Sander et al. 2007) */
+  void optimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount, uint32_t cacheSize = defaultCacheSize);
+
+  /**
+   * Reorders the clusters of a cache optimized triangle list so that outward facing clusters are drawn first, which reduces overdraw
+   * from any viewpoint. Clusters are split as long as their ACMR stays within threshold times the ACMR of the cache optimized list.
+   */
+  void optimizeOverdraw(std::vector<uint32_t> &indices, std::vector<KXF::Vertex> const &vertices, float threshold = defaultOverdrawThreshold, uint32_t cacheSize = defaultCacheSize);
+
+  /** Reorders the vertices in the order the indices first reference them and drops unreferenced ones. Returns the new vertex count */
+  size_t optimizeVertexFetch(std::vector<KXF::Vertex> &vertices, std::vector<uint32_t> &indices);
+
+  /** Runs the vertex cache, overdraw and vertex fetch optimizations on a submesh, reporting the cache efficiency before and after */
+  void optimizeSubmesh(KXF::Submesh *submesh, float overdrawThreshold, VertexCacheStatistics &before, VertexCacheStatistics &after);
+} // namespace meshing
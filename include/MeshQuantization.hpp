@@ -0,0 +1,43 @@
+#pragma once
+
+#include <KIT/KXF/KXFMesh.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace meshing
+{
+  /**
+   * Interleaved vertex buffer with compact attribute formats, every attribute 4 byte aligned and in this order:
+   *  - position, RGBA16_UNORM relative to the submesh bounds, w is the tangent handedness (0 for -1, 65535 for 1)
+   *  - normal (VF_Normal), RG16_SNORM octahedral
+   *  - tangent (VF_Tangent), RG16_SNORM octahedral
+   *  - texture coordinates (VF_TexCoords1 to 4), RG16_SFLOAT each
+   *  - bone indices (VF_Bones), RGBA8_UINT, or RGBA16_UINT if boneIndexSize is 2
+   *  - bone weights (VF_Bones), RGBA8_UNORM summing to exactly 255 for weighted vertices
+   */
+  struct QuantizedVertices
+  {
+    KXF::VertexFlags flags = KXF::VF_None;
+    uint32_t stride = 0;
+    uint32_t vertexCount = 0;
+
+    /** Decodes positions, position = positionOffset + positionScale * unorm */
+    glm::vec3 positionOffset;
+    glm::vec3 positionScale;
+
+    /** Bytes per bone index, 1 unless the submesh references bones past 255 */
+    uint32_t boneIndexSize = 1;
+
+    std::vector<uint8_t> data;
+  };
+
+  /** IEEE 754 half precision, rounded to nearest, with values past the half range going to infinity */
+  uint16_t quantizeHalf(float value);
+
+  /** Octahedral encoding of a unit vector (Cigolle et al. 2014), both components in [-1, 1] */
+  glm::vec2 encodeOctahedral(glm::vec3 const &direction);
+
+  /** Encodes the attributes in flags of every vertex. Each attribute is encoded for all vertices at once, then interleaved. */
+  void quantizeVertices(QuantizedVertices &output, std::vector<KXF::Vertex> const &vertices, KXF::VertexFlags flags);
+} // namespace meshing
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <KIT/KXF/KXFMesh.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace meshing
+{
+  struct SimplifySettings
+  {
+    /** Fraction of the triangles to keep, 0 simplifies until the error limit is reached */
+    float ratio = 0.5f;
+
+    /** Largest error a collapse may introduce, relative to the largest extent of the submesh */
+    float error = 0.01f;
+
+    /** Cost of collapsing between vertices with entirely different bone weights, relative to the squared extent of the submesh */
+    float skinWeight = 0.01f;
+  };
+
+  /**
+   * Simplifies the triangles of a submesh with quadric error metric edge collapses (Garland and Heckbert 1997).
+   * Collapses only happen onto existing vertices, so the resulting indices still refer to the submesh vertex buffer and every
+   * kept vertex keeps its attributes. Vertices split by attribute seams (UVs, hard normals) only collapse along the seam and
+   * together with their other side, open borders only collapse along the border, and collapses between differently skinned
+   * vertices are penalized. Returns the largest error reached, relative to the largest extent of the submesh.
+   */
+  float simplify(std::vector<uint32_t> &destination, KXF::Submesh const *submesh, SimplifySettings const &settings);
+} // namespace meshing
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <KIT/KXF/KXFMesh.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace meshing
+{
+  /** Bone influences a vertex can hold, one per component of KXF::Vertex::bones and weights */
+  constexpr uint32_t maxBoneInfluences = 4;
+
+  /**
+   * Adds a bone influence to a vertex, which keeps the maxBoneInfluences largest ones in its bones and weights: once they are
+   * all taken, the smallest one is replaced if the new one is larger. influenceCount is the number of influences added to the
+   * vertex so far, starting at 0, and keeps counting past the ones kept.
+   */
+  void addBoneInfluence(KXF::Vertex &vertex, uint32_t &influenceCount, uint32_t bone, float weight);
+
+  /**
+   * Scales the weights of every vertex with influences to sum to one, so the ones kept make up for the ones dropped.
+   * Returns the number of vertices that had more influences than they could keep.
+   */
+  uint64_t normalizeBoneWeights(std::vector<KXF::Vertex> &vertices, std::vector<uint32_t> const &influenceCounts);
+} // namespace meshing
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <KIT/KXF/KXFMesh.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace meshing
+{
+  /** Per attribute tolerances under which two vertices are merged, 0 only merges identical values */
+  struct WeldSettings
+  {
+    float position = 0.00001f;
+    float normal = 0.001f;
+    float tangent = 0.001f;
+    float texCoord = 0.00001f;
+    float weight = 0.001f;
+  };
+
+  /**
+   * Merges the vertices of a submesh whose attributes quantize to the same values, and remaps the indices to match.
+   * Only the attributes enabled in the submesh vertex flags are compared, and triangles that collapse are removed.
+   * Returns the number of vertices removed.
+   */
+  uint64_t weldVertices(KXF::Submesh *submesh, WeldSettings const &settings);
+
+  /** Welds every given submesh in parallel, returns the total number of vertices removed */
+  uint64_t weldVertices(std::vector<KXF::Submesh *> const &submeshes, WeldSettings const &settings);
+} // namespace meshing
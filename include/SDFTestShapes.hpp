@@ -0,0 +1,21 @@
+#pragma once
+
+namespace msdfgen
+{
+  class Shape;
+  struct Vector2;
+} // namespace msdfgen
+
+namespace sdftest
+{
+  /**
+   * Builds an outline the size of a font glyph, about a thousand units across: a wavy outer contour of edgeCount edges cycling
+   * through linear, quadratic and cubic segments with an acute spike every eight edges, and two holes of a sixth as many edges
+   * each. Its many shared vertices and near ties between edges expose precision and evaluation order problems that a handful of
+   * edges does not. The contours are oriented and the edges colored.
+   */
+  void createWavyShape(msdfgen::Shape &shape, int edgeCount);
+
+  /** Fits the bounds of the shape into a width x height field with a margin of pixelRange pixels, which is also the range */
+  void frameShape(msdfgen::Shape const &shape, int width, int height, double pixelRange, msdfgen::Vector2 &scale, msdfgen::Vector2 &translate, double &range);
+} // namespace sdftest
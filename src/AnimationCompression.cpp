@@ -0,0 +1,290 @@
+#include "AnimationCompression.hpp"
+
+#include <WIR/Math.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+
+namespace
+{
+  /** Keys checked against a single interpolation at most, which bounds the cost of long nearly linear stretches */
+  constexpr size_t maxSegmentKeys = 256;
+
+  /** Largest value of the three smallest components of a unit quaternion */
+  constexpr float smallestThreeRange = 0.70710678f;
+
+  constexpr float smallestThreeSteps = 32767.0f;
+
+  /** Tolerances of the tracks of one channel */
+  struct ChannelTolerance
+  {
+    float position = 0.0f;
+    float rotation = 0.0f;
+    float scale = 0.0f;
+  };
+
+  struct BoneMeasure
+  {
+    /** Bones from the root to this one, both included */
+    uint32_t depth = 0;
+
+    /** Bones of the longest chain from this one to a leaf, both included */
+    uint32_t height = 0;
+
+    /** Longest chain of bone offsets below this one */
+    float extent = 0.0f;
+  };
+
+  /** Measures a bone and every bone below it, offsets are the distances of the bones to their parents */
+  BoneMeasure const &measureBone(KXF::Bone const *bone, uint32_t depth, std::map<std::string, float> const &offsets, std::map<KXF::Bone const *, BoneMeasure> &measures)
+  {
+    BoneMeasure measure;
+    measure.depth = depth;
+    measure.height = 1;
+
+    for (auto child : bone->children)
+    {
+      BoneMeasure const &childMeasure = measureBone(child, depth + 1, offsets, measures);
+      measure.height = std::max(measure.height, childMeasure.height + 1);
+      measure.extent = std::max(measure.extent, offsets.at(child->name) + childMeasure.extent);
+    }
+
+    return measures[bone] = measure;
+  }
+
+  /** Angle between two rotations, from the vector part of their difference rather than acos, which is too coarse near 1 */
+  float rotationError(glm::quat const &a, glm::quat const &b)
+  {
+    glm::quat difference = glm::conjugate(a) * b;
+    float sine = std::sqrt(difference.x * difference.x + difference.y * difference.y + difference.z * difference.z);
+    return 2.0f * std::atan2(sine, std::abs(difference.w));
+  }
+
+  float translationError(glm::vec3 const &a, glm::vec3 const &b)
+  {
+    return glm::length(a - b);
+  }
+
+  glm::vec3 interpolate(glm::vec3 const &a, glm::vec3 const &b, float t)
+  {
+    return glm::mix(a, b, t);
+  }
+
+  glm::quat interpolate(glm::quat const &a, glm::quat const &b, float t)
+  {
+    return glm::slerp(a, b, t);
+  }
+
+  /**
+   * Collapses the keys to the first one if none leaves the tolerance, otherwise keeps the first and last key and greedily
+   * extends every segment between kept keys for as long as interpolating it reproduces the keys it skips. Returns true if the
+   * track was constant.
+   */
+  template <typename T, typename Error>
+  bool reduceTrack(std::vector<KXF::AnimationKey<T>> &keys, float tolerance, Error error)
+  {
+    if (keys.size() < 2)
+    {
+      return false;
+    }
+
+    bool constant = true;
+    for (size_t k = 1; constant && k < keys.size(); k++)
+    {
+      constant = error(keys[0].value, keys[k].value) <= tolerance;
+    }
+
+    if (constant)
+    {
+      keys.resize(1);
+      return true;
+    }
+
+    std::vector<KXF::AnimationKey<T>> kept;
+    kept.push_back(keys[0]);
+
+    size_t anchor = 0;
+    for (size_t next = 2; next < keys.size(); next++)
+    {
+      KXF::AnimationKey<T> const &from = keys[anchor];
+      KXF::AnimationKey<T> const &to = keys[next];
+      double span = to.time - from.time;
+
+      bool fits = next - anchor <= maxSegmentKeys;
+      for (size_t k = anchor + 1; fits && k < next; k++)
+      {
+        float t = span > 0.0 ? float((keys[k].time - from.time) / span) : 0.0f;
+        fits = error(interpolate(from.value, to.value, t), keys[k].value) <= tolerance;
+      }
+
+      if (!fits)
+      {
+        anchor = next - 1;
+        kept.push_back(keys[anchor]);
+      }
+    }
+
+    kept.push_back(keys.back());
+    keys.swap(kept);
+    return false;
+  }
+} // namespace
+
+clips::ReductionStatistics clips::reduceKeys(KXF::Animation *animation, std::vector<KXF::Skeleton *> const &skeletons, ReductionSettings const &settings)
+{
+  // A bone is as far from its parent as its bind pose or any of its translation keys puts it
+  std::map<std::string, float> offsets;
+  for (auto skeleton : skeletons)
+  {
+    for (auto bone : skeleton->bones)
+    {
+      glm::vec3 translation(bone->initialTransform[3].x, bone->initialTransform[3].y, bone->initialTransform[3].z);
+      offsets[bone->name] = glm::length(translation);
+    }
+  }
+
+  for (auto channel : animation->channels)
+  {
+    for (auto track : channel->tracks)
+    {
+      auto vec3Track = dynamic_cast<KXF::AnimationTrackVec3 *>(track);
+      if (!vec3Track || track->name != "Translation")
+      {
+        continue;
+      }
+
+      float &offset = offsets[channel->name];
+      for (auto const &key : vec3Track->keys)
+      {
+        offset = std::max(offset, glm::length(key.value));
+      }
+    }
+  }
+
+  std::map<KXF::Bone const *, BoneMeasure> measures;
+  for (auto skeleton : skeletons)
+  {
+    for (auto root : skeleton->rootBones)
+    {
+      measureBone(root, 1, offsets, measures);
+    }
+  }
+
+  std::map<std::string, ChannelTolerance> boneTolerances;
+  for (auto const &entry : measures)
+  {
+    BoneMeasure const &measure = entry.second;
+    float share = settings.position / float(measure.depth + measure.height - 1);
+
+    ChannelTolerance &tolerance = boneTolerances[entry.first->name];
+    tolerance.position = share;
+    tolerance.rotation = measure.extent > 0.0f ? std::min(settings.rotation, share / measure.extent) : settings.rotation;
+    tolerance.scale = measure.extent > 0.0f ? std::min(settings.scale, share / measure.extent) : settings.scale;
+  }
+
+  ChannelTolerance defaultTolerance;
+  defaultTolerance.position = settings.position;
+  defaultTolerance.rotation = settings.rotation;
+  defaultTolerance.scale = settings.scale;
+
+  int64_t channelCount = int64_t(animation->channels.size());
+  std::vector<ReductionStatistics> channelStatistics(animation->channels.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int64_t c = 0; c < channelCount; c++)
+  {
+    KXF::AnimationChannel *channel = animation->channels[c];
+    ReductionStatistics &statistics = channelStatistics[c];
+
+    auto finder = boneTolerances.find(channel->name);
+    ChannelTolerance const &tolerance = finder != boneTolerances.end() ? finder->second : defaultTolerance;
+
+    for (auto track : channel->tracks)
+    {
+      if (auto quatTrack = dynamic_cast<KXF::AnimationTrackQuat *>(track))
+      {
+        statistics.keysBefore += quatTrack->keys.size();
+        statistics.constantTracks += reduceTrack(quatTrack->keys, tolerance.rotation, rotationError) ? 1 : 0;
+        statistics.keysAfter += quatTrack->keys.size();
+      }
+      else if (auto vec3Track = dynamic_cast<KXF::AnimationTrackVec3 *>(track))
+      {
+        statistics.keysBefore += vec3Track->keys.size();
+        float trackTolerance = track->name == "Scale" ? tolerance.scale : tolerance.position;
+        statistics.constantTracks += reduceTrack(vec3Track->keys, trackTolerance, translationError) ? 1 : 0;
+        statistics.keysAfter += vec3Track->keys.size();
+      }
+    }
+  }
+
+  ReductionStatistics statistics;
+  for (auto const &channel : channelStatistics)
+  {
+    statistics.keysBefore += channel.keysBefore;
+    statistics.keysAfter += channel.keysAfter;
+    statistics.constantTracks += channel.constantTracks;
+  }
+
+  return statistics;
+}
+
+void clips::packSmallestThree(glm::quat const &rotation, uint16_t packed[3])
+{
+  float length = std::sqrt(rotation.x * rotation.x + rotation.y * rotation.y + rotation.z * rotation.z + rotation.w * rotation.w);
+  float components[4] = {rotation.x / length, rotation.y / length, rotation.z / length, rotation.w / length};
+
+  uint32_t largest = 0;
+  for (uint32_t c = 1; c < 4; c++)
+  {
+    largest = std::abs(components[c]) > std::abs(components[largest]) ? c : largest;
+  }
+
+  // q and -q are the same rotation, so the largest component can always be positive
+  float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+  uint64_t bits = largest;
+  uint32_t shift = 2;
+  for (uint32_t c = 0; c < 4; c++)
+  {
+    if (c == largest)
+    {
+      continue;
+    }
+
+    float normalized = std::min(std::max(components[c] * sign / smallestThreeRange, -1.0f), 1.0f);
+    bits |= uint64_t(std::lround((normalized * 0.5f + 0.5f) * smallestThreeSteps)) << shift;
+    shift += 15;
+  }
+
+  packed[0] = uint16_t(bits);
+  packed[1] = uint16_t(bits >> 16);
+  packed[2] = uint16_t(bits >> 32);
+}
+
+glm::quat clips::unpackSmallestThree(uint16_t const packed[3])
+{
+  uint64_t bits = uint64_t(packed[0]) | (uint64_t(packed[1]) << 16) | (uint64_t(packed[2]) << 32);
+  uint32_t largest = uint32_t(bits & 3);
+
+  float components[4];
+  float sum = 0.0f;
+  uint32_t shift = 2;
+  for (uint32_t c = 0; c < 4; c++)
+  {
+    if (c == largest)
+    {
+      continue;
+    }
+
+    float normalized = float((bits >> shift) & 0x7fff) / smallestThreeSteps * 2.0f - 1.0f;
+    components[c] = normalized * smallestThreeRange;
+    sum += components[c] * components[c];
+    shift += 15;
+  }
+
+  components[largest] = std::sqrt(std::max(1.0f - sum, 0.0f));
+  return glm::quat(components[3], components[0], components[1], components[2]);
+}
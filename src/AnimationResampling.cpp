@@ -0,0 +1,171 @@
+#include "AnimationResampling.hpp"
+
+#include <WIR/Math.hpp>
+
+#include <WIR/glm/gtx/matrix_decompose.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <string>
+
+namespace
+{
+  /** First stream of each component, see clips::uniformStreamCount */
+  constexpr uint32_t translationStream = 0;
+  constexpr uint32_t rotationStream = 3;
+  constexpr uint32_t scaleStream = 7;
+
+  /** Local transform of a channel split into the components the streams hold */
+  struct RestPose
+  {
+    glm::vec3 translation = glm::vec3(0.0f);
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+  };
+
+  glm::vec3 interpolate(glm::vec3 const &a, glm::vec3 const &b, float t)
+  {
+    return glm::mix(a, b, t);
+  }
+
+  glm::quat interpolate(glm::quat const &a, glm::quat const &b, float t)
+  {
+    return glm::slerp(a, b, t);
+  }
+
+  /**
+   * Value of the keys at a time, holding the first and last key outside of them. Times only ever increase between calls, so the
+   * key before the time is found by walking the cursor forward.
+   */
+  template <typename T>
+  T sampleKeys(std::vector<KXF::AnimationKey<T>> const &keys, double time, size_t &cursor)
+  {
+    while (cursor + 1 < keys.size() && keys[cursor + 1].time <= time)
+    {
+      cursor++;
+    }
+
+    KXF::AnimationKey<T> const &from = keys[cursor];
+    if (cursor + 1 >= keys.size() || time <= from.time)
+    {
+      return from.value;
+    }
+
+    KXF::AnimationKey<T> const &to = keys[cursor + 1];
+    return interpolate(from.value, to.value, float((time - from.time) / (to.time - from.time)));
+  }
+} // namespace
+
+void clips::resampleUniform(UniformClip &output, KXF::Animation const *animation, std::vector<KXF::Skeleton *> const &skeletons, float sampleRate)
+{
+  std::map<std::string, KXF::Bone const *> bones;
+  for (auto skeleton : skeletons)
+  {
+    for (auto bone : skeleton->bones)
+    {
+      bones[bone->name] = bone;
+    }
+  }
+
+  output.sampleRate = sampleRate;
+  output.frameCount = uint32_t(std::ceil(animation->duration * sampleRate)) + 1;
+  output.laneCount = (uint32_t(animation->channels.size()) + uniformLaneWidth - 1) / uniformLaneWidth * uniformLaneWidth;
+
+  output.channels.clear();
+  for (auto channel : animation->channels)
+  {
+    output.channels.push_back(channel->name);
+  }
+
+  // Padding lanes keep the identity transform
+  size_t frameSize = size_t(uniformStreamCount) * output.laneCount;
+  output.frames.assign(frameSize * output.frameCount, 0.0f);
+  for (size_t f = 0; f < output.frameCount; f++)
+  {
+    float *frame = output.frames.data() + f * frameSize;
+    std::fill(frame + (rotationStream + 3) * output.laneCount, frame + (rotationStream + 4) * output.laneCount, 1.0f);
+    std::fill(frame + scaleStream * output.laneCount, frame + uniformStreamCount * output.laneCount, 1.0f);
+  }
+
+  // Channels start out in the bind pose of their bone, which components without keys keep, and in the identity transform
+  // if no skeleton has a bone of their name
+  for (size_t c = 0; c < animation->channels.size(); c++)
+  {
+    RestPose rest;
+    auto bone = bones.find(animation->channels[c]->name);
+    if (bone != bones.end())
+    {
+      glm::vec3 skew;
+      glm::vec4 perspective;
+      glm::decompose(bone->second->initialTransform, rest.scale, rest.rotation, rest.translation, skew, perspective);
+    }
+
+    float const values[uniformStreamCount] = {rest.translation.x, rest.translation.y, rest.translation.z, rest.rotation.x, rest.rotation.y, rest.rotation.z, rest.rotation.w, rest.scale.x, rest.scale.y, rest.scale.z};
+    for (size_t f = 0; f < output.frameCount; f++)
+    {
+      float *lanes = output.frames.data() + f * frameSize + c;
+      for (uint32_t stream = 0; stream < uniformStreamCount; stream++)
+      {
+        lanes[stream * output.laneCount] = values[stream];
+      }
+    }
+  }
+
+  int64_t channelCount = int64_t(animation->channels.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int64_t c = 0; c < channelCount; c++)
+  {
+    for (auto track : animation->channels[c]->tracks)
+    {
+      if (auto quatTrack = dynamic_cast<KXF::AnimationTrackQuat const *>(track))
+      {
+        if (quatTrack->keys.empty())
+        {
+          continue;
+        }
+
+        size_t cursor = 0;
+        glm::quat previous = quatTrack->keys.front().value;
+        for (size_t f = 0; f < output.frameCount; f++)
+        {
+          glm::quat rotation = sampleKeys(quatTrack->keys, double(f) / sampleRate, cursor);
+          if (glm::dot(previous, rotation) < 0.0f)
+          {
+            rotation = -rotation;
+          }
+
+          previous = rotation;
+
+          float *lanes = output.frames.data() + f * frameSize + rotationStream * output.laneCount + c;
+          lanes[0] = rotation.x;
+          lanes[output.laneCount] = rotation.y;
+          lanes[2 * output.laneCount] = rotation.z;
+          lanes[3 * output.laneCount] = rotation.w;
+        }
+      }
+      else if (auto vec3Track = dynamic_cast<KXF::AnimationTrackVec3 const *>(track))
+      {
+        if (vec3Track->keys.empty())
+        {
+          continue;
+        }
+
+        uint32_t firstStream = track->name == "Scale" ? scaleStream : translationStream;
+
+        size_t cursor = 0;
+        for (size_t f = 0; f < output.frameCount; f++)
+        {
+          glm::vec3 value = sampleKeys(vec3Track->keys, double(f) / sampleRate, cursor);
+
+          float *lanes = output.frames.data() + f * frameSize + firstStream * output.laneCount + c;
+          lanes[0] = value.x;
+          lanes[output.laneCount] = value.y;
+          lanes[2 * output.laneCount] = value.z;
+        }
+      }
+    }
+  }
+}
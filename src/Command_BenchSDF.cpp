@@ -0,0 +1,563 @@
+#include "Command_BenchSDF.hpp"
+
+#include "MSDF/msdfgen.h"
+
+#include <WIR/Error.hpp>
+#include <WIR/Filesystem.hpp>
+#include <WIR/Math.hpp>
+#include <WIR/String.hpp>
+
+#include <WIR/XML/XMLAttribute.hpp>
+#include <WIR/XML/XMLDocument.hpp>
+#include <WIR/XML/XMLElement.hpp>
+#include <WIR/XML/XMLParser.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdlib>
+
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_OUTLINE_H
+
+#define F26DOT6_TO_DOUBLE(x) (1 / 64.0 * double(x))
+
+namespace
+{
+
+  enum BenchMode
+  {
+    BM_SDF,
+    BM_PSDF,
+    BM_MSDF,
+    BM_MTSDF
+  };
+
+  char const *modeNames[] = {"SDF", "PSDF", "MSDF", "MTSDF"};
+
+  /** Which generator implementation to run: the original one, the batched one with or without overlap support, or the batched one in single precision */
+  enum BenchVariant
+  {
+    BV_Legacy,
+    BV_Simple,
+    BV_Overlap,
+    BV_Float
+  };
+
+  char const *variantNames[] = {"Legacy", "Simple", "Overlap", "Float"};
+
+  struct BenchGlyph
+  {
+    uint32_t codepoint = 0;
+    msdfgen::Shape shape;
+    msdfgen::Shape::Bounds bounds = {0.0, 0.0, 0.0, 0.0};
+  };
+
+  struct BenchResult
+  {
+    std::string font;
+    BenchMode mode = BM_SDF;
+    BenchVariant variant = BV_Overlap;
+    int64_t size = 0;
+    double range = 0.0;
+    uint32_t glyphs = 0;
+    double milliseconds = 0.0;
+    double meanError = 0.0;
+    double maxError = 0.0;
+  };
+
+  struct OutlineContext
+  {
+    msdfgen::Point2 position;
+    msdfgen::Shape *shape = nullptr;
+    msdfgen::Contour *contour = nullptr;
+  };
+
+  msdfgen::Point2 outlinePoint(FT_Vector const *vector)
+  {
+    return msdfgen::Point2(F26DOT6_TO_DOUBLE(vector->x), F26DOT6_TO_DOUBLE(vector->y));
+  }
+
+  int outlineMoveTo(FT_Vector const *to, void *user)
+  {
+    auto context = reinterpret_cast<OutlineContext *>(user);
+    if (!(context->contour && context->contour->edges.empty()))
+    {
+      context->contour = &context->shape->addContour();
+    }
+    context->position = outlinePoint(to);
+    return 0;
+  }
+
+  int outlineLineTo(FT_Vector const *to, void *user)
+  {
+    auto context = reinterpret_cast<OutlineContext *>(user);
+    msdfgen::Point2 endpoint = outlinePoint(to);
+    if (endpoint != context->position)
+    {
+      context->contour->addEdge(msdfgen::EdgeHolder(context->position, endpoint));
+      context->position = endpoint;
+    }
+    return 0;
+  }
+
+  int outlineConicTo(FT_Vector const *control, FT_Vector const *to, void *user)
+  {
+    auto context = reinterpret_cast<OutlineContext *>(user);
+    msdfgen::Point2 endpoint = outlinePoint(to);
+    context->contour->addEdge(msdfgen::EdgeHolder(context->position, outlinePoint(control), endpoint));
+    context->position = endpoint;
+    return 0;
+  }
+
+  int outlineCubicTo(FT_Vector const *control1, FT_Vector const *control2, FT_Vector const *to, void *user)
+  {
+    auto context = reinterpret_cast<OutlineContext *>(user);
+    msdfgen::Point2 endpoint = outlinePoint(to);
+    context->contour->addEdge(msdfgen::EdgeHolder(context->position, outlinePoint(control1), outlinePoint(control2), endpoint));
+    context->position = endpoint;
+    return 0;
+  }
+
+  /** Loads the outlines of the given characters, in font units. Characters without outlines, like space, are skipped */
+  bool loadGlyphs(FT_Library library, std::string const &filename, std::u32string const &characters, std::vector<BenchGlyph> &outGlyphs)
+  {
+    FT_Face face = nullptr;
+    if (FT_New_Face(library, filename.c_str(), 0, &face) != 0)
+    {
+      LogError("Failed to load font from file (%s)", filename.c_str());
+      return false;
+    }
+    FT_Select_Charmap(face, ft_encoding_unicode);
+
+    FT_Outline_Funcs outlineFuncs;
+    outlineFuncs.move_to = &outlineMoveTo;
+    outlineFuncs.line_to = &outlineLineTo;
+    outlineFuncs.conic_to = &outlineConicTo;
+    outlineFuncs.cubic_to = &outlineCubicTo;
+    outlineFuncs.shift = 0;
+    outlineFuncs.delta = 0;
+
+    for (char32_t character : characters)
+    {
+      if (FT_Get_Char_Index(face, character) == 0 || FT_Load_Char(face, character, FT_LOAD_NO_SCALE) != 0)
+      {
+        continue;
+      }
+
+      BenchGlyph glyph;
+      glyph.codepoint = character;
+
+      OutlineContext context;
+      context.shape = &glyph.shape;
+      if (FT_Outline_Decompose(&face->glyph->outline, &outlineFuncs, &context) != 0)
+      {
+        LogWarning("Failed to decompose glyph %u", uint32_t(character));
+        continue;
+      }
+
+      if (!glyph.shape.contours.empty() && glyph.shape.contours.back().edges.empty())
+      {
+        glyph.shape.contours.pop_back();
+      }
+
+      if (glyph.shape.contours.empty())
+      {
+        continue;
+      }
+
+      // The generators expect TrueType winding, PostScript outlines (CFF based OpenType fonts) fill the other way around
+      if (FT_Outline_Get_Orientation(&face->glyph->outline) == FT_ORIENTATION_POSTSCRIPT)
+      {
+        for (auto &contour : glyph.shape.contours)
+        {
+          contour.reverse();
+        }
+      }
+
+      glyph.shape.normalize();
+      msdfgen::edgeColoringSimple(glyph.shape, 3.0);
+      glyph.bounds = glyph.shape.getBounds();
+      outGlyphs.push_back(std::move(glyph));
+    }
+
+    FT_Done_Face(face);
+    return true;
+  }
+
+  void generateField(msdfgen::BitmapRef<float, 1> const &field, BenchMode mode, BenchVariant variant, msdfgen::Shape const &shape, double range, msdfgen::Vector2 const &scale, msdfgen::Vector2 const &translate)
+  {
+    msdfgen::GeneratorPrecision precision = variant == BV_Float ? msdfgen::PRECISION_FLOAT : msdfgen::PRECISION_DOUBLE;
+    if (mode == BM_SDF)
+    {
+      if (variant == BV_Legacy)
+        msdfgen::generateSDF_legacy(field, shape, range, scale, translate);
+      else
+        msdfgen::generateSDF(field, shape, range, scale, translate, variant != BV_Simple, precision);
+    }
+    else
+    {
+      if (variant == BV_Legacy)
+        msdfgen::generatePseudoSDF_legacy(field, shape, range, scale, translate);
+      else
+        msdfgen::generatePseudoSDF(field, shape, range, scale, translate, variant != BV_Simple, precision);
+    }
+  }
+
+  void generateField(msdfgen::BitmapRef<float, 3> const &field, BenchMode, BenchVariant variant, msdfgen::Shape const &shape, double range, msdfgen::Vector2 const &scale, msdfgen::Vector2 const &translate)
+  {
+    msdfgen::GeneratorPrecision precision = variant == BV_Float ? msdfgen::PRECISION_FLOAT : msdfgen::PRECISION_DOUBLE;
+    if (variant == BV_Legacy)
+      msdfgen::generateMSDF_legacy(field, shape, range, scale, translate);
+    else
+      msdfgen::generateMSDF(field, shape, range, scale, translate, MSDFGEN_DEFAULT_ERROR_CORRECTION_THRESHOLD, variant != BV_Simple, precision);
+  }
+
+  void generateField(msdfgen::BitmapRef<float, 4> const &field, BenchMode, BenchVariant variant, msdfgen::Shape const &shape, double range, msdfgen::Vector2 const &scale, msdfgen::Vector2 const &translate)
+  {
+    msdfgen::GeneratorPrecision precision = variant == BV_Float ? msdfgen::PRECISION_FLOAT : msdfgen::PRECISION_DOUBLE;
+    if (variant == BV_Legacy)
+      msdfgen::generateMTSDF_legacy(field, shape, range, scale, translate);
+    else
+      msdfgen::generateMTSDF(field, shape, range, scale, translate, MSDFGEN_DEFAULT_ERROR_CORRECTION_THRESHOLD, variant != BV_Simple, precision);
+  }
+
+  /** Generates every glyph fitted into a size x size field with range pixels of distance around it, and measures the generation time and the error estimate */
+  template <int N>
+  void runBenchmark(BenchResult &result, std::vector<BenchGlyph> const &glyphs, int scanlinesPerRow)
+  {
+    msdfgen::Bitmap<float, N> field(int(result.size), int(result.size));
+    std::chrono::duration<double, std::milli> elapsed(0.0);
+    double totalError = 0.0;
+
+    for (auto const &glyph : glyphs)
+    {
+      double width = glyph.bounds.r - glyph.bounds.l;
+      double height = glyph.bounds.t - glyph.bounds.b;
+      double scale = (double(result.size) - result.range) / (glm::max)(width, height);
+      msdfgen::Vector2 translate(0.5 * (result.size / scale - width) - glyph.bounds.l, 0.5 * (result.size / scale - height) - glyph.bounds.b);
+
+      auto start = std::chrono::high_resolution_clock::now();
+      generateField(field, result.mode, result.variant, glyph.shape, result.range / scale, scale, translate);
+      elapsed += std::chrono::high_resolution_clock::now() - start;
+
+      double error = msdfgen::estimateSDFError(field, glyph.shape, scale, translate, scanlinesPerRow);
+      totalError += error;
+      result.maxError = (glm::max)(result.maxError, error);
+    }
+
+    result.glyphs = uint32_t(glyphs.size());
+    result.milliseconds = elapsed.count();
+    result.meanError = glyphs.empty() ? 0.0 : totalError / glyphs.size();
+  }
+
+  double glyphsPerSecond(BenchResult const &result)
+  {
+    return result.milliseconds > 0.0 ? result.glyphs / (result.milliseconds / 1000.0) : 0.0;
+  }
+
+  std::u32string decodeUtf8(std::string const &text)
+  {
+    std::u32string decoded;
+    for (size_t i = 0; i < text.size();)
+    {
+      uint8_t lead = uint8_t(text[i]);
+      int length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+      if (length == 0 || i + length > text.size())
+      {
+        // Not valid UTF-8, skip the byte
+        i++;
+        continue;
+      }
+
+      char32_t codepoint = length == 1 ? lead : lead & (0x7F >> length);
+      for (int j = 1; j < length; j++)
+      {
+        codepoint = (codepoint << 6) | (uint8_t(text[i + j]) & 0x3F);
+      }
+      decoded += codepoint;
+      i += length;
+    }
+    return decoded;
+  }
+
+  std::string jsonString(std::string const &value)
+  {
+    std::string escaped = "\"";
+    for (char c : value)
+    {
+      if (c == '"' || c == '\\')
+      {
+        escaped += '\\';
+      }
+      escaped += c;
+    }
+    return escaped + "\"";
+  }
+
+  std::vector<std::string> splitList(std::string const &list)
+  {
+    std::vector<std::string> items;
+    for (auto const &item : wir::split(list, {',', ' '}))
+    {
+      if (!item.empty())
+      {
+        items.push_back(item);
+      }
+    }
+    return items;
+  }
+
+  template <size_t Count>
+  bool parseNames(std::string const &list, char const *(&names)[Count], std::vector<int> &outValues)
+  {
+    for (auto const &item : splitList(list))
+    {
+      auto found = std::find_if(std::begin(names), std::end(names), [&item](char const *name) { return wir::strToLower(item) == wir::strToLower(name); });
+      if (found == std::end(names))
+      {
+        return false;
+      }
+      outValues.push_back(int(found - std::begin(names)));
+    }
+    return !outValues.empty();
+  }
+
+} // namespace
+
+Command_BenchSDF::~Command_BenchSDF()
+{
+}
+
+std::string const Command_BenchSDF::name() const
+{
+  return "bench_sdf";
+}
+
+bool Command_BenchSDF::execute(std::vector<std::string> args) const
+{
+  std::string const fontBase = args[2];
+  if (!wir::Directory(fontBase).exist())
+  {
+    LogError("Font directory does not exist!");
+    return false;
+  }
+
+  // The benchmark settings live next to the fonts and name the ones to load, so that runs over the same set stay comparable
+  auto specFile = fontBase + "/bench_sdf.xml";
+  if (!wir::File(specFile).exist())
+  {
+    std::string specData = "<SDFBenchmark Fonts=\"\" OutputFile=\"bench_sdf.json\" Sizes=\"16,32,64\" Ranges=\"2,4\" Modes=\"SDF,PSDF,MSDF,MTSDF\" Variants=\"Legacy,Overlap\" ScanlinesPerRow=\"4\" />";
+    if (!wir::File(specFile).writeString(specData))
+    {
+      LogError("Failed to create benchmark spec");
+      return false;
+    }
+  }
+
+  wir::XMLDocument document;
+  wir::XMLParser parser;
+  if (!parser.loadFromFile(specFile, document))
+  {
+    LogError("Failed to parse xml");
+    return false;
+  }
+
+  auto roots = document.rootElements();
+  if (roots.size() != 1 || roots[0]->name() != "SDFBenchmark")
+  {
+    LogError("invalid benchmark spec");
+    return false;
+  }
+
+  auto root = roots[0];
+
+  std::string outputFile = "bench_sdf.json";
+  root->string("OutputFile", outputFile);
+
+  std::vector<int64_t> sizes = {16, 32, 64};
+  root->integerArray("Sizes", sizes);
+
+  std::string rangeList = "2,4";
+  root->string("Ranges", rangeList);
+  std::vector<double> ranges;
+  for (auto const &item : splitList(rangeList))
+  {
+    ranges.push_back(std::atof(item.c_str()));
+  }
+
+  std::string modeList = "SDF,PSDF,MSDF,MTSDF";
+  root->string("Modes", modeList);
+  std::vector<int> modes;
+  if (!parseNames(modeList, modeNames, modes))
+  {
+    LogError("Invalid modes, possible options: SDF, PSDF, MSDF, MTSDF");
+    return false;
+  }
+
+  std::string variantList = "Legacy,Overlap";
+  root->string("Variants", variantList);
+  std::vector<int> variants;
+  if (!parseNames(variantList, variantNames, variants))
+  {
+    LogError("Invalid variants, possible options: Legacy, Simple, Overlap, Float");
+    return false;
+  }
+
+  int64_t scanlinesPerRow = 4;
+  root->integer("ScanlinesPerRow", scanlinesPerRow);
+
+  // Printable ASCII by default
+  std::u32string characters;
+  for (char32_t c = 0x21; c < 0x7F; c++)
+  {
+    characters += c;
+  }
+
+  std::string characterList;
+  if (root->string("Characters", characterList))
+  {
+    characters = decodeUtf8(characterList);
+  }
+
+  for (auto size : sizes)
+  {
+    for (auto range : ranges)
+    {
+      if (size <= 0 || range <= 0.0 || range >= double(size))
+      {
+        LogError("Invalid size %" PRId64 " or range %f, the range must be positive and smaller than the size", size, range);
+        return false;
+      }
+    }
+  }
+
+  // Font file names relative to the directory, separated by commas only since they may contain spaces
+  std::string fontList;
+  root->string("Fonts", fontList);
+  std::vector<std::string> fontFiles;
+  for (auto const &item : wir::split(fontList, {','}))
+  {
+    size_t first = item.find_first_not_of(' ');
+    if (first == std::string::npos)
+    {
+      continue;
+    }
+
+    auto fontFile = wir::File(fontBase + "/" + item.substr(first, item.find_last_not_of(' ') - first + 1));
+    if (!fontFile.exist())
+    {
+      LogError("Font file %s doesn't exist", fontFile.path().c_str());
+      return false;
+    }
+    fontFiles.push_back(fontFile.path());
+  }
+
+  if (fontFiles.empty())
+  {
+    LogError("No fonts listed, add their file names to the Fonts attribute of %s", specFile.c_str());
+    return false;
+  }
+
+  FT_Library ftLibrary = FT_Library();
+  if (FT_Init_FreeType(&ftLibrary))
+  {
+    LogError("Could not initialize Freetype");
+    return false;
+  }
+
+  std::vector<BenchResult> results;
+  auto benchStart = std::chrono::high_resolution_clock::now();
+  for (auto const &fontFile : fontFiles)
+  {
+    std::vector<BenchGlyph> glyphs;
+    if (!loadGlyphs(ftLibrary, fontFile, characters, glyphs))
+    {
+      continue;
+    }
+
+    auto fontName = wir::File(fontFile).name();
+    LogNotice("%s: %u glyphs", fontName.c_str(), uint32_t(glyphs.size()));
+
+    for (int mode : modes)
+    {
+      for (int variant : variants)
+      {
+        for (auto size : sizes)
+        {
+          for (auto range : ranges)
+          {
+            BenchResult result;
+            result.font = fontName;
+            result.mode = BenchMode(mode);
+            result.variant = BenchVariant(variant);
+            result.size = size;
+            result.range = range;
+
+            switch (result.mode)
+            {
+            case BM_SDF:
+            case BM_PSDF:
+              runBenchmark<1>(result, glyphs, int(scanlinesPerRow));
+              break;
+            case BM_MSDF:
+              runBenchmark<3>(result, glyphs, int(scanlinesPerRow));
+              break;
+            case BM_MTSDF:
+              runBenchmark<4>(result, glyphs, int(scanlinesPerRow));
+              break;
+            }
+
+            LogNotice("%s %s %s, size %" PRId64 ", range %g: %.2f ms, %.1f glyphs/s, mean error %g, max error %g", fontName.c_str(), modeNames[mode], variantNames[variant], size, range, result.milliseconds, glyphsPerSecond(result), result.meanError, result.maxError);
+            results.push_back(result);
+          }
+        }
+      }
+    }
+  }
+  double totalMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - benchStart).count();
+
+  if (FT_Done_FreeType(ftLibrary))
+  {
+    LogError("Could not destroy Freetype");
+  }
+
+  double generationMs = 0.0;
+  uint64_t generatedGlyphs = 0;
+  for (auto const &result : results)
+  {
+    generationMs += result.milliseconds;
+    generatedGlyphs += result.glyphs;
+  }
+
+  LogNotice("Generated %" PRIu64 " glyphs in %.2f ms (%.1f glyphs/s), %.2f ms in total including loading and error estimation", generatedGlyphs, generationMs, generationMs > 0.0 ? generatedGlyphs / (generationMs / 1000.0) : 0.0, totalMs);
+
+  std::string json = "{\n";
+  json += wir::format("  \"generatedGlyphs\": %" PRIu64 ",\n", generatedGlyphs);
+  json += wir::format("  \"generationMilliseconds\": %.3f,\n", generationMs);
+  json += wir::format("  \"totalMilliseconds\": %.3f,\n", totalMs);
+  json += "  \"results\": [\n";
+  for (size_t i = 0; i < results.size(); i++)
+  {
+    auto const &result = results[i];
+    json += wir::format("    {\"font\": %s, \"mode\": \"%s\", \"variant\": \"%s\", \"size\": %" PRId64 ", \"range\": %g, \"glyphs\": %u, \"milliseconds\": %.3f, \"glyphsPerSecond\": %.3f, \"meanError\": %.9g, \"maxError\": %.9g}%s\n",
+                        jsonString(result.font).c_str(), modeNames[result.mode], variantNames[result.variant], result.size, result.range, result.glyphs, result.milliseconds, glyphsPerSecond(result), result.meanError, result.maxError, i + 1 < results.size() ? "," : "");
+  }
+  json += "  ]\n}\n";
+
+  auto outputFilef = wir::File(fontBase + "/" + outputFile);
+  if (!outputFilef.writeString(json))
+  {
+    LogError("Failed to write results (%s)", outputFilef.path().c_str());
+    return false;
+  }
+
+  LogNotice("Wrote results to %s", outputFilef.path().c_str());
+  return true;
+}
+
+uint64_t Command_BenchSDF::requiredArguments() const
+{
+  return 3; // 2 + font directory
+}
@@ -0,0 +1,181 @@
+#include "Command_BenchSkinning.hpp"
+
+#include "MeshSkinning.hpp"
+
+#include <KIT/KXF/KXFMesh.hpp>
+
+#include <WIR/Error.hpp>
+#include <WIR/Math.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <random>
+
+namespace
+{
+  // Dense skin, every vertex is influenced by more bones than it can keep
+  constexpr uint32_t benchBoneCount = 256;
+  constexpr uint32_t benchInfluencesPerVertex = 6;
+
+  struct BenchWeight
+  {
+    uint32_t vertex = 0;
+    float weight = 0.0f;
+  };
+
+  struct BenchResult
+  {
+    double milliseconds = 0.0;
+
+    /** Vertices that didn't end up with their largest influences */
+    uint64_t wrongVertices = 0;
+
+    /** Largest difference of the weight sum of a vertex from one */
+    float maxSumError = 0.0f;
+  };
+
+  /** The weights of every bone, in the order assimp lists them */
+  void generateSkin(std::vector<std::vector<BenchWeight>> &boneWeights, uint32_t vertexCount)
+  {
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> weightDistribution(0.01f, 1.0f);
+
+    boneWeights.assign(benchBoneCount, {});
+    for (uint32_t v = 0; v < vertexCount; v++)
+    {
+      // Neighbouring vertices share their bones, like they would along a limb
+      uint32_t firstBone = (v / 64) % benchBoneCount;
+      for (uint32_t i = 0; i < benchInfluencesPerVertex; i++)
+      {
+        boneWeights[(firstBone + i * 7) % benchBoneCount].push_back({v, weightDistribution(random)});
+      }
+    }
+  }
+
+  /** Keeps the first four weights of every vertex in a map, as the assimp importer used to */
+  void skinWithMap(std::vector<KXF::Vertex> &vertices, std::vector<std::vector<BenchWeight>> const &boneWeights)
+  {
+    std::map<uint32_t, uint32_t> vertexWeightCount;
+    for (uint32_t i = 0; i < vertices.size(); i++)
+    {
+      vertexWeightCount[i] = 0;
+    }
+
+    for (uint32_t bone = 0; bone < boneWeights.size(); bone++)
+    {
+      for (auto const &weight : boneWeights[bone])
+      {
+        uint32_t &count = vertexWeightCount.at(weight.vertex);
+        if (count < meshing::maxBoneInfluences)
+        {
+          vertices[weight.vertex].bones[count] = bone;
+          vertices[weight.vertex].weights[count] = weight.weight;
+          count++;
+        }
+      }
+    }
+  }
+
+  void skinWithArrays(std::vector<KXF::Vertex> &vertices, std::vector<std::vector<BenchWeight>> const &boneWeights)
+  {
+    std::vector<uint32_t> vertexWeightCount(vertices.size(), 0);
+    for (uint32_t bone = 0; bone < boneWeights.size(); bone++)
+    {
+      for (auto const &weight : boneWeights[bone])
+      {
+        meshing::addBoneInfluence(vertices[weight.vertex], vertexWeightCount[weight.vertex], bone, weight.weight);
+      }
+    }
+
+    meshing::normalizeBoneWeights(vertices, vertexWeightCount);
+  }
+
+  /** Checks every vertex against its largest influences, found by sorting all of them */
+  void evaluateSkin(BenchResult &result, std::vector<KXF::Vertex> const &vertices, std::vector<std::vector<BenchWeight>> const &boneWeights)
+  {
+    std::vector<std::vector<std::pair<float, uint32_t>>> influences(vertices.size());
+    for (uint32_t bone = 0; bone < boneWeights.size(); bone++)
+    {
+      for (auto const &weight : boneWeights[bone])
+      {
+        influences[weight.vertex].push_back({weight.weight, bone});
+      }
+    }
+
+    for (size_t v = 0; v < vertices.size(); v++)
+    {
+      auto &expected = influences[v];
+      std::sort(expected.begin(), expected.end(), [](std::pair<float, uint32_t> const &a, std::pair<float, uint32_t> const &b) { return a.first > b.first; });
+      expected.resize((std::min)(expected.size(), size_t(meshing::maxBoneInfluences)));
+
+      KXF::Vertex const &vertex = vertices[v];
+      bool correct = true;
+      for (auto const &influence : expected)
+      {
+        bool found = false;
+        for (uint32_t c = 0; c < meshing::maxBoneInfluences; c++)
+        {
+          found = found || (vertex.bones[c] == influence.second && vertex.weights[c] > 0.0f);
+        }
+        correct = correct && found;
+      }
+
+      result.wrongVertices += correct ? 0 : 1;
+      result.maxSumError = (glm::max)(result.maxSumError, std::abs(vertex.weights.x + vertex.weights.y + vertex.weights.z + vertex.weights.w - 1.0f));
+    }
+  }
+
+  template <typename Skin>
+  BenchResult runBenchmark(Skin skin, uint32_t vertexCount, std::vector<std::vector<BenchWeight>> const &boneWeights)
+  {
+    BenchResult result;
+    std::vector<KXF::Vertex> vertices(vertexCount);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    skin(vertices, boneWeights);
+    result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    evaluateSkin(result, vertices, boneWeights);
+    return result;
+  }
+} // namespace
+
+Command_BenchSkinning::~Command_BenchSkinning()
+{
+}
+
+std::string const Command_BenchSkinning::name() const
+{
+  return "bench_skinning";
+}
+
+bool Command_BenchSkinning::execute(std::vector<std::string> args) const
+{
+  int64_t vertexCount = std::atoll(args[2].c_str());
+  if (vertexCount <= 0 || vertexCount > int64_t(UINT32_MAX))
+  {
+    LogError("Invalid vertex count %s", args[2].c_str());
+    return false;
+  }
+
+  std::vector<std::vector<BenchWeight>> boneWeights;
+  generateSkin(boneWeights, uint32_t(vertexCount));
+  LogNotice("Skinning %" PRId64 " vertices to %u bones, %u weights per vertex", vertexCount, benchBoneCount, benchInfluencesPerVertex);
+
+  BenchResult mapResult = runBenchmark(&skinWithMap, uint32_t(vertexCount), boneWeights);
+  LogNotice("Map: %.2f ms, %" PRIu64 " vertices without their largest weights, weight sums off by up to %g", mapResult.milliseconds, mapResult.wrongVertices, mapResult.maxSumError);
+
+  BenchResult arrayResult = runBenchmark(&skinWithArrays, uint32_t(vertexCount), boneWeights);
+  LogNotice("Arrays: %.2f ms, %" PRIu64 " vertices without their largest weights, weight sums off by up to %g", arrayResult.milliseconds, arrayResult.wrongVertices, arrayResult.maxSumError);
+
+  return arrayResult.wrongVertices == 0;
+}
+
+uint64_t Command_BenchSkinning::requiredArguments() const
+{
+  return 3; // 2 + vertex count
+}
@@ -14,7 +14,11 @@
 #include <WIR/XML/XMLElement.hpp>
 #include <WIR/XML/XMLParser.hpp>
 
+#include <Odin/Format.hpp>
+
+#include <algorithm>
 #include <cinttypes>
+#include <numeric>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
@@ -31,6 +35,198 @@ namespace
   // TODO: Should be removed and have glyph generation be completely dynamic, with better packing algorithm!
   const std::u32string glyphData = U" –ABCDEFGHIJKLMNOPQRSTUVWXYZÅÄÖabcdefghijklmnopqrstuvwxyzåäö0123456789§½¶!¡\"@#£¤$%€&¥/{([)]=}?\\+`´±¨~^'´*-_.:·,;¸µ€<>|‸�";
 
+  /** Mixes a 64-bit key with a seed. The runtime must use this exact function to look keys up in the baked tables */
+  uint64_t hashKey(uint64_t key, uint64_t seed)
+  {
+    uint64_t h = key + seed * 0x9E3779B97F4A7C15ULL;
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    return h ^ (h >> 31);
+  }
+
+  /**
+   * Minimal perfect hash over a set of unique keys (hash and displace).
+   * A key belongs to bucket hashKey(key, 0) % seeds.size(), and lives in slot hashKey(key, seed) % slots.size(),
+   * where seed is the value stored for its bucket. Absent keys also land in some slot, so lookups must compare the stored key.
+   */
+  struct PerfectHash
+  {
+    std::vector<uint32_t> seeds;
+
+    /** Index into the input keys for every slot */
+    std::vector<uint32_t> slots;
+  };
+
+  bool buildPerfectHash(std::vector<uint64_t> const &keys, PerfectHash &outHash)
+  {
+    constexpr uint32_t emptySlot = 0xFFFFFFFF;
+    constexpr uint32_t maxSeed = 1 << 24;
+
+    uint32_t keyCount = (uint32_t)keys.size();
+    uint32_t bucketCount = (glm::max)(1U, keyCount / 4);
+
+    outHash.seeds.assign(bucketCount, 0);
+    outHash.slots.assign(keyCount, emptySlot);
+    if (keyCount == 0)
+    {
+      return true;
+    }
+
+    std::vector<std::vector<uint32_t>> buckets(bucketCount);
+    for (uint32_t i = 0; i < keyCount; i++)
+    {
+      buckets[hashKey(keys[i], 0) % bucketCount].push_back(i);
+    }
+
+    // Place the largest buckets first, while the table is still mostly empty
+    std::vector<uint32_t> bucketOrder(bucketCount);
+    std::iota(bucketOrder.begin(), bucketOrder.end(), 0);
+    std::stable_sort(bucketOrder.begin(), bucketOrder.end(), [&buckets](uint32_t a, uint32_t b) { return buckets[a].size() > buckets[b].size(); });
+
+    std::vector<uint32_t> bucketSlots;
+    for (uint32_t bucketId : bucketOrder)
+    {
+      auto const &bucket = buckets[bucketId];
+      if (bucket.empty())
+      {
+        break;
+      }
+
+      bool placed = false;
+      for (uint32_t seed = 1; seed < maxSeed && !placed; seed++)
+      {
+        placed = true;
+        bucketSlots.clear();
+        for (uint32_t keyId : bucket)
+        {
+          uint32_t slot = uint32_t(hashKey(keys[keyId], seed) % keyCount);
+          if (outHash.slots[slot] != emptySlot || std::find(bucketSlots.begin(), bucketSlots.end(), slot) != bucketSlots.end())
+          {
+            placed = false;
+            break;
+          }
+          bucketSlots.push_back(slot);
+        }
+
+        if (placed)
+        {
+          outHash.seeds[bucketId] = seed;
+          for (size_t i = 0; i < bucket.size(); i++)
+          {
+            outHash.slots[bucketSlots[i]] = bucket[i];
+          }
+        }
+      }
+
+      if (!placed)
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  struct KerningPair
+  {
+    uint32_t left = 0;
+    uint32_t right = 0;
+    float offset = 0.0f;
+  };
+
+  /** Writes the kerning pairs as a perfect hash keyed on (left << 32 | right), so runtime lookups are O(1) and never allocate */
+  bool writeKerningTable(wir::Stream &toStream, std::vector<KerningPair> const &pairs)
+  {
+    std::vector<uint64_t> keys;
+    keys.reserve(pairs.size());
+    for (auto const &pair : pairs)
+    {
+      keys.push_back((uint64_t(pair.left) << 32) | uint64_t(pair.right));
+    }
+
+    PerfectHash hash;
+    if (!buildPerfectHash(keys, hash))
+    {
+      LogError("Failed to build kerning table");
+      return false;
+    }
+
+    toStream << uint32_t(hash.slots.size()) << uint32_t(hash.seeds.size());
+    for (uint32_t seed : hash.seeds)
+    {
+      toStream << seed;
+    }
+
+    for (uint32_t slot : hash.slots)
+    {
+      toStream << pairs[slot].left << pairs[slot].right << pairs[slot].offset;
+    }
+
+    return true;
+  }
+
+  /** Codepoints below this (Basic Latin through Latin Extended-B) are looked up directly by index, the rest through a perfect hash */
+  constexpr uint32_t directGlyphRange = 0x250;
+  constexpr uint32_t invalidGlyph = 0xFFFFFFFF;
+
+  /**
+   * Writes the glyph records followed by a lookup table from codepoint to record index.
+   * The table is a dense array for the direct range, then a perfect hash of (codepoint, record) entries for everything else,
+   * so the runtime can map it as-is and resolve a codepoint without parsing or allocating.
+   */
+  bool writeGlyphTable(wir::Stream &toStream, std::map<uint32_t, kit::Glyph> const &glyphIndex)
+  {
+    toStream << uint32_t(glyphIndex.size());
+
+    std::vector<uint32_t> direct(directGlyphRange, invalidGlyph);
+    std::vector<std::pair<uint32_t, uint32_t>> hashed;
+    std::vector<uint64_t> hashedKeys;
+
+    uint32_t record = 0;
+    for (auto const &g : glyphIndex)
+    {
+      toStream << g.first << g.second.advance << g.second.placement << g.second.size << g.second.uv;
+
+      if (g.first < directGlyphRange)
+      {
+        direct[g.first] = record;
+      }
+      else
+      {
+        hashed.push_back({g.first, record});
+        hashedKeys.push_back(g.first);
+      }
+
+      record++;
+    }
+
+    PerfectHash hash;
+    if (!buildPerfectHash(hashedKeys, hash))
+    {
+      LogError("Failed to build glyph lookup table");
+      return false;
+    }
+
+    toStream << directGlyphRange;
+    for (uint32_t d : direct)
+    {
+      toStream << d;
+    }
+
+    toStream << uint32_t(hash.slots.size()) << uint32_t(hash.seeds.size());
+    for (uint32_t seed : hash.seeds)
+    {
+      toStream << seed;
+    }
+
+    for (uint32_t slot : hash.slots)
+    {
+      toStream << hashed[slot].first << hashed[slot].second;
+    }
+
+    return true;
+  }
+
   bool generateFontData(wir::Stream &toStream, float inSize, std::string const &filename)
   {
     FT_Library ftLibrary = FT_Library();
@@ -80,7 +276,8 @@ namespace
     uint32_t gridSizePxi = (uint32_t)gridSizePx;
     glm::uvec2 gridSizePxv = glm::uvec2(gridSizePxi, gridSizePxi);
 
-    std::vector<glm::u8vec4> data(gridSizePxi * gridSizePxi, glm::u8vec4(255, 255, 255, 0));
+    // The atlas only carries coverage, so store it as a single channel and let the runtime sample it as alpha
+    std::vector<uint8_t> data(gridSizePxi * gridSizePxi, 0);
     glm::vec2 currTexPos(0.0f, 0.0f);
     currTexPos.y = gridSizePx - cellSize;
     for (char32_t const &currChar : glyphData)
@@ -111,7 +308,7 @@ namespace
         {
           for (uint32_t ax = 0, tx = currTexPos.x; ax < adder.size.x; ax++, tx++)
           {
-            data[ty * gridSizePxi + tx].a = g->bitmap.buffer[ay * uint32_t(adder.size.x) + ax];
+            data[ty * gridSizePxi + tx] = g->bitmap.buffer[ay * uint32_t(adder.size.x) + ax];
           }
         }
 
@@ -136,15 +333,47 @@ namespace
     float lineHeight = float(ftFace->height) / 64.0f;
     float height = (float)glyphIndex[0x00000058].size.y;
 
-    toStream << uint16_t(glyphIndex.size());
+    bool success = writeGlyphTable(toStream, glyphIndex);
 
-    for (auto g : glyphIndex)
+    toStream << gridSizePxv << lineHeight << height;
+    toStream << uint32_t(odin::F_R8_UNORM);
+    toStream.write(data.data(), data.size() * sizeof(uint8_t));
+
+    // Bake the kerning pairs between every glyph we cached, so the runtime never has to ask FreeType during layout.
+    // FreeType only reads the legacy 'kern' table here, fonts that only carry GPOS kerning will get an empty table.
+    std::vector<KerningPair> kerningPairs;
+    if (FT_HAS_KERNING(ftFace))
     {
-      toStream << g.first << g.second.advance << g.second.placement << g.second.size << g.second.uv;
+      std::vector<std::pair<uint32_t, FT_UInt>> charIndices;
+      for (auto const &g : glyphIndex)
+      {
+        FT_UInt charIndex = FT_Get_Char_Index(ftFace, g.first);
+        if (charIndex != 0)
+        {
+          charIndices.push_back({g.first, charIndex});
+        }
+      }
+
+      for (auto const &left : charIndices)
+      {
+        for (auto const &right : charIndices)
+        {
+          FT_Vector delta;
+          if (FT_Get_Kerning(ftFace, left.second, right.second, FT_KERNING_DEFAULT, &delta) != 0 || delta.x == 0)
+          {
+            continue;
+          }
+
+          KerningPair pair;
+          pair.left = left.first;
+          pair.right = right.first;
+          pair.offset = float(F26DOT6_TO_DOUBLE(delta.x));
+          kerningPairs.push_back(pair);
+        }
+      }
     }
 
-    toStream << gridSizePxv << lineHeight << height;
-    toStream.write(reinterpret_cast<uint8_t const *>(data.data()), data.size() * sizeof(glm::u8vec4));
+    success = success && writeKerningTable(toStream, kerningPairs);
 
     if (FT_Done_Face(ftFace))
     {
@@ -156,7 +385,7 @@ namespace
       LogError("Could not destroy Freetype");
     }
 
-    return true;
+    return success;
   }
 
 } // namespace
@@ -1,6 +1,15 @@
 #include "Command_ImportMesh.hpp"
 
+#include "AnimationCompression.hpp"
+#include "AnimationResampling.hpp"
 #include "KXFImporter_Assimp.hpp"
+#include "MeshClustering.hpp"
+#include "MeshCompression.hpp"
+#include "MeshOptimization.hpp"
+#include "MeshQuantization.hpp"
+#include "MeshSimplification.hpp"
+#include "MeshWelding.hpp"
+#include "Utils.hpp"
 
 #include <KIT/FBX/FBXDocument.hpp>
 #include <KIT/KXF/KXFDocument.hpp>
@@ -18,11 +27,201 @@
 
 #include <WIR/Error.hpp>
 #include <WIR/Filesystem.hpp>
+#include <WIR/Stream.hpp>
 
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+
+namespace
+{
+  struct LODLevel
+  {
+    meshing::SimplifySettings settings;
+
+    /** Fraction of the screen height covered by the mesh bounds below which the level is drawn */
+    float screenSize = 1.0f;
+  };
+
+  /** An asset written by the bake stage, independent of every other one */
+  struct BakeTask
+  {
+    /** What is exported, for the log */
+    std::string description;
+
+    std::string path;
+
+    /** Writes the asset to the path, returns false if it failed */
+    std::function<bool(std::string const &)> bake;
+  };
+
+  /** Writes the meshlets of a submesh, a sibling of its mesh asset with the vertex and index buffers left to it */
+  bool writeMeshlets(std::string const &path, meshing::MeshletData const &data, uint32_t maxVertices, uint32_t maxTriangles)
+  {
+    wir::Stream meshletData;
+    meshletData << maxVertices << maxTriangles;
+
+    meshletData << uint32_t(data.meshlets.size());
+    for (auto const &meshlet : data.meshlets)
+    {
+      meshletData << meshlet.vertexOffset << meshlet.vertexCount << meshlet.triangleOffset << meshlet.triangleCount;
+      meshletData << meshlet.center << meshlet.radius;
+      meshletData << meshlet.coneApex << meshlet.coneAxis << meshlet.coneCutoff;
+    }
+
+    meshletData << uint32_t(data.vertices.size());
+    meshletData.write(data.vertices.data(), data.vertices.size() * sizeof(uint32_t));
+
+    meshletData << uint32_t(data.triangles.size());
+    meshletData.write(data.triangles.data(), data.triangles.size() * sizeof(uint8_t));
+
+    return utils::writeAsset(path, "kit::Meshlets", meshletData);
+  }
+
+  /**
+   * Writes the reduced keys of an animation, with the rotations packed by clips::packSmallestThree. Tracks keep their order and
+   * names, vector tracks have type 0 and three floats per key, rotation tracks type 1 and three 16 bit words per key.
+   */
+  bool writeAnimationKeys(std::string const &path, KXF::Animation const *animation)
+  {
+    wir::Stream animationData;
+    animationData << animation->name << float(animation->duration);
+
+    animationData << uint32_t(animation->channels.size());
+    for (auto channel : animation->channels)
+    {
+      animationData << channel->name << uint32_t(channel->tracks.size());
+      for (auto track : channel->tracks)
+      {
+        animationData << track->name;
+        if (auto quatTrack = dynamic_cast<KXF::AnimationTrackQuat const *>(track))
+        {
+          animationData << uint32_t(1) << uint32_t(quatTrack->keys.size());
+          for (auto const &key : quatTrack->keys)
+          {
+            animationData << float(key.time);
+          }
+
+          for (auto const &key : quatTrack->keys)
+          {
+            uint16_t packed[3];
+            clips::packSmallestThree(key.value, packed);
+            animationData.write(packed, sizeof(packed));
+          }
+        }
+        else if (auto vec3Track = dynamic_cast<KXF::AnimationTrackVec3 const *>(track))
+        {
+          animationData << uint32_t(0) << uint32_t(vec3Track->keys.size());
+          for (auto const &key : vec3Track->keys)
+          {
+            animationData << float(key.time);
+          }
+
+          for (auto const &key : vec3Track->keys)
+          {
+            animationData << key.value;
+          }
+        }
+        else
+        {
+          LogError("Unsupported track %s in animation %s", track->name.c_str(), animation->name.c_str());
+          return false;
+        }
+      }
+    }
+
+    return utils::writeAsset(path, "kit::AnimationKeys", animationData);
+  }
+
+  /** Writes an animation resampled at a fixed rate, the frames laid out as in clips::UniformClip */
+  bool writeUniformAnimation(std::string const &path, KXF::Animation const *animation, std::vector<KXF::Skeleton *> const &skeletons, float sampleRate)
+  {
+    clips::UniformClip clip;
+    clips::resampleUniform(clip, animation, skeletons, sampleRate);
+
+    wir::Stream animationData;
+    animationData << animation->name << float(animation->duration);
+    animationData << clip.sampleRate << clip.frameCount << clip.laneCount << clips::uniformStreamCount;
+
+    animationData << uint32_t(clip.channels.size());
+    for (auto const &channel : clip.channels)
+    {
+      animationData << channel;
+    }
+
+    animationData.write(clip.frames.data(), clip.frames.size() * sizeof(float));
+
+    return utils::writeAsset(path, "kit::UniformAnimation", animationData);
+  }
+
+  /**
+   * Bakes a submesh to a mesh asset, through KXF with full precision vertices or by us with quantized ones. Quantized vertices
+   * and indices can go through the geometry codecs ahead of the generic compression.
+   */
+  bool bakeSubmesh(KXF::Submesh *submesh, std::string const &path, KXF::VertexFlags vflags, KXF::IndexFlags iflags, bool quantize, bool compressGeometry)
+  {
+    if (!quantize)
+    {
+      submesh->bakeToMesh(path, vflags, iflags);
+      return true;
+    }
+
+    meshing::QuantizedVertices vertices;
+    meshing::quantizeVertices(vertices, submesh->vertices, vflags);
+
+    // 0 for raw vertices and indices, 1 for the byte plane codecs in MeshCompression.hpp
+    wir::Stream meshData;
+    meshData << uint32_t(compressGeometry ? 1 : 0);
+
+    // Decode parameters come ahead of the interleaved vertices, see meshing::QuantizedVertices for the layout
+    meshData << uint32_t(vertices.flags) << vertices.stride << vertices.vertexCount << vertices.boneIndexSize;
+    meshData << vertices.positionOffset << vertices.positionScale;
+    if (compressGeometry)
+    {
+      std::vector<uint8_t> encoded;
+      meshing::encodeVertexBuffer(encoded, vertices.data.data(), vertices.vertexCount, vertices.stride);
+      meshData.write(encoded.data(), encoded.size());
+    }
+    else
+    {
+      meshData.write(vertices.data.data(), vertices.data.size());
+    }
+
+    uint32_t indexSize = (iflags & KXF::IF_Use16bit) && vertices.vertexCount <= 65536 ? 2 : 4;
+    meshData << indexSize << uint32_t(submesh->indices.size());
+    if (compressGeometry)
+    {
+      std::vector<uint8_t> encoded;
+      meshing::encodeIndexBuffer(encoded, submesh->indices, indexSize);
+      meshData.write(encoded.data(), encoded.size());
+    }
+    else if (indexSize == 2)
+    {
+      std::vector<uint16_t> indices(submesh->indices.begin(), submesh->indices.end());
+      meshData.write(indices.data(), indices.size() * sizeof(uint16_t));
+    }
+    else
+    {
+      meshData.write(submesh->indices.data(), submesh->indices.size() * sizeof(uint32_t));
+    }
+
+    meshData << submesh->materialPath;
+
+    meshData << uint32_t(submesh->boneIndex.size());
+    for (auto const &bone : submesh->boneIndex)
+    {
+      meshData << bone.first << bone.second;
+    }
+
+    return utils::writeAsset(path, "kit::QuantizedMesh", meshData);
+  }
+} // namespace
+
 Command_ImportMesh::~Command_ImportMesh()
 {
 }
@@ -152,6 +351,112 @@ bool Command_ImportMesh::execute(std::vector<std::string> args) const
   bool animations = true;
   root->boolean("Animations", animations);
 
+  // Keys that interpolation reproduces within the errors are removed, see clips::reduceKeys. This is lossy, so existing
+  // import settings keep their exact keys unless they opt in
+  bool reduceAnimations = false;
+  root->boolean("ReduceAnimations", reduceAnimations);
+
+  clips::ReductionSettings reductionSettings;
+  double animationPositionError = reductionSettings.position;
+  root->decimal("AnimationPositionError", animationPositionError);
+  reductionSettings.position = float(animationPositionError);
+
+  double animationRotationError = reductionSettings.rotation;
+  root->decimal("AnimationRotationError", animationRotationError);
+  reductionSettings.rotation = float(animationRotationError);
+
+  double animationScaleError = reductionSettings.scale;
+  root->decimal("AnimationScaleError", animationScaleError);
+  reductionSettings.scale = float(animationScaleError);
+
+  // KXF bakes full precision keys, Keys is baked by us with quantized rotations, Uniform as whole poses at the sample rate
+  std::string animationFormat = "KXF";
+  root->string("AnimationFormat", animationFormat);
+  if (animationFormat != "KXF" && animationFormat != "Keys" && animationFormat != "Uniform")
+  {
+    LogError("Unknown animation format %s, expected KXF, Keys or Uniform", animationFormat.c_str());
+    return false;
+  }
+
+  double animationSampleRate = clips::defaultSampleRate;
+  root->decimal("AnimationSampleRate", animationSampleRate);
+  if (animationSampleRate <= 0.0)
+  {
+    LogError("Animation sample rate must be positive");
+    return false;
+  }
+
+  // Duplicate vertices are merged by us rather than by assimp, with a tolerance per attribute
+  bool weld = true;
+  root->boolean("Weld", weld);
+
+  meshing::WeldSettings weldSettings;
+  double weldPosition = weldSettings.position;
+  root->decimal("WeldPosition", weldPosition);
+  weldSettings.position = float(weldPosition);
+
+  double weldNormal = weldSettings.normal;
+  root->decimal("WeldNormal", weldNormal);
+  weldSettings.normal = float(weldNormal);
+
+  double weldTangent = weldSettings.tangent;
+  root->decimal("WeldTangent", weldTangent);
+  weldSettings.tangent = float(weldTangent);
+
+  double weldTexCoord = weldSettings.texCoord;
+  root->decimal("WeldTexCoord", weldTexCoord);
+  weldSettings.texCoord = float(weldTexCoord);
+
+  double weldWeight = weldSettings.weight;
+  root->decimal("WeldWeight", weldWeight);
+  weldSettings.weight = float(weldWeight);
+
+  // Triangles and vertices are reordered for the vertex cache, overdraw and vertex fetch
+  bool optimize = true;
+  root->boolean("Optimize", optimize);
+
+  double overdrawThreshold = meshing::defaultOverdrawThreshold;
+  root->decimal("OverdrawThreshold", overdrawThreshold);
+
+  // Compact vertex formats, baked by us instead of KXF
+  bool quantize = false;
+  root->boolean("Quantize", quantize);
+
+  // Quantized meshes are delta encoded into byte planes before the generic compression
+  bool compressGeometry = true;
+  root->boolean("CompressGeometry", compressGeometry);
+
+  // Meshlets for cluster culling, written next to every mesh asset
+  bool meshlets = false;
+  root->boolean("Meshlets", meshlets);
+
+  int64_t meshletVertices = meshing::defaultMeshletVertices;
+  root->integer("MeshletVertices", meshletVertices);
+
+  int64_t meshletTriangles = meshing::defaultMeshletTriangles;
+  root->integer("MeshletTriangles", meshletTriangles);
+
+  if (meshletVertices < 3 || meshletVertices > 255 || meshletTriangles < 1)
+  {
+    LogError("Meshlets need between 3 and 255 vertices and at least one triangle");
+    return false;
+  }
+
+  // Levels of detail below the full mesh. Each level halves the triangles, doubles the tolerated error and halves the screen size
+  // of the previous one, unless overridden by the LOD children in order
+  int64_t lodCount = 0;
+  root->integer("LODs", lodCount);
+
+  std::vector<LODLevel> lodLevels;
+  auto addLODLevel = [&lodLevels]() -> LODLevel & {
+    float scale = std::pow(0.5f, float(lodLevels.size() + 1));
+    lodLevels.emplace_back();
+    lodLevels.back().settings.ratio = scale;
+    lodLevels.back().settings.error = 0.005f / scale;
+    lodLevels.back().screenSize = scale;
+    return lodLevels.back();
+  };
+
   std::map<std::string, std::string> mappings;
 
   for (auto child : root->children())
@@ -165,6 +470,27 @@ bool Command_ImportMesh::execute(std::vector<std::string> args) const
 
       mappings[id] = path;
     }
+    else if (child->name() == "LOD")
+    {
+      LODLevel &level = addLODLevel();
+
+      double ratio = level.settings.ratio;
+      child->decimal("Ratio", ratio);
+      level.settings.ratio = float(ratio);
+
+      double error = level.settings.error;
+      child->decimal("Error", error);
+      level.settings.error = float(error);
+
+      double screenSize = level.screenSize;
+      child->decimal("ScreenSize", screenSize);
+      level.screenSize = float(screenSize);
+    }
+  }
+
+  while (int64_t(lodLevels.size()) < lodCount)
+  {
+    addLODLevel();
   }
 
   auto importer = new KXF::Importer_Assimp();
@@ -176,71 +502,265 @@ bool Command_ImportMesh::execute(std::vector<std::string> args) const
 
   delete importer;
 
-  uint32_t i = 0;
+  if (animations && reduceAnimations)
+  {
+    for (auto animation : kxfDoc->animations())
+    {
+      clips::ReductionStatistics statistics = clips::reduceKeys(animation, kxfDoc->skeletons(), reductionSettings);
+      LogNotice("Reduced animation %s, %llu -> %llu keys, %u constant tracks", animation->name.c_str(), (unsigned long long)statistics.keysBefore, (unsigned long long)statistics.keysAfter, statistics.constantTracks);
+    }
+  }
+
+  std::vector<KXF::Submesh *> submeshes;
+  std::vector<std::string> submeshNames;
+  uint64_t vertexCount = 0;
   for (auto mesh : kxfDoc->meshes())
   {
+    for (auto submesh : mesh->submeshes)
+    {
+      // Named like the exported assets, which are numbered across all meshes
+      submeshNames.push_back(mesh->submeshes.size() > 1 ? wir::format("%s_%u", mesh->name.c_str(), uint32_t(submeshes.size())) : mesh->name);
+      submeshes.push_back(submesh);
+      vertexCount += submesh->vertices.size();
+    }
+  }
+
+  if (weld)
+  {
+    uint64_t removedCount = meshing::weldVertices(submeshes, weldSettings);
+    LogNotice("Welded %llu of %llu vertices", (unsigned long long)removedCount, (unsigned long long)vertexCount);
+  }
+
+  if (optimize)
+  {
+    std::vector<meshing::VertexCacheStatistics> before(submeshes.size());
+    std::vector<meshing::VertexCacheStatistics> after(submeshes.size());
+
+    int64_t submeshCount = int64_t(submeshes.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int64_t s = 0; s < submeshCount; s++)
+    {
+      meshing::optimizeSubmesh(submeshes[s], float(overdrawThreshold), before[s], after[s]);
+    }
+
+    // Logged afterwards, so the output doesn't depend on the thread scheduling
+    for (size_t s = 0; s < submeshes.size(); s++)
+    {
+      LogNotice("Optimized submesh %s, ACMR: %.3f -> %.3f, ATVR: %.3f -> %.3f", submeshNames[s].c_str(), before[s].acmr, after[s].acmr, before[s].atvr, after[s].atvr);
+    }
+  }
+
+  std::vector<meshing::MeshletData> submeshMeshlets(meshlets ? submeshes.size() : 0);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int64_t s = 0; s < int64_t(submeshMeshlets.size()); s++)
+  {
+    meshing::buildMeshlets(submeshMeshlets[s], submeshes[s], uint32_t(meshletVertices), uint32_t(meshletTriangles));
+  }
+
+  // Every level is simplified from the full submesh rather than from the previous level, and all of them in parallel
+  size_t lodTaskCount = submeshes.size() * lodLevels.size();
+  std::vector<KXF::Submesh *> lodSubmeshes(lodTaskCount, nullptr);
+  std::vector<float> lodErrors(lodTaskCount, 0.0f);
+  std::vector<meshing::MeshletData> lodMeshlets(meshlets ? lodTaskCount : 0);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int64_t t = 0; t < int64_t(lodTaskCount); t++)
+  {
+    KXF::Submesh *source = submeshes[t / lodLevels.size()];
+    LODLevel const &level = lodLevels[t % lodLevels.size()];
+
+    KXF::Submesh *lod = new KXF::Submesh();
+    lod->mesh = source->mesh;
+    lod->vertexFlags = source->vertexFlags;
+    lod->indexFlags = source->indexFlags;
+    lod->boneIndex = source->boneIndex;
+    lod->vertices = source->vertices;
+    lodErrors[t] = meshing::simplify(lod->indices, source, level.settings);
+
+    // Also drops the vertices the level no longer uses
+    if (optimize)
+    {
+      meshing::VertexCacheStatistics before, after;
+      meshing::optimizeSubmesh(lod, float(overdrawThreshold), before, after);
+    }
+    else
+    {
+      meshing::optimizeVertexFetch(lod->vertices, lod->indices);
+    }
+
+    if (meshlets)
+    {
+      meshing::buildMeshlets(lodMeshlets[t], lod, uint32_t(meshletVertices), uint32_t(meshletTriangles));
+    }
+
+    lodSubmeshes[t] = lod;
+  }
+
+  for (auto submesh : submeshes)
+  {
+    auto f = mappings.find(submesh->materialPath);
+    if (f != mappings.end())
+      submesh->materialPath = f->second;
+  }
+
+  if (physics)
+  {
+    auto const &meshes = kxfDoc->meshes();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int64_t m = 0; m < int64_t(meshes.size()); m++)
+    {
+      meshes[m]->generateTriangles();
+    }
+  }
+
+  // Every asset is baked by its own task, all of them in parallel
+  std::vector<BakeTask> tasks;
+  auto addTask = [&tasks, &outputDir](std::string const &description, std::string const &file, std::function<bool(std::string const &)> bake) {
+    tasks.push_back({description, outputDir + "/" + file, bake});
+  };
+
+  for (size_t s = 0; s < submeshes.size(); s++)
+  {
+    KXF::Submesh *submesh = submeshes[s];
+
+    // global is what we request, submesh flags is what is supported
+    /// Use the flags where both exist
+    KXF::VertexFlags vflags = KXF::VertexFlags(submesh->vertexFlags & globalVertexFlags);
+    KXF::IndexFlags iflags = KXF::IndexFlags(submesh->indexFlags & globalIndexFlags);
+
+    addTask(wir::format("submesh %s", submeshNames[s].c_str()), wir::format("Mesh_%s.asset", submeshNames[s].c_str()), [=](std::string const &path) {
+      return bakeSubmesh(submesh, path, vflags, iflags, quantize, compressGeometry);
+    });
+
     if (physics)
-      mesh->generateTriangles();
+    {
+      addTask(wir::format("physics mesh %s", submeshNames[s].c_str()), wir::format("PhysicsMesh_%s.asset", submeshNames[s].c_str()), [=](std::string const &path) {
+        submesh->bakeToPhysicsMesh(path);
+        return true;
+      });
+    }
 
-    if (mesh->submeshes.size() > 1)
+    if (meshlets)
     {
-      for (auto submesh : mesh->submeshes)
-      {
-        // global is what we request, submesh flags is what is supported
-        /// Use the flags where both exist
-        KXF::VertexFlags vflags = KXF::VertexFlags(submesh->vertexFlags & globalVertexFlags);
-        KXF::IndexFlags iflags = KXF::IndexFlags(submesh->indexFlags & globalIndexFlags);
-
-        std::string mat = submesh->materialPath;
-        auto f = mappings.find(mat);
-        if (f != mappings.end())
-          mat = f->second;
-
-        submesh->materialPath = mat;
-
-        LogNotice("Exporting submesh %s_%u", mesh->name.c_str(), i);
-        submesh->bakeToMesh(wir::format("%s/Mesh_%s_%u.asset", outputDir.c_str(), mesh->name.c_str(), i), vflags, iflags);
-        if (physics)
-          submesh->bakeToPhysicsMesh(wir::format("%s/PhysicsMesh_%s_%u.asset", outputDir.c_str(), mesh->name.c_str(), i));
-        i++;
-      }
+      meshing::MeshletData const *data = &submeshMeshlets[s];
+      addTask(wir::format("%u meshlets of submesh %s", uint32_t(data->meshlets.size()), submeshNames[s].c_str()), wir::format("Meshlets_%s.asset", submeshNames[s].c_str()), [=](std::string const &path) {
+        return writeMeshlets(path, *data, uint32_t(meshletVertices), uint32_t(meshletTriangles));
+      });
     }
-    else if (mesh->submeshes.size() > 0)
+
+    if (lodLevels.empty())
+    {
+      continue;
+    }
+
+    // The levels are sibling assets, listed with their switch distances in a level of detail asset per submesh.
+    // Per level: mesh asset, screen size, error relative to the largest extent of the submesh, triangle count
+    auto lodData = std::make_shared<wir::Stream>();
+    *lodData << uint32_t(lodLevels.size() + 1);
+    *lodData << wir::format("Mesh_%s.asset", submeshNames[s].c_str()) << 1.0f << 0.0f << uint32_t(submesh->indices.size() / 3);
+
+    for (size_t l = 0; l < lodLevels.size(); l++)
     {
-      KXF::VertexFlags vflags = KXF::VertexFlags(mesh->submeshes[0]->vertexFlags & globalVertexFlags);
-      KXF::IndexFlags iflags = KXF::IndexFlags(mesh->submeshes[0]->indexFlags & globalIndexFlags);
+      size_t t = s * lodLevels.size() + l;
+      KXF::Submesh *lod = lodSubmeshes[t];
+      lod->materialPath = submesh->materialPath;
 
-      std::string mat = mesh->submeshes[0]->materialPath;
-      auto f = mappings.find(mat);
-      if (f != mappings.end())
-        mat = f->second;
+      std::string lodFile = wir::format("Mesh_%s_LOD%u.asset", submeshNames[s].c_str(), uint32_t(l + 1));
+      *lodData << lodFile << lodLevels[l].screenSize << lodErrors[t] << uint32_t(lod->indices.size() / 3);
 
-      mesh->submeshes[0]->materialPath = mat;
+      addTask(wir::format("submesh %s LOD %u, %u triangles, error %f", submeshNames[s].c_str(), uint32_t(l + 1), uint32_t(lod->indices.size() / 3), lodErrors[t]), lodFile, [=](std::string const &path) {
+        return bakeSubmesh(lod, path, vflags, iflags, quantize, compressGeometry);
+      });
 
-      LogNotice("Exporting submesh %s", mesh->name.c_str());
-      mesh->submeshes[0]->bakeToMesh(wir::format("%s/Mesh_%s.asset", outputDir.c_str(), mesh->name.c_str()), vflags, iflags);
-      if (physics)
-        mesh->submeshes[0]->bakeToPhysicsMesh(wir::format("%s/PhysicsMesh_%s.asset", outputDir.c_str(), mesh->name.c_str()));
-      i++;
+      if (meshlets)
+      {
+        meshing::MeshletData const *data = &lodMeshlets[t];
+        addTask(wir::format("%u meshlets of submesh %s LOD %u", uint32_t(data->meshlets.size()), submeshNames[s].c_str(), uint32_t(l + 1)), wir::format("Meshlets_%s_LOD%u.asset", submeshNames[s].c_str(), uint32_t(l + 1)), [=](std::string const &path) {
+          return writeMeshlets(path, *data, uint32_t(meshletVertices), uint32_t(meshletTriangles));
+        });
+      }
     }
+
+    addTask(wir::format("levels of detail of submesh %s", submeshNames[s].c_str()), wir::format("MeshLODs_%s.asset", submeshNames[s].c_str()), [=](std::string const &path) {
+      return utils::writeAsset(path, "kit::MeshLODs", *lodData);
+    });
   }
 
   if (skeleton)
     for (auto s : kxfDoc->skeletons())
     {
-      LogNotice("Exporting skeleton %s", s->name.c_str());
-      s->bakeToAsset(wir::format("%s/Skeleton_%s.asset", outputDir.c_str(), s->name.c_str()));
+      addTask(wir::format("skeleton %s", s->name.c_str()), wir::format("Skeleton_%s.asset", s->name.c_str()), [=](std::string const &path) {
+        s->bakeToAsset(path);
+        return true;
+      });
     }
 
   if (animations)
     for (auto animation : kxfDoc->animations())
     {
-      LogNotice("Exporting animation %s", animation->name.c_str());
-      animation->bakeToAsset(wir::format("%s/Animation_%s.asset", outputDir.c_str(), animation->name.c_str()));
+      addTask(wir::format("animation %s", animation->name.c_str()), wir::format("Animation_%s.asset", animation->name.c_str()), [=](std::string const &path) {
+        if (animationFormat == "Keys")
+        {
+          return writeAnimationKeys(path, animation);
+        }
+
+        if (animationFormat == "Uniform")
+        {
+          return writeUniformAnimation(path, animation, kxfDoc->skeletons(), float(animationSampleRate));
+        }
+
+        animation->bakeToAsset(path);
+        return true;
+      });
+    }
+
+  for (auto const &task : tasks)
+  {
+    LogNotice("Exporting %s", task.description.c_str());
+  }
+
+  // KXF bakes don't report failures, so a task also fails if its asset isn't there afterwards. Stale assets from earlier imports
+  // are removed first so they can't hide one.
+  std::vector<uint8_t> baked(tasks.size(), 0);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int64_t t = 0; t < int64_t(tasks.size()); t++)
+  {
+    std::remove(tasks[t].path.c_str());
+    baked[t] = tasks[t].bake(tasks[t].path) && wir::File(tasks[t].path).exist();
+  }
+
+  uint32_t failedCount = 0;
+  for (size_t t = 0; t < tasks.size(); t++)
+  {
+    if (!baked[t])
+    {
+      LogError("Failed to export %s", tasks[t].description.c_str());
+      failedCount++;
     }
+  }
+
+  for (auto lod : lodSubmeshes)
+  {
+    delete lod;
+  }
 
   delete kxfDoc;
 
+  if (failedCount > 0)
+  {
+    LogError("Failed to export %u of %u assets", failedCount, uint32_t(tasks.size()));
+    return false;
+  }
+
   return true;
 }
 
@@ -0,0 +1,515 @@
+#include "Command_ImportVector.hpp"
+#include "Utils.hpp"
+
+#include "MSDF/msdfgen.h"
+
+#include <WIR/Error.hpp>
+#include <WIR/Filesystem.hpp>
+#include <WIR/Math.hpp>
+#include <WIR/Stream.hpp>
+
+#include <WIR/XML/XMLAttribute.hpp>
+#include <WIR/XML/XMLDocument.hpp>
+#include <WIR/XML/XMLElement.hpp>
+#include <WIR/XML/XMLParser.hpp>
+
+#include <Odin/Format.hpp>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <numeric>
+
+namespace
+{
+
+  struct VectorIcon
+  {
+    std::string name;
+    msdfgen::Shape shape;
+
+    /** Region of the shape that is fitted into the cell, the view box if one was given and the shape bounds otherwise */
+    msdfgen::Shape::Bounds frame = {0.0, 0.0, 0.0, 0.0};
+
+    /** SVG coordinates run top to bottom, shape descriptions bottom to top */
+    bool topDown = false;
+
+    msdfgen::FillRule fillRule = msdfgen::FILL_NONZERO;
+    uint32_t size = 0;
+
+    /** Top left corner of the cell in the atlas */
+    glm::uvec2 position = glm::uvec2(0, 0);
+
+    msdfgen::Bitmap<float, 4> field;
+  };
+
+  bool parseViewBox(std::string viewBox, msdfgen::Shape::Bounds &outFrame)
+  {
+    std::replace(viewBox.begin(), viewBox.end(), ',', ' ');
+    double x = 0.0, y = 0.0, w = 0.0, h = 0.0;
+    if (sscanf(viewBox.c_str(), "%lf %lf %lf %lf", &x, &y, &w, &h) != 4 || w <= 0.0 || h <= 0.0)
+    {
+      return false;
+    }
+
+    outFrame = {x, y, x + w, y + h};
+    return true;
+  }
+
+  /** Finds the quoted value of an attribute within a single tag */
+  bool findAttribute(std::string const &tag, char const *name, std::string &outValue)
+  {
+    std::string key = std::string(name) + "=";
+    for (size_t pos = tag.find(key); pos != std::string::npos; pos = tag.find(key, pos + 1))
+    {
+      // Make sure we matched the whole attribute name, so d= never matches id=
+      if (pos == 0 || !isspace((unsigned char)tag[pos - 1]))
+      {
+        continue;
+      }
+
+      size_t quote = pos + key.size();
+      if (quote >= tag.size() || (tag[quote] != '"' && tag[quote] != '\''))
+      {
+        continue;
+      }
+
+      size_t end = tag.find(tag[quote], quote + 1);
+      if (end == std::string::npos)
+      {
+        return false;
+      }
+
+      outValue = tag.substr(quote + 1, end - quote - 1);
+      return true;
+    }
+
+    return false;
+  }
+
+  /**
+   * Reads the path elements of an SVG document into the icon shape, and the view box of its root element.
+   * This is not a full SVG implementation: transforms, basic shapes and strokes are ignored, icons are expected to be flattened to filled paths.
+   */
+  bool loadSvgFile(std::string const &filename, VectorIcon &icon)
+  {
+    std::string svg;
+    if (!utils::readFileToString(filename, svg))
+    {
+      return false;
+    }
+
+    bool hasFrame = false;
+    uint32_t pathCount = 0;
+    for (size_t begin = svg.find('<'); begin != std::string::npos; begin = svg.find('<', begin + 1))
+    {
+      if (svg.compare(begin, 4, "<!--") == 0)
+      {
+        begin = svg.find("-->", begin);
+        if (begin == std::string::npos)
+        {
+          break;
+        }
+        continue;
+      }
+
+      size_t end = svg.find('>', begin);
+      if (end == std::string::npos)
+      {
+        break;
+      }
+
+      std::string tag = svg.substr(begin + 1, end - begin - 1);
+      size_t nameEnd = 0;
+      while (nameEnd < tag.size() && !isspace((unsigned char)tag[nameEnd]) && tag[nameEnd] != '/')
+      {
+        nameEnd++;
+      }
+      std::string tagName = tag.substr(0, nameEnd);
+
+      std::string value;
+      if (findAttribute(tag, "transform", value))
+      {
+        LogWarning("%s: transform on <%s> is not supported and will be ignored", icon.name.c_str(), tagName.c_str());
+      }
+
+      if (tagName == "svg" && !hasFrame && findAttribute(tag, "viewBox", value))
+      {
+        hasFrame = parseViewBox(value, icon.frame);
+      }
+      else if (tagName == "path" && findAttribute(tag, "d", value))
+      {
+        if (!msdfgen::buildShapeFromSvgPath(icon.shape, value.c_str()))
+        {
+          LogError("%s: malformed path data", icon.name.c_str());
+          return false;
+        }
+
+        // The signs of the whole shape are corrected with a single fill rule, so every path has to use the same one
+        msdfgen::FillRule fillRule = findAttribute(tag, "fill-rule", value) && value == "evenodd" ? msdfgen::FILL_ODD : msdfgen::FILL_NONZERO;
+        if (pathCount > 0 && fillRule != icon.fillRule)
+        {
+          LogError("%s: paths with different fill rules are not supported", icon.name.c_str());
+          return false;
+        }
+        icon.fillRule = fillRule;
+        pathCount++;
+      }
+      begin = end;
+    }
+
+    if (pathCount == 0)
+    {
+      LogError("%s: no path elements found", icon.name.c_str());
+      return false;
+    }
+
+    if (!hasFrame)
+    {
+      icon.frame = icon.shape.getBounds();
+    }
+
+    icon.topDown = true;
+    return true;
+  }
+
+  /** Generates the MTSDF of the icon into its cell sized field */
+  void generateIcon(VectorIcon &icon, double range, double edgeThreshold, double angleThreshold, bool overlapSupport, msdfgen::GeneratorPrecision precision)
+  {
+    icon.shape.normalize();
+    msdfgen::edgeColoringSimple(icon.shape, angleThreshold);
+
+    // Fit the frame into the cell, leaving half the range around it so the field does not clip at the edges
+    double frameWidth = icon.frame.r - icon.frame.l;
+    double frameHeight = icon.frame.t - icon.frame.b;
+    double content = (glm::max)(1.0, double(icon.size) - range);
+    double scale = content / (glm::max)(frameWidth, frameHeight);
+    double shapeRange = range / scale;
+    msdfgen::Vector2 translate(0.5 * (icon.size / scale - frameWidth) - icon.frame.l, 0.5 * (icon.size / scale - frameHeight) - icon.frame.b);
+
+    icon.field = msdfgen::Bitmap<float, 4>(icon.size, icon.size);
+
+    // Authored paths rarely wind their contours the way the generator expects, so the signs are corrected against the
+    // rasterized fill before the clashes and edge artifacts are, as the channels may only be compared once their signs are right
+    msdfgen::generateMTSDFUncorrected(icon.field, icon.shape, shapeRange, scale, translate, overlapSupport, precision);
+    msdfgen::distanceSignCorrection(icon.field, icon.shape, scale, translate, icon.fillRule);
+    if (edgeThreshold > 0.0)
+    {
+      msdfgen::msdfErrorCorrection(icon.field, edgeThreshold / (msdfgen::Vector2(scale) * shapeRange));
+    }
+    msdfgen::msdfPatchEdgeArtifacts(icon.field, icon.shape, shapeRange, scale, translate, overlapSupport);
+  }
+
+  /** Packs the cells into rows, tallest first, and returns the atlas size */
+  glm::uvec2 packIcons(std::vector<VectorIcon> &icons)
+  {
+    uint64_t area = 0;
+    uint32_t largest = 0;
+    for (auto const &icon : icons)
+    {
+      area += uint64_t(icon.size) * icon.size;
+      largest = (glm::max)(largest, icon.size);
+    }
+
+    uint32_t width = 1;
+    while (uint64_t(width) * width < area || width < largest)
+    {
+      width *= 2;
+    }
+
+    std::vector<size_t> order(icons.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&icons](size_t a, size_t b) { return icons[a].size > icons[b].size; });
+
+    glm::uvec2 cursor(0, 0);
+    uint32_t rowHeight = 0;
+    for (size_t i : order)
+    {
+      auto &icon = icons[i];
+      if (cursor.x + icon.size > width)
+      {
+        cursor.x = 0;
+        cursor.y += rowHeight;
+        rowHeight = 0;
+      }
+
+      icon.position = cursor;
+      cursor.x += icon.size;
+      rowHeight = (glm::max)(rowHeight, icon.size);
+    }
+
+    return glm::uvec2(width, cursor.y + rowHeight);
+  }
+
+} // namespace
+
+Command_ImportVector::~Command_ImportVector()
+{
+}
+
+std::string const Command_ImportVector::name() const
+{
+  return "import_vector";
+}
+
+bool Command_ImportVector::execute(std::vector<std::string> args) const
+{
+  auto inputFile = wir::File(args[2]);
+  if (!inputFile.exist())
+  {
+    LogError("Input file does not exist!");
+    return false;
+  }
+
+  auto importFile = inputFile.path();
+
+  if (inputFile.extension() != ".import")
+  {
+    importFile += ".import";
+
+    if (!wir::File(importFile).exist())
+    {
+      std::string importData = wir::format("<Vector OutputFile=\"%s.asset\" Size=\"64\" Range=\"8\">\n  <Icon Name=\"%s\" SourceFile=\"%s\" />\n</Vector>", inputFile.basename().c_str(), inputFile.basename().c_str(), inputFile.name().c_str());
+      if (!wir::File(importFile).writeString(importData))
+      {
+        LogError("Failed to create import file");
+        return false;
+      }
+    }
+  }
+
+  auto importBase = wir::File(importFile).directory().path();
+
+  wir::XMLDocument document;
+  wir::XMLParser parser;
+  if (!parser.loadFromFile(importFile, document))
+  {
+    LogError("Failed to parse xml");
+    return false;
+  }
+
+  auto roots = document.rootElements();
+  if (roots.size() != 1)
+  {
+    LogError("invalid vector spec");
+    return false;
+  }
+
+  auto root = roots[0];
+
+  if (root->name() != "Vector")
+  {
+    LogError("invalid vector spec");
+    return false;
+  }
+
+  std::string outputFile;
+  if (!root->string("OutputFile", outputFile))
+  {
+    LogError("No output file specified");
+    return false;
+  }
+
+  auto outputFilef = wir::File(importBase + "/" + outputFile);
+
+  int64_t size = 64;
+  root->integer("Size", size);
+
+  // Distance range in atlas pixels, the runtime needs it to turn sampled distances into screen space coverage
+  double range = 8.0;
+  root->decimal("Range", range);
+
+  double edgeThreshold = MSDFGEN_DEFAULT_ERROR_CORRECTION_THRESHOLD;
+  root->decimal("EdgeThreshold", edgeThreshold);
+
+  double angleThreshold = 3.0;
+  root->decimal("AngleThreshold", angleThreshold);
+
+  bool overlapSupport = true;
+  root->boolean("Overlap", overlapSupport);
+
+  std::string precision = "double";
+  root->string("Precision", precision);
+  msdfgen::GeneratorPrecision precisioni = msdfgen::PRECISION_DOUBLE;
+  if (wir::strToLower(precision) == "float")
+  {
+    precisioni = msdfgen::PRECISION_FLOAT;
+  }
+  else if (wir::strToLower(precision) != "double")
+  {
+    LogError("Invalid precision, possible options: double, float");
+    return false;
+  }
+
+  if (size <= 0 || range <= 0.0 || range >= double(size))
+  {
+    LogError("Invalid size or range, the range must be positive and smaller than the size");
+    return false;
+  }
+
+  std::vector<VectorIcon> icons;
+  for (auto child : root->children())
+  {
+    if (child->name() != "Icon")
+    {
+      continue;
+    }
+
+    icons.emplace_back();
+    auto &icon = icons.back();
+
+    if (!child->string("Name", icon.name))
+    {
+      LogError("Icon without a name");
+      return false;
+    }
+
+    int64_t iconSize = size;
+    child->integer("Size", iconSize);
+    if (iconSize <= range)
+    {
+      LogError("%s: size must be larger than the range", icon.name.c_str());
+      return false;
+    }
+    icon.size = uint32_t(iconSize);
+
+    std::string source;
+    if (child->string("SourceFile", source))
+    {
+      auto sourceFilef = wir::File(importBase + "/" + source);
+      if (!sourceFilef.exist())
+      {
+        LogError("%s: source file doesn't exist", icon.name.c_str());
+        return false;
+      }
+
+      if (!loadSvgFile(sourceFilef.path(), icon))
+      {
+        return false;
+      }
+    }
+    else if (child->string("Path", source))
+    {
+      if (!msdfgen::buildShapeFromSvgPath(icon.shape, source.c_str()))
+      {
+        LogError("%s: malformed path data", icon.name.c_str());
+        return false;
+      }
+      icon.topDown = true;
+      icon.frame = icon.shape.getBounds();
+    }
+    else if (child->string("Shape", source))
+    {
+      if (!msdfgen::readShapeDescription(source.c_str(), icon.shape))
+      {
+        LogError("%s: malformed shape description", icon.name.c_str());
+        return false;
+      }
+      icon.frame = icon.shape.getBounds();
+    }
+    else
+    {
+      LogError("%s: no SourceFile, Path or Shape specified", icon.name.c_str());
+      return false;
+    }
+
+    std::string viewBox;
+    if (child->string("ViewBox", viewBox) && !parseViewBox(viewBox, icon.frame))
+    {
+      LogError("%s: invalid view box", icon.name.c_str());
+      return false;
+    }
+
+    std::string fillRule;
+    if (child->string("FillRule", fillRule))
+    {
+      if (wir::strToLower(fillRule) == "nonzero")
+      {
+        icon.fillRule = msdfgen::FILL_NONZERO;
+      }
+      else if (wir::strToLower(fillRule) == "evenodd")
+      {
+        icon.fillRule = msdfgen::FILL_ODD;
+      }
+      else
+      {
+        LogError("Invalid fill rule, possible options: nonzero, evenodd");
+        return false;
+      }
+    }
+
+    if (!icon.shape.validate() || icon.shape.contours.empty() || icon.frame.r <= icon.frame.l || icon.frame.t <= icon.frame.b)
+    {
+      LogError("%s: empty or invalid shape", icon.name.c_str());
+      return false;
+    }
+  }
+
+  if (icons.empty())
+  {
+    LogError("No icons specified");
+    return false;
+  }
+
+  LogNotice("Generating %u icons, Size: %" PRId64 ", Range: %f, Precision: %s", uint32_t(icons.size()), size, range, precision.c_str());
+
+  // Icons are independent, so they are generated in parallel, each one on a single thread
+  int64_t iconCount = int64_t(icons.size());
+#ifdef MSDFGEN_USE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int64_t i = 0; i < iconCount; i++)
+  {
+    generateIcon(icons[i], range, edgeThreshold, angleThreshold, overlapSupport, precisioni);
+  }
+
+  glm::uvec2 atlasSize = packIcons(icons);
+  std::vector<uint8_t> data(size_t(atlasSize.x) * atlasSize.y * 4, 0);
+
+  wir::Stream assetData;
+  assetData << uint32_t(icons.size());
+  for (auto const &icon : icons)
+  {
+    // Rows are stored top to bottom, like every other texture
+    for (uint32_t y = 0; y < icon.size; y++)
+    {
+      uint32_t fieldRow = icon.topDown ? y : icon.size - 1 - y;
+      uint8_t *dst = &data[(size_t(icon.position.y + y) * atlasSize.x + icon.position.x) * 4];
+      for (uint32_t x = 0; x < icon.size; x++)
+      {
+        float const *pixel = icon.field(x, fieldRow);
+        for (int c = 0; c < 4; c++)
+        {
+          dst[x * 4 + c] = msdfgen::pixelFloatToByte(pixel[c]);
+        }
+      }
+    }
+
+    glm::vec4 uv;
+    uv.x = float(icon.position.x) / float(atlasSize.x);
+    uv.y = float(icon.position.y) / float(atlasSize.y);
+    uv.z = float(icon.position.x + icon.size) / float(atlasSize.x);
+    uv.w = float(icon.position.y + icon.size) / float(atlasSize.y);
+
+    assetData << icon.name << uv << glm::uvec2(icon.size, icon.size);
+  }
+
+  LogNotice("Packed %u icons into a %ux%u atlas", uint32_t(icons.size()), atlasSize.x, atlasSize.y);
+
+  assetData << atlasSize << float(range);
+  assetData << uint32_t(odin::F_RGBA8_UNORM);
+  assetData.write(data.data(), data.size() * sizeof(uint8_t));
+
+  if (!utils::writeAsset(outputFilef.path(), "kit::VectorAtlas", assetData))
+  {
+    LogError("writeAsset failed: %s", outputFilef.path().c_str());
+    return false;
+  }
+
+  return true;
+}
+
+uint64_t Command_ImportVector::requiredArguments() const
+{
+  return 3; // 2 + inputfile
+}
@@ -0,0 +1,184 @@
+#include "Command_TestSDFAllocations.hpp"
+
+#include "MSDF/msdfgen.h"
+#include "SDFTestShapes.hpp"
+
+#include <WIR/Error.hpp>
+#include <WIR/Math.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifdef MSDFGEN_USE_OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+  // Same glyph-like shape as test_sdf_batch, covering every segment type and an inner contour
+  char const *testShapeDescription = "{ 2,2; 62,2; (70,32; 62,62); 32,62; (16,70; -6,50); 2,32; # } { 16,16; (16,48); 32,50; (48,48; 48,16); # }";
+
+  constexpr int testResolution = 384;
+  constexpr double testRange = 4.0;
+
+  // Edge count of the outer contour of the font-sized test shape, enough to be generated with the edge grid
+  constexpr int wavyEdgeCount = 240;
+
+  /// Runs the operation twice on the same preallocated field, logs the working storage allocations of both runs and returns those of the second
+  template <int N, typename Operation>
+  uint64_t countRepeatedAllocations(std::string const &label, Operation operation)
+  {
+    msdfgen::Bitmap<float, N> field(testResolution, testResolution);
+
+    uint64_t counts[2];
+    for (int run = 0; run < 2; run++)
+    {
+      unsigned long long before = msdfgen::workingStorageAllocationCount();
+      operation(field);
+      counts[run] = msdfgen::workingStorageAllocationCount() - before;
+    }
+
+    LogNotice("%s: %llu allocations on the first run, %llu on the second", label.c_str(), (unsigned long long)counts[0], (unsigned long long)counts[1]);
+
+    return counts[1];
+  }
+
+  /// Counts the allocations of every generator and scanline operation repeated on the shape, returning the total of the repetitions
+  uint64_t countShapeAllocations(msdfgen::Shape const &shape, std::string const &name, msdfgen::Vector2 const &scale, msdfgen::Vector2 const &translate, double range)
+  {
+    uint64_t total = 0;
+    total += countRepeatedAllocations<1>(name + " SDF", [&](msdfgen::Bitmap<float, 1> &field) {
+      msdfgen::generateSDF(field, shape, range, scale, translate);
+    });
+    total += countRepeatedAllocations<1>(name + " PSDF", [&](msdfgen::Bitmap<float, 1> &field) {
+      msdfgen::generatePseudoSDF(field, shape, range, scale, translate);
+    });
+    total += countRepeatedAllocations<3>(name + " MSDF", [&](msdfgen::Bitmap<float, 3> &field) {
+      msdfgen::generateMSDF(field, shape, range, scale, translate);
+    });
+    total += countRepeatedAllocations<4>(name + " MTSDF", [&](msdfgen::Bitmap<float, 4> &field) {
+      msdfgen::generateMTSDF(field, shape, range, scale, translate);
+    });
+    total += countRepeatedAllocations<1>(name + " rasterization", [&](msdfgen::Bitmap<float, 1> &field) {
+      msdfgen::rasterize(field, shape, scale, translate);
+    });
+    total += countRepeatedAllocations<3>(name + " sign correction", [&](msdfgen::Bitmap<float, 3> &field) {
+      msdfgen::distanceSignCorrection(field, shape, scale, translate);
+    });
+    total += countRepeatedAllocations<3>(name + " error estimation", [&](msdfgen::Bitmap<float, 3> &field) {
+      msdfgen::estimateSDFError(field, shape, scale, translate, 4);
+    });
+    return total;
+  }
+
+#ifdef MSDFGEN_USE_OPENMP
+  /// Runs the operation on one thread and on threadCount threads, and returns whether both produced the same field
+  template <int N, typename Operation>
+  bool matchesSingleThreaded(std::string const &label, int threadCount, Operation operation)
+  {
+    msdfgen::Bitmap<float, N> single(testResolution, testResolution);
+    msdfgen::Bitmap<float, N> parallel(testResolution, testResolution);
+
+    omp_set_num_threads(1);
+    operation(single);
+    omp_set_num_threads(threadCount);
+    operation(parallel);
+
+    if (memcmp((float const *)single, (float const *)parallel, sizeof(float) * N * testResolution * testResolution) != 0)
+    {
+      LogError("%s: the field generated on %d threads differs from the single threaded one", label.c_str(), threadCount);
+      return false;
+    }
+
+    return true;
+  }
+
+  /// Compares the generators and sign correction on the shape between one and threadCount threads
+  bool matchShapeThreads(msdfgen::Shape const &shape, std::string const &name, msdfgen::Vector2 const &scale, msdfgen::Vector2 const &translate, double range, int threadCount)
+  {
+    bool match = true;
+    match &= matchesSingleThreaded<1>(name + " SDF", threadCount, [&](msdfgen::Bitmap<float, 1> &field) {
+      msdfgen::generateSDF(field, shape, range, scale, translate);
+    });
+    match &= matchesSingleThreaded<1>(name + " PSDF", threadCount, [&](msdfgen::Bitmap<float, 1> &field) {
+      msdfgen::generatePseudoSDF(field, shape, range, scale, translate);
+    });
+    match &= matchesSingleThreaded<3>(name + " MSDF", threadCount, [&](msdfgen::Bitmap<float, 3> &field) {
+      msdfgen::generateMSDF(field, shape, range, scale, translate);
+    });
+    match &= matchesSingleThreaded<4>(name + " MTSDF", threadCount, [&](msdfgen::Bitmap<float, 4> &field) {
+      msdfgen::generateMTSDF(field, shape, range, scale, translate);
+    });
+    match &= matchesSingleThreaded<3>(name + " sign correction", threadCount, [&](msdfgen::Bitmap<float, 3> &field) {
+      msdfgen::generateMSDF(field, shape, range, scale, translate);
+      msdfgen::distanceSignCorrection(field, shape, scale, translate);
+    });
+    return match;
+  }
+#endif
+} // namespace
+
+Command_TestSDFAllocations::~Command_TestSDFAllocations()
+{
+}
+
+std::string const Command_TestSDFAllocations::name() const
+{
+  return "test_sdf_allocations";
+}
+
+bool Command_TestSDFAllocations::execute(std::vector<std::string> args) const
+{
+  msdfgen::Shape shape;
+  if (!msdfgen::readShapeDescription(testShapeDescription, shape))
+  {
+    LogError("Failed to parse test shape");
+    return false;
+  }
+  shape.normalize();
+  shape.orientContours();
+  msdfgen::edgeColoringSimple(shape, 3.0);
+
+  // The shape overhangs its 0-64 box a little, so the field covers -8 to 72
+  msdfgen::Vector2 const scale(testResolution / 80.0, testResolution / 80.0);
+  msdfgen::Vector2 const translate(8.0, 8.0);
+
+  msdfgen::Shape wavyShape;
+  sdftest::createWavyShape(wavyShape, wavyEdgeCount);
+  msdfgen::Vector2 wavyScale, wavyTranslate;
+  double wavyRange = 0.0;
+  sdftest::frameShape(wavyShape, testResolution, testResolution, testRange, wavyScale, wavyTranslate, wavyRange);
+
+#ifdef MSDFGEN_USE_OPENMP
+  // Every thread keeps its own working storage, so allocations are only counted reliably if the same threads take the same rows
+  int threadCount = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+
+  uint64_t repeatedAllocations = countShapeAllocations(shape, "Glyph", scale, translate, testRange / scale.x);
+  repeatedAllocations += countShapeAllocations(wavyShape, "Wavy " + std::to_string(wavyEdgeCount), wavyScale, wavyTranslate, wavyRange);
+
+  bool success = true;
+  if (repeatedAllocations > 0)
+  {
+    LogError("Repeating a call on the same shape and field made %llu allocations, where its working storage should have been reused", (unsigned long long)repeatedAllocations);
+    success = false;
+  }
+
+#ifdef MSDFGEN_USE_OPENMP
+  // Working storage filled by the calling thread has to reach the threads of the parallel regions, which only show up with
+  // several of them, so at least four are used even where fewer cores are available
+  int parallelThreads = (glm::max)(threadCount, 4);
+  success &= matchShapeThreads(shape, "Glyph", scale, translate, testRange / scale.x, parallelThreads);
+  success &= matchShapeThreads(wavyShape, "Wavy " + std::to_string(wavyEdgeCount), wavyScale, wavyTranslate, wavyRange, parallelThreads);
+  omp_set_num_threads(threadCount);
+#endif
+
+  return success;
+}
+
+uint64_t Command_TestSDFAllocations::requiredArguments() const
+{
+  return 2;
+}
@@ -0,0 +1,131 @@
+#include "Command_TestSDFBatch.hpp"
+
+#include "MSDF/msdfgen.h"
+#include "MSDF/core/ShapeDistanceFinder.h"
+
+#include <WIR/Error.hpp>
+#include <WIR/Math.hpp>
+
+#include <chrono>
+
+namespace
+{
+  // A glyph-like test shape covering every segment type, with an inner contour so the combiners have some work to do
+  char const *testShapeDescription = "{ 2,2; 62,2; (70,32; 62,62); 32,62; (16,70; -6,50); 2,32; # } { 16,16; (16,48); 32,50; (48,48; 48,16); # }";
+
+  constexpr int testResolution = 384;
+
+  double distanceError(double a, double b)
+  {
+    return glm::abs(a - b);
+  }
+
+  double distanceError(msdfgen::MultiDistance const &a, msdfgen::MultiDistance const &b)
+  {
+    return (glm::max)(glm::abs(a.r - b.r), (glm::max)(glm::abs(a.g - b.g), glm::abs(a.b - b.b)));
+  }
+
+  /// Samples the shape over a grid with both the scalar and the batched distance finder, logs the timings and returns the largest difference
+  template <class ContourCombiner>
+  double compareFinders(msdfgen::Shape const &shape, char const *label)
+  {
+    typedef typename ContourCombiner::DistanceType DistanceType;
+
+    msdfgen::Vector2 scale(testResolution / 64.0, testResolution / 64.0);
+    std::vector<DistanceType> scalarDistances(testResolution * testResolution);
+    std::vector<DistanceType> batchDistances(testResolution * testResolution);
+
+    auto scalarStart = std::chrono::high_resolution_clock::now();
+    {
+      msdfgen::ShapeDistanceFinder<ContourCombiner> finder(shape);
+      for (int y = 0; y < testResolution; y++)
+      {
+        for (int x = 0; x < testResolution; x++)
+        {
+          scalarDistances[y * testResolution + x] = finder.distance(msdfgen::Point2((x + .5) / scale.x, (y + .5) / scale.y));
+        }
+      }
+    }
+    auto scalarEnd = std::chrono::high_resolution_clock::now();
+
+    // Same strip layout as generateDistanceField, testResolution is a multiple of the batch size
+    int stripWidth = testResolution / MSDFGEN_BATCH_SIZE;
+    auto batchStart = std::chrono::high_resolution_clock::now();
+    {
+      msdfgen::PreparedShape preparedShape(shape);
+      msdfgen::BatchShapeDistanceFinder<ContourCombiner> finder(preparedShape);
+      msdfgen::Point2 points[MSDFGEN_BATCH_SIZE];
+      DistanceType distances[MSDFGEN_BATCH_SIZE];
+      for (int y = 0; y < testResolution; y++)
+      {
+        for (int x = 0; x < stripWidth; x++)
+        {
+          for (int lane = 0; lane < MSDFGEN_BATCH_SIZE; lane++)
+          {
+            points[lane] = msdfgen::Point2((lane * stripWidth + x + .5) / scale.x, (y + .5) / scale.y);
+          }
+
+          finder.distance(distances, points);
+
+          for (int lane = 0; lane < MSDFGEN_BATCH_SIZE; lane++)
+          {
+            batchDistances[y * testResolution + lane * stripWidth + x] = distances[lane];
+          }
+        }
+      }
+    }
+    auto batchEnd = std::chrono::high_resolution_clock::now();
+
+    double maxError = 0.0;
+    for (size_t i = 0; i < scalarDistances.size(); i++)
+    {
+      maxError = (glm::max)(maxError, distanceError(scalarDistances[i], batchDistances[i]));
+    }
+
+    double scalarMs = std::chrono::duration<double, std::milli>(scalarEnd - scalarStart).count();
+    double batchMs = std::chrono::duration<double, std::milli>(batchEnd - batchStart).count();
+    LogNotice("%s: scalar %.2f ms, batched %.2f ms (%.2fx), max error %g", label, scalarMs, batchMs, scalarMs / batchMs, maxError);
+
+    return maxError;
+  }
+} // namespace
+
+Command_TestSDFBatch::~Command_TestSDFBatch()
+{
+}
+
+std::string const Command_TestSDFBatch::name() const
+{
+  return "test_sdf_batch";
+}
+
+bool Command_TestSDFBatch::execute(std::vector<std::string> args) const
+{
+  msdfgen::Shape shape;
+  if (!msdfgen::readShapeDescription(testShapeDescription, shape))
+  {
+    LogError("Failed to parse test shape");
+    return false;
+  }
+  shape.normalize();
+  msdfgen::edgeColoringSimple(shape, 3.0);
+
+  // The batched kernels replicate the scalar arithmetic exactly, so any difference at all is a bug
+  double maxError = 0.0;
+  maxError = (glm::max)(maxError, compareFinders<msdfgen::SimpleContourCombiner<msdfgen::TrueDistanceSelector>>(shape, "True distance"));
+  maxError = (glm::max)(maxError, compareFinders<msdfgen::OverlappingContourCombiner<msdfgen::PseudoDistanceSelector>>(shape, "Pseudo distance"));
+  maxError = (glm::max)(maxError, compareFinders<msdfgen::OverlappingContourCombiner<msdfgen::MultiDistanceSelector>>(shape, "Multi distance"));
+
+  if (maxError != 0.0)
+  {
+    LogError("Batched distances differ from the scalar path");
+    return false;
+  }
+
+  return true;
+}
+
+uint64_t Command_TestSDFBatch::requiredArguments() const
+{
+  return 2;
+}
@@ -0,0 +1,157 @@
+#include "Command_TestSDFGrid.hpp"
+
+#include "MSDF/msdfgen.h"
+#include "MSDF/core/ShapeDistanceFinder.h"
+#include "MSDF/core/ShapeEdgeGrid.h"
+#include "SDFTestShapes.hpp"
+
+#include <WIR/Error.hpp>
+#include <WIR/Math.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+  constexpr int testResolution = 256;
+  constexpr double testRange = 4.0;
+
+  // Edge counts of the outer contours of the font-sized test shapes, up to one with far more edges than a glyph
+  constexpr int wavyEdgeCounts[] = {97, 240, 2000};
+
+  /// Samples the whole field with the distance finder, visiting the pixels in the blocks and strips of generateDistanceField
+  template <class ContourCombiner, typename Precision>
+  void sampleField(msdfgen::BatchShapeDistanceFinder<ContourCombiner, Precision> &finder, msdfgen::Vector2 const &scale, msdfgen::Vector2 const &translate, std::vector<typename ContourCombiner::DistanceType> &outDistances)
+  {
+    // Block size of generateDistanceField, which testResolution is a multiple of
+    constexpr int blockSize = 16;
+    constexpr int stripWidth = blockSize / MSDFGEN_BATCH_SIZE;
+    int blockCount = testResolution / blockSize;
+
+    outDistances.resize(testResolution * testResolution);
+    msdfgen::Point2 points[MSDFGEN_BATCH_SIZE];
+    typename ContourCombiner::DistanceType distances[MSDFGEN_BATCH_SIZE];
+    for (int block = 0; block < blockCount * blockCount; block++)
+    {
+      int blockX = block % blockCount * blockSize;
+      int blockY = block / blockCount * blockSize;
+      finder.reset();
+      for (int y = blockY; y < blockY + blockSize; y++)
+      {
+        for (int x = 0; x < stripWidth; x++)
+        {
+          for (int lane = 0; lane < MSDFGEN_BATCH_SIZE; lane++)
+          {
+            points[lane] = msdfgen::Point2((blockX + lane * stripWidth + x + .5) / scale.x - translate.x, (y + .5) / scale.y - translate.y);
+          }
+
+          finder.distance(distances, points);
+
+          for (int lane = 0; lane < MSDFGEN_BATCH_SIZE; lane++)
+          {
+            outDistances[y * testResolution + blockX + lane * stripWidth + x] = distances[lane];
+          }
+        }
+      }
+    }
+  }
+
+  /// Samples the shape with and without an edge grid, logs the timings and returns the number of distances that differ in any bit
+  template <class ContourCombiner, typename Precision>
+  int compareGrid(msdfgen::PreparedShape const &preparedShape, msdfgen::ShapeEdgeGrid const &edgeGrid, msdfgen::Vector2 const &scale, msdfgen::Vector2 const &translate, std::string const &label)
+  {
+    typedef typename ContourCombiner::DistanceType DistanceType;
+    std::vector<DistanceType> fullDistances, gridDistances;
+
+    auto fullStart = std::chrono::high_resolution_clock::now();
+    {
+      msdfgen::BatchShapeDistanceFinder<ContourCombiner, Precision> finder(preparedShape);
+      sampleField(finder, scale, translate, fullDistances);
+    }
+    auto fullEnd = std::chrono::high_resolution_clock::now();
+
+    auto gridStart = std::chrono::high_resolution_clock::now();
+    {
+      msdfgen::BatchShapeDistanceFinder<ContourCombiner, Precision> finder(preparedShape, &edgeGrid);
+      sampleField(finder, scale, translate, gridDistances);
+    }
+    auto gridEnd = std::chrono::high_resolution_clock::now();
+
+    int mismatches = 0;
+    for (size_t i = 0; i < fullDistances.size(); i++)
+    {
+      mismatches += memcmp(&fullDistances[i], &gridDistances[i], sizeof(DistanceType)) != 0 ? 1 : 0;
+    }
+
+    double fullMs = std::chrono::duration<double, std::milli>(fullEnd - fullStart).count();
+    double gridMs = std::chrono::duration<double, std::milli>(gridEnd - gridStart).count();
+    LogNotice("%s: all edges %.2f ms, grid %.2f ms (%.2fx), %d mismatches", label.c_str(), fullMs, gridMs, fullMs / gridMs, mismatches);
+
+    return mismatches;
+  }
+
+  /// Compares every selector with the combiner, in both precisions, against a grid built for it
+  template <template <typename> class ContourCombiner>
+  int compareSelectors(msdfgen::PreparedShape const &preparedShape, msdfgen::Vector2 const &scale, msdfgen::Vector2 const &translate, bool overlapSupport, std::string const &name)
+  {
+    // Laid out over the field like the grid of generateDistanceField
+    int columns = testResolution / MSDFGEN_EDGE_GRID_CELL_SIZE;
+    msdfgen::Vector2 cellSize(MSDFGEN_EDGE_GRID_CELL_SIZE / scale.x, MSDFGEN_EDGE_GRID_CELL_SIZE / scale.y);
+    auto buildStart = std::chrono::high_resolution_clock::now();
+    msdfgen::ShapeEdgeGrid edgeGrid(preparedShape, msdfgen::Point2(-translate.x, -translate.y), cellSize, columns, columns, overlapSupport);
+    auto buildEnd = std::chrono::high_resolution_clock::now();
+    LogNotice("%s: built a %dx%d edge grid in %.2f ms", name.c_str(), columns, columns, std::chrono::duration<double, std::milli>(buildEnd - buildStart).count());
+
+    int mismatches = 0;
+    mismatches += compareGrid<ContourCombiner<msdfgen::TrueDistanceSelector>, double>(preparedShape, edgeGrid, scale, translate, name + " true distance");
+    mismatches += compareGrid<ContourCombiner<msdfgen::PseudoDistanceSelector>, double>(preparedShape, edgeGrid, scale, translate, name + " pseudo distance");
+    mismatches += compareGrid<ContourCombiner<msdfgen::MultiDistanceSelector>, double>(preparedShape, edgeGrid, scale, translate, name + " multi distance");
+    mismatches += compareGrid<ContourCombiner<msdfgen::MultiAndTrueDistanceSelector>, double>(preparedShape, edgeGrid, scale, translate, name + " multi and true distance");
+    mismatches += compareGrid<ContourCombiner<msdfgen::TrueDistanceSelector>, float>(preparedShape, edgeGrid, scale, translate, name + " true distance, float");
+    mismatches += compareGrid<ContourCombiner<msdfgen::MultiDistanceSelector>, float>(preparedShape, edgeGrid, scale, translate, name + " multi distance, float");
+    return mismatches;
+  }
+} // namespace
+
+Command_TestSDFGrid::~Command_TestSDFGrid()
+{
+}
+
+std::string const Command_TestSDFGrid::name() const
+{
+  return "test_sdf_grid";
+}
+
+bool Command_TestSDFGrid::execute(std::vector<std::string> args) const
+{
+  // The grid may only leave out edges that cannot change a distance, so any difference at all is a bug
+  int mismatches = 0;
+  for (int edgeCount : wavyEdgeCounts)
+  {
+    msdfgen::Shape shape;
+    sdftest::createWavyShape(shape, edgeCount);
+    msdfgen::Vector2 scale, translate;
+    double range = 0.0;
+    sdftest::frameShape(shape, testResolution, testResolution, testRange, scale, translate, range);
+
+    msdfgen::PreparedShape preparedShape(shape);
+    std::string name = "Wavy " + std::to_string(edgeCount);
+    mismatches += compareSelectors<msdfgen::SimpleContourCombiner>(preparedShape, scale, translate, false, name);
+    mismatches += compareSelectors<msdfgen::OverlappingContourCombiner>(preparedShape, scale, translate, true, name + " overlapping");
+  }
+
+  if (mismatches > 0)
+  {
+    LogError("%d distances found with the edge grid differ from those found with all edges", mismatches);
+    return false;
+  }
+
+  return true;
+}
+
+uint64_t Command_TestSDFGrid::requiredArguments() const
+{
+  return 2;
+}
@@ -0,0 +1,186 @@
+#include "Command_TestSDFPrecision.hpp"
+
+#include "MSDF/msdfgen.h"
+#include "SDFTestShapes.hpp"
+
+#include <WIR/Error.hpp>
+#include <WIR/Math.hpp>
+
+#include <chrono>
+#include <string>
+
+namespace
+{
+  // Same glyph-like shape as test_sdf_batch, covering every segment type and an inner contour
+  char const *testShapeDescription = "{ 2,2; 62,2; (70,32; 62,62); 32,62; (16,70; -6,50); 2,32; # } { 16,16; (16,48); 32,50; (48,48; 48,16); # }";
+
+  constexpr int testResolution = 384;
+  constexpr double testRange = 4.0;
+
+  // The shape overhangs its 0-64 box a little, so the field covers -8 to 72
+  msdfgen::Vector2 const testScale(testResolution / 80.0, testResolution / 80.0);
+  msdfgen::Vector2 const testTranslate(8.0, 8.0);
+
+  // Largest tolerated increase of the estimated misfilled area fraction when switching to single precision
+  constexpr double maxErrorIncrease = 1e-4;
+
+  // Edge counts of the outer contours of the font-sized test shapes
+  constexpr int wavyEdgeCounts[] = {97, 240};
+
+  /// Whether a pixel of an N channel field lies inside the shape, going by the median of its color channels or by the true distance an MTSDF keeps in its last
+  template <int N>
+  bool insideShape(float const *pixel, bool trueDistance)
+  {
+    if (N == 1 || trueDistance)
+    {
+      return pixel[N - 1] > 0.5f;
+    }
+    return msdfgen::median(pixel[0], pixel[1], pixel[2]) > 0.5f;
+  }
+
+  struct PrecisionComparison
+  {
+    double errorIncrease = 0.0;
+
+    /// Pixels that single precision puts on the other side of the outline than double
+    int signFlips = 0;
+  };
+
+  /// Generates the field in both precisions with the given generator, logs timings, pixel differences, sign flips and both error estimates
+  template <int N, typename Generator>
+  PrecisionComparison comparePrecisions(msdfgen::Shape const &shape, std::string const &label, msdfgen::Vector2 const &scale, msdfgen::Vector2 const &translate, Generator generate)
+  {
+    msdfgen::Bitmap<float, N> doubleField(testResolution, testResolution);
+    msdfgen::Bitmap<float, N> floatField(testResolution, testResolution);
+
+    auto doubleStart = std::chrono::high_resolution_clock::now();
+    generate(doubleField, msdfgen::PRECISION_DOUBLE);
+    auto doubleEnd = std::chrono::high_resolution_clock::now();
+
+    auto floatStart = std::chrono::high_resolution_clock::now();
+    generate(floatField, msdfgen::PRECISION_FLOAT);
+    auto floatEnd = std::chrono::high_resolution_clock::now();
+
+    double maxDelta = 0.0;
+    int quantizedDifferences = 0;
+    float const *doublePixels = doubleField(0, 0);
+    float const *floatPixels = floatField(0, 0);
+    for (int i = 0; i < N * testResolution * testResolution; i++)
+    {
+      maxDelta = (glm::max)(maxDelta, double(glm::abs(doublePixels[i] - floatPixels[i])));
+      if (msdfgen::pixelFloatToByte(doublePixels[i]) != msdfgen::pixelFloatToByte(floatPixels[i]))
+      {
+        quantizedDifferences++;
+      }
+    }
+
+    PrecisionComparison comparison;
+    for (int i = 0; i < testResolution * testResolution; i++)
+    {
+      for (int trueDistance = 0; trueDistance < (N == 4 ? 2 : 1); trueDistance++)
+      {
+        if (insideShape<N>(doublePixels + N * i, trueDistance != 0) != insideShape<N>(floatPixels + N * i, trueDistance != 0))
+        {
+          comparison.signFlips++;
+        }
+      }
+    }
+
+    double doubleError = msdfgen::estimateSDFError(doubleField, shape, scale, translate, 4);
+    double floatError = msdfgen::estimateSDFError(floatField, shape, scale, translate, 4);
+    comparison.errorIncrease = floatError - doubleError;
+
+    double doubleMs = std::chrono::duration<double, std::milli>(doubleEnd - doubleStart).count();
+    double floatMs = std::chrono::duration<double, std::milli>(floatEnd - floatStart).count();
+    LogNotice("%s: double %.2f ms, float %.2f ms (%.2fx), max pixel delta %g, %d differing 8-bit values, %d sign flips, error estimate %g -> %g (%+g)", label.c_str(), doubleMs, floatMs, doubleMs / floatMs, maxDelta, quantizedDifferences, comparison.signFlips, doubleError, floatError, comparison.errorIncrease);
+
+    return comparison;
+  }
+
+  /// Compares every generator on the shape, returning the largest increase of the error estimate and the total of sign flips
+  PrecisionComparison compareGenerators(msdfgen::Shape const &shape, std::string const &name, msdfgen::Vector2 const &scale, msdfgen::Vector2 const &translate, double range)
+  {
+    PrecisionComparison comparisons[4];
+    comparisons[0] = comparePrecisions<1>(shape, name + " SDF", scale, translate, [&](msdfgen::Bitmap<float, 1> &field, msdfgen::GeneratorPrecision precision) {
+      msdfgen::generateSDF(field, shape, range, scale, translate, true, precision);
+    });
+    comparisons[1] = comparePrecisions<1>(shape, name + " PSDF", scale, translate, [&](msdfgen::Bitmap<float, 1> &field, msdfgen::GeneratorPrecision precision) {
+      msdfgen::generatePseudoSDF(field, shape, range, scale, translate, true, precision);
+    });
+    comparisons[2] = comparePrecisions<3>(shape, name + " MSDF", scale, translate, [&](msdfgen::Bitmap<float, 3> &field, msdfgen::GeneratorPrecision precision) {
+      msdfgen::generateMSDF(field, shape, range, scale, translate, MSDFGEN_DEFAULT_ERROR_CORRECTION_THRESHOLD, true, precision);
+    });
+    comparisons[3] = comparePrecisions<4>(shape, name + " MTSDF", scale, translate, [&](msdfgen::Bitmap<float, 4> &field, msdfgen::GeneratorPrecision precision) {
+      msdfgen::generateMTSDF(field, shape, range, scale, translate, MSDFGEN_DEFAULT_ERROR_CORRECTION_THRESHOLD, true, precision);
+    });
+
+    PrecisionComparison total;
+    for (auto const &comparison : comparisons)
+    {
+      total.errorIncrease = (glm::max)(total.errorIncrease, comparison.errorIncrease);
+      total.signFlips += comparison.signFlips;
+    }
+    return total;
+  }
+} // namespace
+
+Command_TestSDFPrecision::~Command_TestSDFPrecision()
+{
+}
+
+std::string const Command_TestSDFPrecision::name() const
+{
+  return "test_sdf_precision";
+}
+
+bool Command_TestSDFPrecision::execute(std::vector<std::string> args) const
+{
+  msdfgen::Shape shape;
+  if (!msdfgen::readShapeDescription(testShapeDescription, shape))
+  {
+    LogError("Failed to parse test shape");
+    return false;
+  }
+  shape.normalize();
+  // The error estimate compares against the filled shape, so the contours need the winding the generators expect
+  shape.orientContours();
+  msdfgen::edgeColoringSimple(shape, 3.0);
+
+  PrecisionComparison glyph = compareGenerators(shape, "Glyph", testScale, testTranslate, testRange / testScale.x);
+  double errorIncrease = glyph.errorIncrease;
+
+  // Float rounding must never break the exact ties at shared vertices, which decide the sign of the distance
+  int signFlips = glyph.signFlips;
+  for (int edgeCount : wavyEdgeCounts)
+  {
+    msdfgen::Shape wavyShape;
+    sdftest::createWavyShape(wavyShape, edgeCount);
+
+    msdfgen::Vector2 scale, translate;
+    double range = 0.0;
+    sdftest::frameShape(wavyShape, testResolution, testResolution, testRange, scale, translate, range);
+
+    PrecisionComparison wavy = compareGenerators(wavyShape, "Wavy " + std::to_string(edgeCount), scale, translate, range);
+    errorIncrease = (glm::max)(errorIncrease, wavy.errorIncrease);
+    signFlips += wavy.signFlips;
+  }
+
+  if (errorIncrease > maxErrorIncrease)
+  {
+    LogError("Single precision raises the estimated error by %g, more than the tolerated %g", errorIncrease, maxErrorIncrease);
+    return false;
+  }
+
+  if (signFlips > 0)
+  {
+    LogError("Single precision puts %d pixels on the other side of the outline than double precision", signFlips);
+    return false;
+  }
+
+  return true;
+}
+
+uint64_t Command_TestSDFPrecision::requiredArguments() const
+{
+  return 2;
+}
@@ -0,0 +1,214 @@
+#include "Command_TestSDFTiles.hpp"
+
+#include "MSDF/msdfgen.h"
+#include "SDFTestShapes.hpp"
+
+#include <WIR/Error.hpp>
+#include <WIR/Math.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+
+namespace
+{
+  // Same glyph-like shape as test_sdf_batch, covering every segment type and an inner contour
+  char const *testShapeDescription = "{ 2,2; 62,2; (70,32; 62,62); 32,62; (16,70; -6,50); 2,32; # } { 16,16; (16,48); 32,50; (48,48; 48,16); # }";
+
+  // Deliberately not a multiple of any of the tile sizes, so the last row and column of tiles are partial
+  constexpr int testWidth = 420;
+  constexpr int testHeight = 300;
+  constexpr double testRange = 4.0;
+
+  // Tile sizes that do not divide the output, including some that are smaller than the halo around them
+  constexpr int testTileSizes[] = {17, 23, 40, 64};
+
+  // Edge counts of the outer contours of the font-sized test shapes
+  constexpr int wavyEdgeCounts[] = {97, 240};
+
+  /// Assembles the tiles into a whole 8-bit bitmap, and checks that every pixel is written exactly once
+  template <int N>
+  class AssemblingTileWriter : public msdfgen::BitmapTileWriter<N>
+  {
+  public:
+    AssemblingTileWriter(int width, int height)
+        : pixels(N * width * height)
+        , written(width * height)
+        , width(width)
+        , height(height)
+    {
+    }
+
+    virtual bool writeTile(int x, int y, msdfgen::BitmapConstRef<msdfgen::byte, N> const &tile) override
+    {
+      if (x < 0 || y < 0 || x + tile.width > width || y + tile.height > height)
+      {
+        LogError("Tile at %d, %d of %dx%d lies outside the output", x, y, tile.width, tile.height);
+        return false;
+      }
+
+      for (int row = 0; row < tile.height; row++)
+      {
+        memcpy(&pixels[N * ((y + row) * width + x)], tile(0, row), N * tile.width);
+        for (int column = 0; column < tile.width; column++)
+        {
+          written[(y + row) * width + x + column]++;
+        }
+      }
+
+      return true;
+    }
+
+    std::vector<msdfgen::byte> pixels;
+    std::vector<int> written;
+    int width;
+    int height;
+  };
+
+  /// Generates the field whole and in tiles with the given generators, logs timings and peak float memory, and returns the number of differing 8-bit values
+  template <int N, typename WholeGenerator, typename TiledGenerator>
+  int compareTiles(std::string const &label, int tileSize, WholeGenerator generateWhole, TiledGenerator generateTiled)
+  {
+    auto wholeStart = std::chrono::high_resolution_clock::now();
+    msdfgen::Bitmap<float, N> whole(testWidth, testHeight);
+    generateWhole(whole);
+    auto wholeEnd = std::chrono::high_resolution_clock::now();
+
+    AssemblingTileWriter<N> writer(testWidth, testHeight);
+    auto tiledStart = std::chrono::high_resolution_clock::now();
+    if (!generateTiled(writer))
+    {
+      LogError("%s: tiled generation was aborted", label.c_str());
+      return -1;
+    }
+    auto tiledEnd = std::chrono::high_resolution_clock::now();
+
+    for (int written : writer.written)
+    {
+      if (written != 1)
+      {
+        LogError("%s: tiles do not cover the output exactly once", label.c_str());
+        return -1;
+      }
+    }
+
+    int differences = 0;
+    float const *wholePixels = whole(0, 0);
+    for (size_t i = 0; i < writer.pixels.size(); i++)
+    {
+      if (msdfgen::pixelFloatToByte(wholePixels[i]) != writer.pixels[i])
+      {
+        differences++;
+      }
+    }
+
+    size_t wholeBytes = sizeof(float) * N * testWidth * testHeight;
+    // Only the corrected multi-channel tiles are generated with a halo of four pixels
+    int halo = N == 1 ? 0 : 8;
+    size_t tileBytes = sizeof(float) * N * (tileSize + halo) * (tileSize + halo);
+    double wholeMs = std::chrono::duration<double, std::milli>(wholeEnd - wholeStart).count();
+    double tiledMs = std::chrono::duration<double, std::milli>(tiledEnd - tiledStart).count();
+    LogNotice("%s, %d px tiles: whole %.2f ms (%zu float bytes), tiled %.2f ms (%zu float bytes), %d differing 8-bit values", label.c_str(), tileSize, wholeMs, wholeBytes, tiledMs, tileBytes, differences);
+
+    return differences;
+  }
+
+  /// Compares whole and tiled generation of the shape by every generator, with both Y axis orientations and every tile size, and returns the most differing 8-bit values or -1 on failure
+  int compareShape(msdfgen::Shape &shape, std::string const &name, msdfgen::Vector2 const &scale, msdfgen::Vector2 const &translate, double range)
+  {
+    int maxDifferences = 0;
+    for (int inverseYAxis = 0; inverseYAxis < 2; inverseYAxis++)
+    {
+      shape.inverseYAxis = inverseYAxis != 0;
+      std::string label = name + (shape.inverseYAxis ? ", inverted Y" : "");
+
+      for (int tileSize : testTileSizes)
+      {
+        int differences[3];
+        differences[0] = compareTiles<1>(
+            label + " SDF", tileSize, [&](msdfgen::Bitmap<float, 1> &output) { msdfgen::generateSDF(output, shape, range, scale, translate); },
+            [&](msdfgen::BitmapTileWriter<1> &writer) { return msdfgen::generateSDFTiled(writer, testWidth, testHeight, tileSize, shape, range, scale, translate); });
+        differences[1] = compareTiles<3>(
+            label + " MSDF", tileSize, [&](msdfgen::Bitmap<float, 3> &output) { msdfgen::generateMSDF(output, shape, range, scale, translate); },
+            [&](msdfgen::BitmapTileWriter<3> &writer) { return msdfgen::generateMSDFTiled(writer, testWidth, testHeight, tileSize, shape, range, scale, translate); });
+        differences[2] = compareTiles<4>(
+            label + " MTSDF", tileSize, [&](msdfgen::Bitmap<float, 4> &output) { msdfgen::generateMTSDF(output, shape, range, scale, translate); },
+            [&](msdfgen::BitmapTileWriter<4> &writer) { return msdfgen::generateMTSDFTiled(writer, testWidth, testHeight, tileSize, shape, range, scale, translate); });
+
+        for (int i = 0; i < 3; i++)
+        {
+          if (differences[i] < 0)
+          {
+            return -1;
+          }
+          maxDifferences = (glm::max)(maxDifferences, differences[i]);
+        }
+      }
+    }
+    return maxDifferences;
+  }
+} // namespace
+
+Command_TestSDFTiles::~Command_TestSDFTiles()
+{
+}
+
+std::string const Command_TestSDFTiles::name() const
+{
+  return "test_sdf_tiles";
+}
+
+bool Command_TestSDFTiles::execute(std::vector<std::string> args) const
+{
+  msdfgen::Shape shape;
+  if (!msdfgen::readShapeDescription(testShapeDescription, shape))
+  {
+    LogError("Failed to parse test shape");
+    return false;
+  }
+  shape.normalize();
+  shape.orientContours();
+  msdfgen::edgeColoringSimple(shape, 3.0);
+
+  msdfgen::Vector2 scale(testWidth / 80.0, testHeight / 80.0);
+  msdfgen::Vector2 translate(8.0, 8.0);
+  double range = testRange / scale.x;
+
+  int maxDifferences = compareShape(shape, "Glyph", scale, translate, range);
+
+  // Shapes with many edges are generated with the edge grid, whose cells must line up with the same pixels in every tile
+  for (int edgeCount : wavyEdgeCounts)
+  {
+    msdfgen::Shape wavyShape;
+    sdftest::createWavyShape(wavyShape, edgeCount);
+
+    msdfgen::Vector2 wavyScale, wavyTranslate;
+    double wavyRange = 0.0;
+    sdftest::frameShape(wavyShape, testWidth, testHeight, testRange, wavyScale, wavyTranslate, wavyRange);
+
+    int differences = compareShape(wavyShape, "Wavy " + std::to_string(edgeCount), wavyScale, wavyTranslate, wavyRange);
+    if (differences < 0)
+    {
+      return false;
+    }
+    maxDifferences = (glm::max)(maxDifferences, differences);
+  }
+
+  if (maxDifferences < 0)
+  {
+    return false;
+  }
+
+  if (maxDifferences > 0)
+  {
+    LogError("Tiled generation differs from whole generation");
+    return false;
+  }
+
+  return true;
+}
+
+uint64_t Command_TestSDFTiles::requiredArguments() const
+{
+  return 2;
+}
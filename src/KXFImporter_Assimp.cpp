@@ -1,5 +1,7 @@
 
 #include "KXFImporter_Assimp.hpp"
+#include "MeshSkinning.hpp"
+
 #include <KIT/KXF/KXFAnimation.hpp>
 #include <KIT/KXF/KXFDocument.hpp>
 #include <KIT/KXF/KXFMesh.hpp>
@@ -13,8 +15,10 @@
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 glm::mat4 glmMat4(const aiMatrix4x4 &from)
@@ -144,6 +148,164 @@ void blenderToKxf(glm::mat4 &mat)
   mat = t * r * s;
 }
 
+/**
+ * Adds every node below and including node by name. A name found again later in the depth first walk doesn't replace the first,
+ * like with aiNode::FindNode.
+ */
+void indexNodes(aiNode *node, std::unordered_map<std::string, aiNode *> &nodeIndex)
+{
+  std::vector<aiNode *> stack = {node};
+  while (!stack.empty())
+  {
+    aiNode *current = stack.back();
+    stack.pop_back();
+    nodeIndex.emplace(current->mName.C_Str(), current);
+
+    // Reversed, so children come off the stack in order
+    for (unsigned int child = current->mNumChildren; child > 0; child--)
+    {
+      stack.push_back(current->mChildren[child - 1]);
+    }
+  }
+}
+
+/**
+ * Copies a UV channel into the vertices, flipping V. The member is a template argument rather than a runtime member pointer so
+ * the loop sees a constant offset, which the vectorizer needs.
+ */
+template <glm::vec4 KXF::Vertex::*Member>
+void copyTexCoords(KXF::Vertex *output, aiVector3D const *texCoords, int64_t vertexCount)
+{
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+  for (int64_t i = 0; i < vertexCount; i++)
+  {
+    (output[i].*Member).x = texCoords[i].x;
+    (output[i].*Member).y = 1.0f - texCoords[i].y;
+  }
+}
+
+/**
+ * Converts the vertices and faces of an assimp mesh, one attribute at a time over the arrays assimp stores them in, with the
+ * axis swizzle of blenderToKxf folded into each loop. Attributes the mesh lacks keep the converted defaults of KXF::Vertex.
+ */
+KXF::Submesh *convertSubmesh(aiMesh const *mesh)
+{
+  KXF::Submesh *submesh = new KXF::Submesh();
+  int64_t const vertexCount = int64_t(mesh->mNumVertices);
+
+  submesh->vertexFlags = KXF::VF_None;
+  KXF::VertexFlags const texCoordFlags[4] = {KXF::VF_TexCoords1, KXF::VF_TexCoords2, KXF::VF_TexCoords3, KXF::VF_TexCoords4};
+  for (uint32_t k = 0; k < 4; k++)
+  {
+    if (mesh->mTextureCoords[k] != nullptr)
+      submesh->vertexFlags = KXF::VertexFlags(submesh->vertexFlags | texCoordFlags[k]);
+  }
+  if (mesh->mNormals != nullptr)
+    submesh->vertexFlags = KXF::VertexFlags(submesh->vertexFlags | KXF::VF_Normal);
+  if (mesh->mTangents != nullptr)
+    submesh->vertexFlags = KXF::VertexFlags(submesh->vertexFlags | KXF::VF_Tangent);
+
+  KXF::Vertex defaultVertex;
+  defaultVertex.position.w = 1.0f;
+  blenderToKxf(defaultVertex);
+
+  auto &vertices = submesh->vertices;
+  vertices.assign(size_t(vertexCount), defaultVertex);
+  KXF::Vertex *output = vertices.data();
+
+  // (x, y, z) becomes (x, -z, y)
+  aiVector3D const *positions = mesh->mVertices;
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+  for (int64_t i = 0; i < vertexCount; i++)
+  {
+    output[i].position.x = positions[i].x;
+    output[i].position.y = -positions[i].z;
+    output[i].position.z = positions[i].y;
+  }
+
+  // Normals are flipped as well
+  if (mesh->mNormals != nullptr)
+  {
+    aiVector3D const *normals = mesh->mNormals;
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+    for (int64_t i = 0; i < vertexCount; i++)
+    {
+      output[i].normal.x = -normals[i].x;
+      output[i].normal.y = normals[i].z;
+      output[i].normal.z = -normals[i].y;
+    }
+  }
+
+  if (mesh->mTangents != nullptr)
+  {
+    aiVector3D const *tangents = mesh->mTangents;
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+    for (int64_t i = 0; i < vertexCount; i++)
+    {
+      output[i].tangent.x = tangents[i].x;
+      output[i].tangent.y = -tangents[i].z;
+      output[i].tangent.z = tangents[i].y;
+    }
+  }
+
+  // V is flipped
+  for (uint32_t k = 0; k < 4; k++)
+  {
+    aiVector3D const *texCoords = mesh->mTextureCoords[k];
+    if (texCoords == nullptr)
+    {
+      continue;
+    }
+
+    switch (k)
+    {
+    case 0:
+      copyTexCoords<&KXF::Vertex::texCoords1>(output, texCoords, vertexCount);
+      break;
+    case 1:
+      copyTexCoords<&KXF::Vertex::texCoords2>(output, texCoords, vertexCount);
+      break;
+    case 2:
+      copyTexCoords<&KXF::Vertex::texCoords3>(output, texCoords, vertexCount);
+      break;
+    default:
+      copyTexCoords<&KXF::Vertex::texCoords4>(output, texCoords, vertexCount);
+      break;
+    }
+  }
+
+  // Only triangles are kept, so they are counted first to size the indices exactly
+  size_t triangleCount = 0;
+  for (unsigned int currTriangle = 0; currTriangle < mesh->mNumFaces; currTriangle++)
+  {
+    triangleCount += mesh->mFaces[currTriangle].mNumIndices == 3 ? 1 : 0;
+  }
+
+  submesh->indices.resize(triangleCount * 3);
+  uint32_t *indices = submesh->indices.data();
+  for (unsigned int currTriangle = 0; currTriangle < mesh->mNumFaces; currTriangle++)
+  {
+    aiFace const &face = mesh->mFaces[currTriangle];
+    if (face.mNumIndices == 3)
+    {
+      indices[0] = face.mIndices[0];
+      indices[1] = face.mIndices[1];
+      indices[2] = face.mIndices[2];
+      indices += 3;
+    }
+  }
+
+  return submesh;
+}
+
 void KXF::Importer_Assimp::execute(aiScene const *inputScene, KXF::Document *outputDocument)
 {
   /*
@@ -166,18 +328,32 @@ void KXF::Importer_Assimp::execute(aiScene const *inputScene, KXF::Document *out
 
   // Potentially a new skeleton
   KXF::Skeleton *newSkeleton = new KXF::Skeleton();
-  std::map<KXF::Bone *, std::string> parentNames;
+
+  // Bones are interned across all meshes, by name, with their position in newSkeleton->bones as their id
+  std::unordered_map<std::string, uint32_t> boneIds;
+  std::vector<std::string> parentNames;
+
+  // Every node by name, so bones don't search the node tree
+  std::unordered_map<std::string, aiNode *> nodeIndex;
+  indexNodes(inputScene->mRootNode, nodeIndex);
+
+  // Vertices and indices of every mesh are converted in parallel, everything touching the skeleton or the document stays in order
+  std::vector<KXF::Submesh *> convertedSubmeshes(inputScene->mNumMeshes, nullptr);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int64_t currMesh = 0; currMesh < int64_t(inputScene->mNumMeshes); currMesh++)
+  {
+    convertedSubmeshes[currMesh] = convertSubmesh(inputScene->mMeshes[currMesh]);
+  }
 
   // Iterate through all the meshes to add them
   for (unsigned int currMesh = 0; currMesh < inputScene->mNumMeshes; currMesh++)
   {
 
-    std::map<KXF::Bone *, aiBone *> assimpBoneIndex;
-    KXF::Submesh *newSubmesh = new KXF::Submesh();
+    KXF::Submesh *newSubmesh = convertedSubmeshes[currMesh];
 
     aiMesh *currMeshPtr = inputScene->mMeshes[currMesh];
-    uint32_t vertexCount = currMeshPtr->mNumVertices;
-    uint32_t triangleCount = currMeshPtr->mNumFaces;
 
     // Get the submesh material
     aiString tempMaterial;
@@ -190,98 +366,15 @@ void KXF::Importer_Assimp::execute(aiScene const *inputScene, KXF::Document *out
 
     std::string currMeshName = currMeshPtr->mName.C_Str();
 
-    newSubmesh->vertexFlags = KXF::VF_None;
-    if (currMeshPtr->mTextureCoords[0] != nullptr)
-      newSubmesh->vertexFlags = KXF::VertexFlags(newSubmesh->vertexFlags | KXF::VF_TexCoords1);
-    if (currMeshPtr->mTextureCoords[1] != nullptr)
-      newSubmesh->vertexFlags = KXF::VertexFlags(newSubmesh->vertexFlags | KXF::VF_TexCoords2);
-    if (currMeshPtr->mTextureCoords[2] != nullptr)
-      newSubmesh->vertexFlags = KXF::VertexFlags(newSubmesh->vertexFlags | KXF::VF_TexCoords3);
-    if (currMeshPtr->mTextureCoords[3] != nullptr)
-      newSubmesh->vertexFlags = KXF::VertexFlags(newSubmesh->vertexFlags | KXF::VF_TexCoords4);
-    if (currMeshPtr->mNormals != nullptr)
-      newSubmesh->vertexFlags = KXF::VertexFlags(newSubmesh->vertexFlags | KXF::VF_Normal);
-    if (currMeshPtr->mTangents != nullptr)
-      newSubmesh->vertexFlags = KXF::VertexFlags(newSubmesh->vertexFlags | KXF::VF_Tangent);
-
-    // Fill vertices
-    for (unsigned int currVertex = 0; currVertex < vertexCount; currVertex++)
-    {
-      KXF::Vertex currVertexData;
-
-      currVertexData.position.x = currMeshPtr->mVertices[currVertex].x;
-      currVertexData.position.y = currMeshPtr->mVertices[currVertex].y;
-      currVertexData.position.z = currMeshPtr->mVertices[currVertex].z;
-      currVertexData.position.w = 1.0f;
-
-      if (currMeshPtr->mTextureCoords[0] != nullptr)
-      {
-        currVertexData.texCoords1.x = currMeshPtr->mTextureCoords[0][currVertex].x;
-        currVertexData.texCoords1.y = currMeshPtr->mTextureCoords[0][currVertex].y;
-      }
-
-      if (currMeshPtr->mTextureCoords[1] != nullptr)
-      {
-        currVertexData.texCoords2.x = currMeshPtr->mTextureCoords[1][currVertex].x;
-        currVertexData.texCoords2.y = currMeshPtr->mTextureCoords[1][currVertex].y;
-      }
-
-      if (currMeshPtr->mTextureCoords[2] != nullptr)
-      {
-        currVertexData.texCoords3.x = currMeshPtr->mTextureCoords[2][currVertex].x;
-        currVertexData.texCoords3.y = currMeshPtr->mTextureCoords[2][currVertex].y;
-      }
-
-      if (currMeshPtr->mTextureCoords[3] != nullptr)
-      {
-        currVertexData.texCoords4.x = currMeshPtr->mTextureCoords[3][currVertex].x;
-        currVertexData.texCoords4.y = currMeshPtr->mTextureCoords[3][currVertex].y;
-      }
-
-      if (currMeshPtr->mNormals != nullptr)
-      {
-        currVertexData.normal.x = currMeshPtr->mNormals[currVertex].x;
-        currVertexData.normal.y = currMeshPtr->mNormals[currVertex].y;
-        currVertexData.normal.z = currMeshPtr->mNormals[currVertex].z;
-      }
-
-      if (currMeshPtr->mTangents != nullptr)
-      {
-        currVertexData.tangent.x = currMeshPtr->mTangents[currVertex].x;
-        currVertexData.tangent.y = currMeshPtr->mTangents[currVertex].y;
-        currVertexData.tangent.z = currMeshPtr->mTangents[currVertex].z;
-      }
-
-      // @todo: make this optional
-      blenderToKxf(currVertexData);
-
-      newSubmesh->vertices.push_back(currVertexData);
-    }
-
-    // Fill faces
-    for (unsigned int currTriangle = 0; currTriangle < triangleCount; currTriangle++)
-    {
-      aiFace *currFacePtr = &currMeshPtr->mFaces[currTriangle];
-      if (currFacePtr->mNumIndices == 3)
-      {
-        newSubmesh->indices.push_back(currFacePtr->mIndices[0]);
-        newSubmesh->indices.push_back(currFacePtr->mIndices[1]);
-        newSubmesh->indices.push_back(currFacePtr->mIndices[2]);
-      }
-    }
-
     if (newSubmesh->indices.size() < 65536)
       newSubmesh->indexFlags = KXF::IndexFlags(newSubmesh->indexFlags | IF_Use16bit);
 
     // --- SKELETON STUFF BEGINS HERE
-    // Initialize a cache that helps us keep track of how many weights each vertex has
-    std::map<uint32_t, uint32_t> vertexWeightCount;
-    for (uint32_t i = 0; i < newSubmesh->vertices.size(); i++)
-    {
-      vertexWeightCount[i] = 0;
-    }
+    // How many weights each vertex has been given, including the ones past the four it keeps
+    std::vector<uint32_t> vertexWeightCount(newSubmesh->vertices.size(), 0);
 
-    std::map<std::string, uint32_t> meshBoneIndex;
+    // Ids of the bones of this mesh in the skeleton, with their assimp bones
+    std::vector<std::pair<uint32_t, aiBone *>> meshBones;
 
     // Add bones from this mesh
     for (unsigned int currBone = 0; currBone < currMeshPtr->mNumBones; currBone++)
@@ -290,23 +383,18 @@ void KXF::Importer_Assimp::execute(aiScene const *inputScene, KXF::Document *out
         newSkeleton->name = currMeshName;
 
       aiBone *currBonePtr = currMeshPtr->mBones[currBone];
-      aiNode *currBoneNode = inputScene->mRootNode->FindNode(currBonePtr->mName.C_Str());
       std::string boneName = currBonePtr->mName.C_Str();
 
-      if (!currBoneNode)
+      auto nodeFinder = nodeIndex.find(boneName);
+      if (nodeFinder == nodeIndex.end())
       {
         continue;
       }
-
-      aiNode *parentBoneNode = currBoneNode->mParent;
-      std::string parentBoneName = "";
-      if (parentBoneNode)
-      {
-        parentBoneName = parentBoneNode->mName.C_Str();
-      }
+      aiNode *currBoneNode = nodeFinder->second;
 
       // If we dont have this bone already, add it
-      if (!newSkeleton->findBoneByName(boneName))
+      auto idFinder = boneIds.find(boneName);
+      if (idFinder == boneIds.end())
       {
         KXF::Bone *newBone = new KXF::Bone();
         newBone->inverseBindPose = glmMat4(currBonePtr->mOffsetMatrix);
@@ -316,77 +404,48 @@ void KXF::Importer_Assimp::execute(aiScene const *inputScene, KXF::Document *out
         blenderToKxf(newBone->initialTransform);
 
         newBone->name = boneName;
-        parentNames[newBone] = parentBoneName;
+        parentNames.push_back(currBoneNode->mParent ? currBoneNode->mParent->mName.C_Str() : "");
 
+        idFinder = boneIds.emplace(boneName, uint32_t(newSkeleton->bones.size())).first;
         newSkeleton->bones.push_back(newBone);
-
-        if (!parentBoneNode)
-        {
-          newSkeleton->rootBones.push_back(newBone);
-        }
-
         newSkeleton->boneIndex[newBone->name] = newBone;
-
-        assimpBoneIndex[newBone] = currBonePtr;
       }
+
+      meshBones.push_back({idFinder->second, currBonePtr});
     }
 
+    // Submesh bone ids follow the skeleton order
+    std::sort(meshBones.begin(), meshBones.end(), [](std::pair<uint32_t, aiBone *> const &a, std::pair<uint32_t, aiBone *> const &b) { return a.first < b.first; });
+
     // Add weights for the bones
     uint64_t currId = 0;
-    for (auto bone : newSkeleton->bones)
+    for (auto const &meshBone : meshBones)
     {
-      // Bone needs to be matched to an assimp bone
-      auto assimpFinder = assimpBoneIndex.find(bone);
-      if (assimpFinder == assimpBoneIndex.end())
-      {
-        continue;
-      }
-
+      KXF::Bone *bone = newSkeleton->bones[meshBone.first];
       newSubmesh->boneIndex[bone->name] = currId;
 
       // Add weights from this bone to the submesh
-      auto currBonePtr = assimpFinder->second;
+      auto currBonePtr = meshBone.second;
       for (unsigned int currWeight = 0; currWeight < currBonePtr->mNumWeights; currWeight++)
       {
         aiVertexWeight *currWeightPtr = &currBonePtr->mWeights[currWeight];
-        KXF::Vertex *currVertex = &newSubmesh->vertices[currWeightPtr->mVertexId];
-        switch (vertexWeightCount.at(currWeightPtr->mVertexId))
-        {
-        case 0:
-          currVertex->bones.x = currId;
-          currVertex->weights.x = currWeightPtr->mWeight;
-          vertexWeightCount.at(currWeightPtr->mVertexId)++;
-          break;
-
-        case 1:
-          currVertex->bones.y = currId;
-          currVertex->weights.y = currWeightPtr->mWeight;
-          vertexWeightCount.at(currWeightPtr->mVertexId)++;
-          break;
-
-        case 2:
-          currVertex->bones.z = currId;
-          currVertex->weights.z = currWeightPtr->mWeight;
-          vertexWeightCount.at(currWeightPtr->mVertexId)++;
-          break;
-
-        case 3:
-          currVertex->bones.w = currId;
-          currVertex->weights.w = currWeightPtr->mWeight;
-          vertexWeightCount.at(currWeightPtr->mVertexId)++;
-          break;
-
-        default:
-          break;
-        }
+        meshing::addBoneInfluence(newSubmesh->vertices[currWeightPtr->mVertexId], vertexWeightCount[currWeightPtr->mVertexId], uint32_t(currId), currWeightPtr->mWeight);
       }
 
       currId++;
     }
 
     if (currId > 0)
+    {
       newSubmesh->vertexFlags = KXF::VertexFlags(newSubmesh->vertexFlags | KXF::VF_Bones);
 
+      uint64_t overflowCount = meshing::normalizeBoneWeights(newSubmesh->vertices, vertexWeightCount);
+      if (overflowCount > 0)
+      {
+        LogWarning("%llu vertices of mesh %s have more than %u bone weights, kept the largest ones", (unsigned long long)overflowCount, currMeshName.c_str(), meshing::maxBoneInfluences);
+      }
+    }
+
     // Add the new mesh
     LogNotice("Imported mesh %s", currMeshName.c_str());
     auto meshFinder = meshes.find(currMeshName);
@@ -407,20 +466,18 @@ void KXF::Importer_Assimp::execute(aiScene const *inputScene, KXF::Document *out
   }
 
   // Resolve the skeletons children and parent bones
-  for (auto bone : newSkeleton->bones)
+  for (size_t currBone = 0; currBone < newSkeleton->bones.size(); currBone++)
   {
-    auto finder = parentNames.find(bone);
-    if (finder != parentNames.end())
+    KXF::Bone *bone = newSkeleton->bones[currBone];
+    auto finder = boneIds.find(parentNames[currBone]);
+    bone->parent = finder != boneIds.end() ? newSkeleton->bones[finder->second] : nullptr;
+    if (bone->parent)
     {
-      bone->parent = newSkeleton->findBoneByName(finder->second);
-      if (bone->parent)
-      {
-        bone->parent->children.push_back(bone);
-      }
-      else
-      {
-        newSkeleton->rootBones.push_back(bone);
-      }
+      bone->parent->children.push_back(bone);
+    }
+    else
+    {
+      newSkeleton->rootBones.push_back(bone);
     }
   }
 
@@ -538,7 +595,7 @@ void KXF::Importer_Assimp::execute(aiScene const *inputScene, KXF::Document *out
 
 aiScene const *KXF::Importer_Assimp::loadScene(std::string const &filePath)
 {
-  auto assScene = m_importer->ReadFile(filePath, aiProcess_FlipWindingOrder | aiProcess_CalcTangentSpace | aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_SortByPType | aiProcess_ValidateDataStructure | aiProcess_ImproveCacheLocality);
+  auto assScene = m_importer->ReadFile(filePath, aiProcess_FlipWindingOrder | aiProcess_CalcTangentSpace | aiProcess_Triangulate | aiProcess_SortByPType | aiProcess_ValidateDataStructure);
   if (!assScene)
   {
     LogError("Assimp failed: %s", m_importer->GetErrorString());
@@ -1,6 +1,8 @@
 
 #ifdef KIT_USE_FBXSDK
 #include "KXFImporter_FBXSDK.hpp"
+#include "MeshOptimization.hpp"
+#include "MeshWelding.hpp"
 #include <KIT/KXF/KXFAnimation.hpp>
 #include <KIT/KXF/KXFDocument.hpp>
 #include <KIT/KXF/KXFMesh.hpp>
@@ -60,6 +62,18 @@ void KXFImporter_FBXSDK::importFromFile(std::string const &fbxFilePath, class KX
   importAnimations();
 }
 
+void KXFImporter_FBXSDK::setWeld(bool weld, meshing::WeldSettings const &settings)
+{
+  m_weld = weld;
+  m_weldSettings = settings;
+}
+
+void KXFImporter_FBXSDK::setOptimize(bool optimize, float overdrawThreshold)
+{
+  m_optimize = optimize;
+  m_overdrawThreshold = overdrawThreshold;
+}
+
 void KXFImporter_FBXSDK::importGeometry()
 {
   // @todo clean this shithole function up
@@ -294,8 +308,23 @@ void KXFImporter_FBXSDK::importGeometry()
       KLog() << "KXFImporter (FBXSDK): Warning: Mesh skipped weights as there were more than 4 weights assigned to some vertices. Number of weights skipped: " << meshSkippedWeights << "\n";
     }
 
-    // Remove duplicate vertices in the newly generated vertex buffer and update the index buffer to match it
-    outMesh->removeDuplicates();
+    // Weld the duplicate vertices in the newly generated vertex buffers and update the index buffers to match them
+    if (m_weld)
+    {
+      uint64_t weldedCount = meshing::weldVertices(outMesh->submeshes, m_weldSettings);
+      KLog() << "KXFImporter (FBXSDK): Welded " << weldedCount << " vertices\n";
+    }
+
+    // Reorder the triangles and vertices of every submesh for the GPU
+    if (m_optimize)
+    {
+      for (auto submesh : outMesh->submeshes)
+      {
+        meshing::VertexCacheStatistics before, after;
+        meshing::optimizeSubmesh(submesh, m_overdrawThreshold, before, after);
+        KLog() << "KXFImporter (FBXSDK): Optimized submesh, ACMR: " << before.acmr << " -> " << after.acmr << ", ATVR: " << before.atvr << " -> " << after.atvr << "\n";
+      }
+    }
 
     // If the mesh lacked normals, generate new ones
     if (!meshHasNormals)
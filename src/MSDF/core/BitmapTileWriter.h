@@ -0,0 +1,19 @@
+#pragma once
+
+#include "BitmapRef.hpp"
+
+namespace msdfgen {
+
+/// Receives the tiles of a tiled generator as they are completed.
+template <int N>
+class BitmapTileWriter {
+
+public:
+    virtual ~BitmapTileWriter() { }
+    /// Receives the tile whose first pixel lies at x, y of the output, quantized to 8 bits.
+    /// The tile memory is only valid during the call. Returning false aborts the generation.
+    virtual bool writeTile(int x, int y, const BitmapConstRef<byte, N> &tile) = 0;
+
+};
+
+}
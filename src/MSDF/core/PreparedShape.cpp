@@ -0,0 +1,139 @@
+#include "PreparedShape.h"
+
+#include "edge-selectors.h"
+
+#include <cfloat>
+
+namespace msdfgen
+{
+
+  /// Resizes the array to count zeroed elements, keeping its storage
+  template <typename T>
+  static void resetArray(WorkingVector<T> &array, int count)
+  {
+    array.assign(count, T());
+  }
+
+  PreparedShape::PreparedShape(const Shape &shape)
+      : shape(NULL)
+  {
+    setShape(shape);
+  }
+
+  PreparedShape::PreparedShape()
+      : shape(NULL)
+  {
+  }
+
+  void PreparedShape::setShape(const Shape &shape)
+  {
+    this->shape = &shape;
+    contourIndices.clear();
+    edges.clear();
+    pointA.clear(), pointB.clear();
+    aTangent.clear(), bTangent.clear();
+    aBisector.clear(), bBisector.clear();
+
+    int edgeCount = shape.edgeCount();
+    contourIndices.reserve(edgeCount);
+    edges.reserve(edgeCount);
+    pointA.reserve(edgeCount), pointB.reserve(edgeCount);
+    aTangent.reserve(edgeCount), bTangent.reserve(edgeCount);
+    aBisector.reserve(edgeCount), bBisector.reserve(edgeCount);
+    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour)
+    {
+      if (!contour->edges.empty())
+      {
+        const EdgeSegment *prevEdge = contour->edges.size() >= 2 ? *(contour->edges.end() - 2) : *contour->edges.begin();
+        const EdgeSegment *curEdge = contour->edges.back();
+        for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge)
+        {
+          const EdgeSegment *nextEdge = *edge;
+          contourIndices.push_back(int(contour - shape.contours.begin()));
+          edges.push_back(curEdge);
+          EdgeEnds ends(prevEdge, curEdge, nextEdge);
+          pointA.push_back(ends.a), pointB.push_back(ends.b);
+          aTangent.push_back(ends.aDir), bTangent.push_back(ends.bDir);
+          aBisector.push_back(ends.aBisector), bBisector.push_back(ends.bBisector);
+          prevEdge = curEdge;
+          curEdge = nextEdge;
+        }
+      }
+    }
+
+    edgeCount = (int)edges.size();
+    resetArray(types, edgeCount);
+    resetArray(colors, edgeCount);
+    resetArray(bounds, edgeCount);
+    resetArray(p0, edgeCount), resetArray(p1, edgeCount), resetArray(p2, edgeCount), resetArray(p3, edgeCount);
+    resetArray(ab, edgeCount), resetArray(br, edgeCount), resetArray(as, edgeCount);
+    resetArray(p20, edgeCount), resetArray(p21, edgeCount), resetArray(p32, edgeCount);
+    resetArray(aDir, edgeCount), resetArray(bDir, edgeCount);
+    resetArray(aDirNormalized, edgeCount), resetArray(bDirNormalized, edgeCount);
+    resetArray(aDirLengthSquared, edgeCount), resetArray(bDirLengthSquared, edgeCount);
+    resetArray(abLengthSquared, edgeCount);
+    resetArray(orthonormal, edgeCount);
+    resetArray(quadraticA, edgeCount), resetArray(quadraticB, edgeCount);
+
+    for (int i = 0; i < edgeCount; ++i)
+    {
+      const EdgeSegment *edge = edges[i];
+      types[i] = edgeSegmentType(edge);
+      colors[i] = edge->color;
+      Shape::Bounds &edgeBounds = bounds[i];
+      edgeBounds.l = DBL_MAX, edgeBounds.b = DBL_MAX, edgeBounds.r = -DBL_MAX, edgeBounds.t = -DBL_MAX;
+      edge->bound(edgeBounds.l, edgeBounds.b, edgeBounds.r, edgeBounds.t);
+      aDir[i] = edge->direction(0);
+      bDir[i] = edge->direction(1);
+      aDirNormalized[i] = aDir[i].normalize();
+      bDirNormalized[i] = bDir[i].normalize();
+      aDirLengthSquared[i] = dotProduct(aDir[i], aDir[i]);
+      bDirLengthSquared[i] = dotProduct(bDir[i], bDir[i]);
+
+      // The same expressions as in the kernels' reference, EdgeSegment::signedDistance, so that the results stay identical
+      switch (types[i])
+      {
+      case EDGE_SEGMENT_LINEAR:
+      {
+        const Point2 *p = static_cast<const LinearSegment *>(edge)->p;
+        p0[i] = p[0], p1[i] = p[1];
+        ab[i] = p[1] - p[0];
+        abLengthSquared[i] = dotProduct(ab[i], ab[i]);
+        orthonormal[i] = ab[i].getOrthonormal(false);
+        break;
+      }
+      case EDGE_SEGMENT_QUADRATIC:
+      {
+        const Point2 *p = static_cast<const QuadraticSegment *>(edge)->p;
+        p0[i] = p[0], p1[i] = p[1], p2[i] = p[2];
+        ab[i] = p[1] - p[0];
+        br[i] = p[2] - p[1] - ab[i];
+        p20[i] = p[2] - p[0];
+        p21[i] = p[2] - p[1];
+        abLengthSquared[i] = dotProduct(ab[i], ab[i]);
+        quadraticA[i] = dotProduct(br[i], br[i]);
+        quadraticB[i] = 3 * dotProduct(ab[i], br[i]);
+        break;
+      }
+      case EDGE_SEGMENT_CUBIC:
+      {
+        const Point2 *p = static_cast<const CubicSegment *>(edge)->p;
+        p0[i] = p[0], p1[i] = p[1], p2[i] = p[2], p3[i] = p[3];
+        ab[i] = p[1] - p[0];
+        br[i] = p[2] - p[1] - ab[i];
+        as[i] = (p[3] - p[2]) - (p[2] - p[1]) - br[i];
+        p21[i] = p[2] - p[1];
+        p32[i] = p[3] - p[2];
+        abLengthSquared[i] = dotProduct(ab[i], ab[i]);
+        break;
+      }
+      }
+    }
+  }
+
+  int PreparedShape::edgeCount() const
+  {
+    return (int)edges.size();
+  }
+
+} // namespace msdfgen
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+#include "Vector2.h"
+#include "Shape.h"
+#include "edge-batch.h"
+#include "working-storage.h"
+
+namespace msdfgen {
+
+/// A Shape flattened into contiguous per-edge arrays, holding the coefficients that the distance kernels derive from the control points,
+/// so that they are computed once per shape rather than once per query. Edges are indexed in the order in which the distance finders visit them,
+/// contour by contour, with the last edge of each contour first. Only the coefficients of the edge's type are meaningful, the rest are zero.
+class PreparedShape {
+
+public:
+    /// The shape must persist and not change while the prepared shape is in use.
+    explicit PreparedShape(const Shape &shape);
+    /// Creates an empty prepared shape.
+    PreparedShape();
+    /// Prepares another shape, which must persist and not change while it is in use. The storage of the previous shape is reused.
+    void setShape(const Shape &shape);
+    /// Number of prepared edges.
+    int edgeCount() const;
+
+    const Shape *shape;
+
+    /// Index of the contour of each edge.
+    WorkingVector<int> contourIndices;
+    /// The edge segment, only dereferenced to convert the nearest true distance to a pseudo-distance once per query.
+    WorkingVector<const EdgeSegment *> edges;
+    WorkingVector<EdgeSegmentType> types;
+    WorkingVector<EdgeColor> colors;
+    WorkingVector<Shape::Bounds> bounds;
+
+    /// Control points.
+    WorkingVector<Point2> p0, p1, p2, p3;
+    /// Differences of consecutive control points, which make up the polynomial coefficients of the segment.
+    WorkingVector<Vector2> ab, br, as, p20, p21, p32;
+    /// Directions at the endpoints, their normalized forms and their squared lengths.
+    WorkingVector<Vector2> aDir, bDir, aDirNormalized, bDirNormalized;
+    WorkingVector<double> aDirLengthSquared, bDirLengthSquared;
+    /// Squared length of ab.
+    WorkingVector<double> abLengthSquared;
+    /// Normal of a linear segment.
+    WorkingVector<Vector2> orthonormal;
+    /// Endpoints, unit tangents at the endpoints and the bisectors of the corners they form with the neighboring edges, for the edge selectors.
+    WorkingVector<Point2> pointA, pointB;
+    WorkingVector<Vector2> aTangent, bTangent, aBisector, bBisector;
+    /// Leading coefficients of the cubic equation solved for the nearest point of a quadratic segment.
+    WorkingVector<double> quadraticA, quadraticB;
+
+};
+
+}
@@ -7,9 +7,9 @@
 namespace msdfgen
 {
 
-  static int compareIntersections(const void *a, const void *b)
+  static bool compareIntersections(const Scanline::Intersection &a, const Scanline::Intersection &b)
   {
-    return sign(reinterpret_cast<const Scanline::Intersection *>(a)->x - reinterpret_cast<const Scanline::Intersection *>(b)->x);
+    return a.x < b.x;
   }
 
   bool interpretFillRule(int intersections, FillRule fillRule)
@@ -82,9 +82,9 @@ namespace msdfgen
     lastIndex = 0;
     if (!intersections.empty())
     {
-      qsort(&intersections[0], intersections.size(), sizeof(Intersection), compareIntersections);
+      std::sort(intersections.begin(), intersections.end(), compareIntersections);
       int totalDirection = 0;
-      for (std::vector<Intersection>::iterator intersection = intersections.begin(); intersection != intersections.end(); ++intersection)
+      for (WorkingVector<Intersection>::iterator intersection = intersections.begin(); intersection != intersections.end(); ++intersection)
       {
         totalDirection += intersection->direction;
         intersection->direction = totalDirection;
@@ -94,18 +94,43 @@ namespace msdfgen
 
   void Scanline::setIntersections(const std::vector<Intersection> &intersections)
   {
-    this->intersections = intersections;
+    this->intersections.assign(intersections.begin(), intersections.end());
     preprocess();
   }
 
 #ifdef MSDFGEN_USE_CPP11
   void Scanline::setIntersections(std::vector<Intersection> &&intersections)
   {
-    this->intersections = (std::vector<Intersection> &&) intersections;
+    // The list cannot be taken over, since the working storage comes from another allocator
+    this->intersections.assign(intersections.begin(), intersections.end());
     preprocess();
   }
 #endif
 
+  void Scanline::beginIntersections()
+  {
+    intersections.clear();
+  }
+
+  void Scanline::addIntersection(double x, int direction)
+  {
+    Intersection intersection = {x, direction};
+    intersections.push_back(intersection);
+  }
+
+  bool Scanline::removeLastIntersection()
+  {
+    if (intersections.empty())
+      return false;
+    intersections.pop_back();
+    return true;
+  }
+
+  void Scanline::endIntersections()
+  {
+    preprocess();
+  }
+
   int Scanline::moveTo(double x) const
   {
     if (intersections.empty())
@@ -150,4 +175,19 @@ namespace msdfgen
     return interpretFillRule(sumIntersections(x), fillRule);
   }
 
+  void Scanline::filledSamples(char *fill, int count, double scale, double translate, FillRule fillRule) const
+  {
+    // The fill only changes at intersections, so each span is written out as a run
+    char spanFill = interpretFillRule(0, fillRule);
+    int i = 0;
+    for (WorkingVector<Intersection>::const_iterator intersection = intersections.begin(); intersection != intersections.end() && i < count; ++intersection)
+    {
+      for (; i < count && (i + .5) / scale - translate < intersection->x; ++i)
+        fill[i] = spanFill;
+      spanFill = interpretFillRule(intersection->direction, fillRule);
+    }
+    for (; i < count; ++i)
+      fill[i] = spanFill;
+  }
+
 } // namespace msdfgen
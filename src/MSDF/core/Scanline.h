@@ -2,6 +2,7 @@
 #pragma once
 
 #include <vector>
+#include "working-storage.h"
 
 namespace msdfgen {
 
@@ -36,15 +37,25 @@ public:
 #ifdef MSDFGEN_USE_CPP11
     void setIntersections(std::vector<Intersection> &&intersections);
 #endif
+    /// Starts populating the intersection list in place. Its storage is kept, so a reused scanline stops allocating once it has grown large enough.
+    void beginIntersections();
+    /// Appends an intersection to the list being populated.
+    void addIntersection(double x, int direction);
+    /// Removes the last appended intersection. Returns false if there was none.
+    bool removeLastIntersection();
+    /// Finishes populating the intersection list.
+    void endIntersections();
     /// Returns the number of intersections left of x.
     int countIntersections(double x) const;
     /// Returns the total sign of intersections left of x.
     int sumIntersections(double x) const;
     /// Decides whether the scanline is filled at x based on fill rule.
     bool filled(double x, FillRule fillRule) const;
+    /// Decides the fill at count pixel centers x = (i + .5) / scale - translate, walking the spans between intersections in a single pass.
+    void filledSamples(char *fill, int count, double scale, double translate, FillRule fillRule) const;
 
 private:
-    std::vector<Intersection> intersections;
+    WorkingVector<Intersection> intersections;
     mutable int lastIndex;
 
     void preprocess();
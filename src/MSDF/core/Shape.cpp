@@ -124,26 +124,19 @@ namespace msdfgen
 
   void Shape::scanline(Scanline &line, double y) const
   {
-    std::vector<Scanline::Intersection> intersections;
     double x[3];
     int dy[3];
+    line.beginIntersections();
     for (std::vector<Contour>::const_iterator contour = contours.begin(); contour != contours.end(); ++contour)
     {
       for (std::vector<EdgeHolder>::const_iterator edge = contour->edges.begin(); edge != contour->edges.end(); ++edge)
       {
         int n = (*edge)->scanlineIntersections(x, dy, y);
         for (int i = 0; i < n; ++i)
-        {
-          Scanline::Intersection intersection = {x[i], dy[i]};
-          intersections.push_back(intersection);
-        }
+          line.addIntersection(x[i], dy[i]);
       }
     }
-#ifdef MSDFGEN_USE_CPP11
-    line.setIntersections((std::vector<Scanline::Intersection> &&) intersections);
-#else
-    line.setIntersections(intersections);
-#endif
+    line.endIntersections();
   }
 
   int Shape::edgeCount() const
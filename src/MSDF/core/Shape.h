@@ -43,7 +43,7 @@ public:
     void boundMiters(double &l, double &b, double &r, double &t, double border, double miterLimit, int polarity) const;
     /// Computes the minimum bounding box that fits the shape, optionally with a (mitered) border.
     Bounds getBounds(double border = 0, double miterLimit = 0, int polarity = 0) const;
-    /// Outputs the scanline that intersects the shape at y.
+    /// Outputs the scanline that intersects the shape at y, reusing the storage of line.
     void scanline(Scanline &line, double y) const;
     /// Returns the total number of edge segments
     int edgeCount() const;
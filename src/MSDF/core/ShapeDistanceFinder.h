@@ -1,10 +1,15 @@
 
 #pragma once
 
+#include <algorithm>
 #include <vector>
 #include "Vector2.h"
 #include "edge-selectors.h"
 #include "contour-combiners.h"
+#include "edge-batch.h"
+#include "PreparedShape.h"
+#include "ShapeEdgeGrid.h"
+#include "working-storage.h"
 
 namespace msdfgen {
 
@@ -17,6 +22,10 @@ public:
 
     // Passed shape object must persist until the distance finder is destroyed!
     explicit ShapeDistanceFinder(const Shape &shape);
+    /// Creates a distance finder without a shape, which must be set before the first query.
+    ShapeDistanceFinder();
+    /// Switches to another shape, which must persist while it is in use. The storage of the previous shape is reused.
+    void setShape(const Shape &shape);
     /// Finds the distance from origin. Not thread-safe! Is fastest when subsequent queries are close together.
     DistanceType distance(const Point2 &origin);
 
@@ -24,9 +33,40 @@ public:
     static DistanceType oneShotDistance(const Shape &shape, const Point2 &origin);
 
 private:
-    const Shape &shape;
+    const Shape *shape;
     ContourCombiner contourCombiner;
-    std::vector<typename ContourCombiner::EdgeSelectorType::EdgeCache> shapeEdgeCache;
+    WorkingVector<typename ContourCombiner::EdgeSelectorType::EdgeCache> shapeEdgeCache;
+
+};
+
+/// Finds the distances between MSDFGEN_BATCH_SIZE points and a Shape at once, evaluating each edge for all of them with the batched distance kernels.
+/// Every lane keeps its own edge cache, so results are identical to those of a ShapeDistanceFinder per lane.
+/// With float Precision, the batched kernels search curved edges in single precision and resolve the distances in double.
+template <class ContourCombiner, typename Precision = double>
+class BatchShapeDistanceFinder {
+
+public:
+    typedef typename ContourCombiner::DistanceType DistanceType;
+
+    // Passed prepared shape and edge grid must persist until the distance finder is destroyed!
+    /// If an edge grid is given, only the edges it lists for the cell of each origin are visited.
+    explicit BatchShapeDistanceFinder(const PreparedShape &shape, const ShapeEdgeGrid *edgeGrid = NULL);
+    /// Creates a distance finder without a shape, which must be set before the first query.
+    BatchShapeDistanceFinder();
+    /// Switches to another prepared shape and edge grid, which must persist while they are in use. The storage of the previous shape is reused.
+    void setShape(const PreparedShape &shape, const ShapeEdgeGrid *edgeGrid = NULL);
+    /// Finds the distances from MSDFGEN_BATCH_SIZE origins. Not thread-safe! Is fastest when subsequent queries of each lane are close together.
+    void distance(DistanceType distances[MSDFGEN_BATCH_SIZE], const Point2 origins[MSDFGEN_BATCH_SIZE]);
+    /// Forgets the previous queries, so that the following ones are answered as by a new distance finder. Does not allocate.
+    void reset();
+
+private:
+    const PreparedShape *shape;
+    const ShapeEdgeGrid *edgeGrid;
+    ContourCombiner initialContourCombiner;
+    WorkingVector<ContourCombiner> contourCombiners;
+    WorkingVector<typename ContourCombiner::EdgeSelectorType::EdgeCache> shapeEdgeCache;
+    WorkingVector<int> allEdgeIndices;
 
 };
 
@@ -4,16 +4,26 @@
 namespace msdfgen {
 
 template <class ContourCombiner>
-ShapeDistanceFinder<ContourCombiner>::ShapeDistanceFinder(const Shape &shape) : shape(shape), contourCombiner(shape), shapeEdgeCache(shape.edgeCount()) { }
+ShapeDistanceFinder<ContourCombiner>::ShapeDistanceFinder(const Shape &shape) : shape(&shape), contourCombiner(shape), shapeEdgeCache(shape.edgeCount()) { }
+
+template <class ContourCombiner>
+ShapeDistanceFinder<ContourCombiner>::ShapeDistanceFinder() : shape(NULL) { }
+
+template <class ContourCombiner>
+void ShapeDistanceFinder<ContourCombiner>::setShape(const Shape &shape) {
+    this->shape = &shape;
+    contourCombiner.setShape(shape);
+    shapeEdgeCache.assign(shape.edgeCount(), typename ContourCombiner::EdgeSelectorType::EdgeCache());
+}
 
 template <class ContourCombiner>
 typename ShapeDistanceFinder<ContourCombiner>::DistanceType ShapeDistanceFinder<ContourCombiner>::distance(const Point2 &origin) {
     contourCombiner.reset(origin);
     typename ContourCombiner::EdgeSelectorType::EdgeCache *edgeCache = &shapeEdgeCache[0];
 
-    for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour) {
+    for (std::vector<Contour>::const_iterator contour = shape->contours.begin(); contour != shape->contours.end(); ++contour) {
         if (!contour->edges.empty()) {
-            typename ContourCombiner::EdgeSelectorType &edgeSelector = contourCombiner.edgeSelector(int(contour-shape.contours.begin()));
+            typename ContourCombiner::EdgeSelectorType &edgeSelector = contourCombiner.edgeSelector(int(contour-shape->contours.begin()));
 
             const EdgeSegment *prevEdge = contour->edges.size() >= 2 ? *(contour->edges.end()-2) : *contour->edges.begin();
             const EdgeSegment *curEdge = contour->edges.back();
@@ -53,4 +63,90 @@ typename ShapeDistanceFinder<ContourCombiner>::DistanceType ShapeDistanceFinder<
     return contourCombiner.distance();
 }
 
+template <class ContourCombiner, typename Precision>
+BatchShapeDistanceFinder<ContourCombiner, Precision>::BatchShapeDistanceFinder(const PreparedShape &shape, const ShapeEdgeGrid *edgeGrid) : shape(NULL), edgeGrid(NULL) {
+    setShape(shape, edgeGrid);
+}
+
+template <class ContourCombiner, typename Precision>
+BatchShapeDistanceFinder<ContourCombiner, Precision>::BatchShapeDistanceFinder() : shape(NULL), edgeGrid(NULL) { }
+
+template <class ContourCombiner, typename Precision>
+void BatchShapeDistanceFinder<ContourCombiner, Precision>::setShape(const PreparedShape &shape, const ShapeEdgeGrid *edgeGrid) {
+    this->shape = &shape;
+    this->edgeGrid = edgeGrid;
+    initialContourCombiner.setShape(*shape.shape);
+    contourCombiners.resize(MSDFGEN_BATCH_SIZE);
+    shapeEdgeCache.resize(MSDFGEN_BATCH_SIZE*shape.edgeCount());
+    allEdgeIndices.clear();
+    if (!edgeGrid) {
+        allEdgeIndices.resize(shape.edgeCount());
+        for (int i = 0; i < (int) allEdgeIndices.size(); ++i)
+            allEdgeIndices[i] = i;
+    }
+    reset();
+}
+
+template <class ContourCombiner, typename Precision>
+void BatchShapeDistanceFinder<ContourCombiner, Precision>::distance(DistanceType distances[MSDFGEN_BATCH_SIZE], const Point2 origins[MSDFGEN_BATCH_SIZE]) {
+    double originX[MSDFGEN_BATCH_SIZE], originY[MSDFGEN_BATCH_SIZE];
+    const int *edgeIndex[MSDFGEN_BATCH_SIZE], *edgeIndexEnd[MSDFGEN_BATCH_SIZE];
+    for (int lane = 0; lane < MSDFGEN_BATCH_SIZE; ++lane) {
+        contourCombiners[lane].reset(origins[lane]);
+        originX[lane] = origins[lane].x;
+        originY[lane] = origins[lane].y;
+        if (edgeGrid)
+            edgeGrid->cellEdges(origins[lane], edgeIndex[lane], edgeIndexEnd[lane]);
+        else {
+            edgeIndex[lane] = allEdgeIndices.empty() ? NULL : &allEdgeIndices[0];
+            edgeIndexEnd[lane] = edgeIndex[lane]+allEdgeIndices.size();
+        }
+    }
+
+    // Merge the ascending edge lists of the lanes, so that each lane still visits its edges in the original order
+    while (true) {
+        int i = -1;
+        for (int lane = 0; lane < MSDFGEN_BATCH_SIZE; ++lane) {
+            if (edgeIndex[lane] != edgeIndexEnd[lane] && (i < 0 || *edgeIndex[lane] < i))
+                i = *edgeIndex[lane];
+        }
+        if (i < 0)
+            break;
+
+        typename ContourCombiner::EdgeSelectorType::EdgeCache *edgeCache = &shapeEdgeCache[MSDFGEN_BATCH_SIZE*i];
+        typename ContourCombiner::EdgeSelectorType *edgeSelectors[MSDFGEN_BATCH_SIZE];
+        bool relevant[MSDFGEN_BATCH_SIZE];
+        bool anyRelevant = false;
+        for (int lane = 0; lane < MSDFGEN_BATCH_SIZE; ++lane) {
+            relevant[lane] = false;
+            if (edgeIndex[lane] != edgeIndexEnd[lane] && *edgeIndex[lane] == i) {
+                ++edgeIndex[lane];
+                edgeSelectors[lane] = &contourCombiners[lane].edgeSelector(shape->contourIndices[i]);
+                if ((relevant[lane] = edgeSelectors[lane]->isEdgeRelevant(edgeCache[lane], shape->colors[i])))
+                    anyRelevant = true;
+            }
+        }
+        if (anyRelevant) {
+            SignedDistance distance[MSDFGEN_BATCH_SIZE];
+            double param[MSDFGEN_BATCH_SIZE];
+            signedDistanceBatch<Precision>(distance, param, *shape, i, originX, originY);
+            for (int lane = 0; lane < MSDFGEN_BATCH_SIZE; ++lane) {
+                if (relevant[lane])
+                    edgeSelectors[lane]->addEdgeDistance(edgeCache[lane], *shape, i, distance[lane], param[lane]);
+            }
+        }
+    }
+
+    for (int lane = 0; lane < MSDFGEN_BATCH_SIZE; ++lane)
+        distances[lane] = contourCombiners[lane].distance();
+}
+
+template <class ContourCombiner, typename Precision>
+void BatchShapeDistanceFinder<ContourCombiner, Precision>::reset() {
+    // Assigning to combiners of the same shape reuses their storage
+    for (int lane = 0; lane < MSDFGEN_BATCH_SIZE; ++lane)
+        contourCombiners[lane] = initialContourCombiner;
+    std::fill(shapeEdgeCache.begin(), shapeEdgeCache.end(), typename ContourCombiner::EdgeSelectorType::EdgeCache());
+}
+
 }
@@ -0,0 +1,283 @@
+#include "ShapeEdgeGrid.h"
+
+#include "arithmetics.hpp"
+#include <cfloat>
+#include <cmath>
+
+namespace msdfgen
+{
+
+  // Cells are grown and bounds are compared with this relative tolerance to absorb rounding errors of the distance computation
+  static const double GRID_TOLERANCE = 1e-6;
+
+  struct GridEdge
+  {
+    int contourIndex;
+    int colors;
+    double l, b, r, t;
+    Point2 pointA, pointB;
+    Vector2 aRayDir, bRayDir;
+  };
+
+  struct GridBox
+  {
+    double l, b, r, t;
+  };
+
+  static double boxPointDistance(const GridBox &box, const Point2 &p)
+  {
+    double dx = max(max(box.l - p.x, p.x - box.r), 0.);
+    double dy = max(max(box.b - p.y, p.y - box.t), 0.);
+    return sqrt(dx * dx + dy * dy);
+  }
+
+  static double boxBoxDistance(const GridBox &box, double l, double b, double r, double t)
+  {
+    double dx = max(max(box.l - r, l - box.r), 0.);
+    double dy = max(max(box.b - t, b - box.t), 0.);
+    return sqrt(dx * dx + dy * dy);
+  }
+
+  /// Largest distance between p and a point of the box, which is always attained at a corner.
+  static double boxPointMaxDistance(const GridBox &box, const Point2 &p)
+  {
+    double dx = max(fabs(p.x - box.l), fabs(p.x - box.r));
+    double dy = max(fabs(p.y - box.b), fabs(p.y - box.t));
+    return sqrt(dx * dx + dy * dy);
+  }
+
+  static double rayPointDistance(const Point2 &origin, const Vector2 &dir, const Point2 &p)
+  {
+    Vector2 op = p - origin;
+    double ts = dotProduct(op, dir);
+    if (ts <= 0)
+      return op.length();
+    return fabs(crossProduct(op, dir));
+  }
+
+  /// Distance between the box and a ray with a normalized direction. Unless they intersect, it is attained either at the ray's origin or at a corner of the box.
+  static double boxRayDistance(const GridBox &box, const Point2 &origin, const Vector2 &dir)
+  {
+    double tMin = 0, tMax = DBL_MAX;
+    bool intersects = true;
+    for (int axis = 0; axis < 2 && intersects; ++axis)
+    {
+      double o = axis ? origin.y : origin.x;
+      double d = axis ? dir.y : dir.x;
+      double lo = axis ? box.b : box.l;
+      double hi = axis ? box.t : box.r;
+      if (d == 0)
+        intersects = o >= lo && o <= hi;
+      else
+      {
+        double t0 = (lo - o) / d, t1 = (hi - o) / d;
+        if (t0 > t1)
+        {
+          double tmp = t0;
+          t0 = t1;
+          t1 = tmp;
+        }
+        tMin = max(tMin, t0);
+        tMax = min(tMax, t1);
+        intersects = tMin <= tMax;
+      }
+    }
+    if (intersects)
+      return 0;
+    double distance = boxPointDistance(box, origin);
+    distance = min(distance, rayPointDistance(origin, dir, Point2(box.l, box.b)));
+    distance = min(distance, rayPointDistance(origin, dir, Point2(box.r, box.b)));
+    distance = min(distance, rayPointDistance(origin, dir, Point2(box.l, box.t)));
+    distance = min(distance, rayPointDistance(origin, dir, Point2(box.r, box.t)));
+    return distance;
+  }
+
+  /// Lower bound of the distance and pseudo-distances of the edge within the box.
+  static double edgeLowerBound(const GridEdge &edge, const GridBox &box)
+  {
+    double lowerBound = boxBoxDistance(box, edge.l, edge.b, edge.r, edge.t);
+    if (edge.aRayDir)
+      lowerBound = min(lowerBound, boxRayDistance(box, edge.pointA, edge.aRayDir));
+    if (edge.bRayDir)
+      lowerBound = min(lowerBound, boxRayDistance(box, edge.pointB, edge.bRayDir));
+    return lowerBound;
+  }
+
+  /// State shared by the nodes of a grid build.
+  struct GridBuild
+  {
+    const GridEdge *edges;
+    int keyCount;
+    double margin;
+    Point2 origin;
+    Vector2 cellSize;
+    int columns;
+    WorkingVector<int> *candidates;
+    WorkingVector<double> *upperBounds;
+    WorkingVector<int> *cellRanges;
+    WorkingVector<int> *edgeIndices;
+  };
+
+  /// Lists the edges of the cells in columns column0 to column1 and rows row0 to row1, given the candidates that were not ruled out for the whole block.
+  /// The upper bound of a channel over the block is at least that of each of its cells, and the lower bound of an edge over the block at most that
+  /// within each cell, so an edge ruled out for the block is also ruled out for all of its cells. The block is split in two along its longer side,
+  /// until single cells are left, which are decided by the same test on their own bounds.
+  static void buildGridNode(const GridBuild &build, int column0, int row0, int column1, int row1, int candidatesBegin, int candidatesEnd, int depth)
+  {
+    bool cell = column1 - column0 == 1 && row1 - row0 == 1;
+    Point2 p0 = build.origin + Vector2(column0 * build.cellSize.x, row0 * build.cellSize.y);
+    Point2 p1 = cell ? p0 + build.cellSize : build.origin + Vector2(column1 * build.cellSize.x, row1 * build.cellSize.y);
+    GridBox box;
+    box.l = min(p0.x, p1.x) - build.margin;
+    box.b = min(p0.y, p1.y) - build.margin;
+    box.r = max(p0.x, p1.x) + build.margin;
+    box.t = max(p0.y, p1.y) + build.margin;
+
+    // The distance to an edge never exceeds the distance to its nearer endpoint, which bounds the nearest distance of each channel (and contour).
+    // Edges ruled out by a larger block have both endpoints farther than its bounds, so they cannot lower them.
+    double *upperBounds = &(*build.upperBounds)[depth * build.keyCount];
+    for (int key = 0; key < build.keyCount; ++key)
+      upperBounds[key] = DBL_MAX;
+    for (int c = candidatesBegin; c < candidatesEnd; ++c)
+    {
+      const GridEdge &edge = build.edges[(*build.candidates)[c]];
+      double distance = min(boxPointMaxDistance(box, edge.pointA), boxPointMaxDistance(box, edge.pointB));
+      for (int channel = 0; channel < 3; ++channel)
+      {
+        if (edge.colors & (1 << channel))
+        {
+          double &upperBound = upperBounds[3 * edge.contourIndex + channel];
+          upperBound = min(upperBound, distance);
+        }
+      }
+    }
+
+    // Blocks keep a little more than their cells, since their bounds are not rounded quite like those of the cells they contain
+    double tolerance = cell ? build.margin : 2 * build.margin;
+    WorkingVector<int> &output = cell ? *build.edgeIndices : *build.candidates;
+    int outputBegin = (int)output.size();
+    for (int c = candidatesBegin; c < candidatesEnd; ++c)
+    {
+      int i = (*build.candidates)[c];
+      const GridEdge &edge = build.edges[i];
+      double lowerBound = edgeLowerBound(edge, box);
+      for (int channel = 0; channel < 3; ++channel)
+      {
+        if (edge.colors & (1 << channel) && lowerBound - tolerance <= upperBounds[3 * edge.contourIndex + channel])
+        {
+          output.push_back(i);
+          break;
+        }
+      }
+    }
+    int outputEnd = (int)output.size();
+
+    if (cell)
+    {
+      int index = row0 * build.columns + column0;
+      (*build.cellRanges)[2 * index] = outputBegin;
+      (*build.cellRanges)[2 * index + 1] = outputEnd;
+      return;
+    }
+
+    if (column1 - column0 >= row1 - row0)
+    {
+      int split = (column0 + column1) / 2;
+      buildGridNode(build, column0, row0, split, row1, outputBegin, outputEnd, depth + 1);
+      buildGridNode(build, split, row0, column1, row1, outputBegin, outputEnd, depth + 1);
+    }
+    else
+    {
+      int split = (row0 + row1) / 2;
+      buildGridNode(build, column0, row0, column1, split, outputBegin, outputEnd, depth + 1);
+      buildGridNode(build, column0, split, column1, row1, outputBegin, outputEnd, depth + 1);
+    }
+    build.candidates->resize(outputBegin);
+  }
+
+  ShapeEdgeGrid::ShapeEdgeGrid() : columns(0), rows(0)
+  {
+  }
+
+  ShapeEdgeGrid::ShapeEdgeGrid(const PreparedShape &shape, const Point2 &origin, const Vector2 &cellSize, int columns, int rows, bool overlapSupport)
+  {
+    setShape(shape, origin, cellSize, columns, rows, overlapSupport);
+  }
+
+  void ShapeEdgeGrid::setShape(const PreparedShape &shape, const Point2 &origin, const Vector2 &cellSize, int columns, int rows, bool overlapSupport)
+  {
+    this->origin = origin, this->cellSize = cellSize, this->columns = columns, this->rows = rows;
+    cellRanges.clear();
+    edgeIndices.clear();
+
+    // Scratch space of the thread, kept for its later grids
+    static thread_local WorkingVector<GridEdge> edges;
+    edges.resize(shape.edgeCount());
+    for (int i = 0; i < (int)edges.size(); ++i)
+    {
+      GridEdge &gridEdge = edges[i];
+      gridEdge.contourIndex = overlapSupport ? shape.contourIndices[i] : 0;
+      // Uncolored edges still count towards every channel of the selectors that ignore colors
+      gridEdge.colors = shape.colors[i] & WHITE ? shape.colors[i] & WHITE : WHITE;
+      gridEdge.l = shape.bounds[i].l, gridEdge.b = shape.bounds[i].b, gridEdge.r = shape.bounds[i].r, gridEdge.t = shape.bounds[i].t;
+      gridEdge.pointA = shape.pointA[i];
+      gridEdge.pointB = shape.pointB[i];
+      // Pseudo-distances are perpendicular distances from the extensions of the edge beyond its endpoints
+      gridEdge.aRayDir = -shape.aTangent[i];
+      gridEdge.bRayDir = shape.bTangent[i];
+    }
+
+    int edgeCount = (int)edges.size();
+    int cellCount = columns * rows;
+    // An extra cell past the grid lists every edge for points outside of it
+    cellRanges.resize(2 * (cellCount + 1));
+    if (cellCount > 0)
+    {
+      // Every split halves the longer side of a block, so a cell is reached after about log2(columns) + log2(rows) of them
+      int depthCount = 1;
+      for (int size = 1; size < columns; size *= 2)
+        ++depthCount;
+      for (int size = 1; size < rows; size *= 2)
+        ++depthCount;
+
+      static thread_local WorkingVector<int> candidates;
+      static thread_local WorkingVector<double> upperBounds;
+      candidates.resize(edgeCount);
+      for (int i = 0; i < edgeCount; ++i)
+        candidates[i] = i;
+      int keyCount = 3 * (int)shape.shape->contours.size();
+      upperBounds.resize(depthCount * keyCount);
+
+      GridBuild build;
+      build.edges = edgeCount ? &edges[0] : NULL;
+      build.keyCount = keyCount;
+      build.margin = GRID_TOLERANCE * (fabs(cellSize.x) + fabs(cellSize.y));
+      build.origin = origin;
+      build.cellSize = cellSize;
+      build.columns = columns;
+      build.candidates = &candidates;
+      build.upperBounds = &upperBounds;
+      build.cellRanges = &cellRanges;
+      build.edgeIndices = &edgeIndices;
+      buildGridNode(build, 0, 0, columns, rows, 0, edgeCount, 0);
+    }
+
+    cellRanges[2 * cellCount] = (int)edgeIndices.size();
+    for (int i = 0; i < edgeCount; ++i)
+      edgeIndices.push_back(i);
+    cellRanges[2 * cellCount + 1] = (int)edgeIndices.size();
+  }
+
+  void ShapeEdgeGrid::cellEdges(const Point2 &p, const int *&begin, const int *&end) const
+  {
+    int cell = columns * rows;
+    double column = floor((p.x - origin.x) / cellSize.x);
+    double row = floor((p.y - origin.y) / cellSize.y);
+    if (column >= 0 && column < columns && row >= 0 && row < rows)
+      cell = int(row) * columns + int(column);
+    const int *indices = edgeIndices.empty() ? NULL : &edgeIndices[0];
+    begin = indices + cellRanges[2 * cell];
+    end = indices + cellRanges[2 * cell + 1];
+  }
+
+} // namespace msdfgen
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+#include "Vector2.h"
+#include "PreparedShape.h"
+#include "working-storage.h"
+
+// Shapes with at least this many edges are generated with the help of a ShapeEdgeGrid.
+#ifndef MSDFGEN_EDGE_GRID_MIN_EDGES
+#define MSDFGEN_EDGE_GRID_MIN_EDGES 32
+#endif
+// Width and height of a ShapeEdgeGrid cell in output pixels.
+#ifndef MSDFGEN_EDGE_GRID_CELL_SIZE
+#define MSDFGEN_EDGE_GRID_CELL_SIZE 8
+#endif
+
+namespace msdfgen {
+
+/// A uniform grid over a rectangular region of a shape, which lists for each cell the edges that may affect a distance queried inside it.
+/// An edge is dropped from a cell only if its true distance and the pseudo-distances of its endpoints provably exceed the distance to the nearest edge
+/// of the same color channel everywhere in the cell, so the edge selectors arrive at the same result. With overlap support, the nearest edge is taken
+/// from the same contour, since OverlappingContourCombiner needs the distance of every contour.
+class ShapeEdgeGrid {
+
+public:
+    ShapeEdgeGrid();
+    /// Builds a grid of columns x rows cells of cellSize, starting at origin. The shape must not change while the grid is in use.
+    ShapeEdgeGrid(const PreparedShape &shape, const Point2 &origin, const Vector2 &cellSize, int columns, int rows, bool overlapSupport);
+    /// Rebuilds the grid like the constructor, for another shape or region. The storage of the previous grid is reused.
+    void setShape(const PreparedShape &shape, const Point2 &origin, const Vector2 &cellSize, int columns, int rows, bool overlapSupport);
+    /// Retrieves the ascending indices of the edges relevant to the cell containing p, or of all edges if p lies outside the grid.
+    /// Edges are indexed as in the PreparedShape.
+    void cellEdges(const Point2 &p, const int *&begin, const int *&end) const;
+
+private:
+    Point2 origin;
+    Vector2 cellSize;
+    int columns, rows;
+    /// Begin and end of the edge indices of each cell, followed by those of the cell outside of the grid
+    WorkingVector<int> cellRanges;
+    WorkingVector<int> edgeIndices;
+
+};
+
+}
@@ -28,11 +28,22 @@ namespace msdfgen
     return median(distance.r, distance.g, distance.b);
   }
 
+  template <class EdgeSelector>
+  SimpleContourCombiner<EdgeSelector>::SimpleContourCombiner()
+  {
+  }
+
   template <class EdgeSelector>
   SimpleContourCombiner<EdgeSelector>::SimpleContourCombiner(const Shape &shape)
   {
   }
 
+  template <class EdgeSelector>
+  void SimpleContourCombiner<EdgeSelector>::setShape(const Shape &)
+  {
+    shapeEdgeSelector = EdgeSelector();
+  }
+
   template <class EdgeSelector>
   void SimpleContourCombiner<EdgeSelector>::reset(const Point2 &p)
   {
@@ -56,20 +67,32 @@ namespace msdfgen
   template class SimpleContourCombiner<MultiDistanceSelector>;
   template class SimpleContourCombiner<MultiAndTrueDistanceSelector>;
 
+  template <class EdgeSelector>
+  OverlappingContourCombiner<EdgeSelector>::OverlappingContourCombiner()
+  {
+  }
+
   template <class EdgeSelector>
   OverlappingContourCombiner<EdgeSelector>::OverlappingContourCombiner(const Shape &shape)
   {
+    setShape(shape);
+  }
+
+  template <class EdgeSelector>
+  void OverlappingContourCombiner<EdgeSelector>::setShape(const Shape &shape)
+  {
+    windings.clear();
     windings.reserve(shape.contours.size());
     for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end(); ++contour)
       windings.push_back(contour->winding());
-    edgeSelectors.resize(shape.contours.size());
+    edgeSelectors.assign(shape.contours.size(), EdgeSelector());
   }
 
   template <class EdgeSelector>
   void OverlappingContourCombiner<EdgeSelector>::reset(const Point2 &p)
   {
     this->p = p;
-    for (typename std::vector<EdgeSelector>::iterator contourEdgeSelector = edgeSelectors.begin(); contourEdgeSelector != edgeSelectors.end(); ++contourEdgeSelector)
+    for (typename WorkingVector<EdgeSelector>::iterator contourEdgeSelector = edgeSelectors.begin(); contourEdgeSelector != edgeSelectors.end(); ++contourEdgeSelector)
       contourEdgeSelector->reset(p);
   }
 
@@ -3,6 +3,7 @@
 
 #include "Shape.h"
 #include "edge-selectors.h"
+#include "working-storage.h"
 
 namespace msdfgen {
 
@@ -14,7 +15,10 @@ public:
     typedef EdgeSelector EdgeSelectorType;
     typedef typename EdgeSelector::DistanceType DistanceType;
 
+    SimpleContourCombiner();
     explicit SimpleContourCombiner(const Shape &shape);
+    /// Sets the combiner up for another shape.
+    void setShape(const Shape &shape);
     void reset(const Point2 &p);
     EdgeSelector & edgeSelector(int i);
     DistanceType distance() const;
@@ -32,15 +36,18 @@ public:
     typedef EdgeSelector EdgeSelectorType;
     typedef typename EdgeSelector::DistanceType DistanceType;
 
+    OverlappingContourCombiner();
     explicit OverlappingContourCombiner(const Shape &shape);
+    /// Sets the combiner up for another shape, reusing the storage of the previous one.
+    void setShape(const Shape &shape);
     void reset(const Point2 &p);
     EdgeSelector & edgeSelector(int i);
     DistanceType distance() const;
 
 private:
     Point2 p;
-    std::vector<int> windings;
-    std::vector<EdgeSelector> edgeSelectors;
+    WorkingVector<int> windings;
+    WorkingVector<EdgeSelector> edgeSelectors;
 
 };
 
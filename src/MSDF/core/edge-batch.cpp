@@ -0,0 +1,914 @@
+#include "edge-batch.h"
+
+#include "PreparedShape.h"
+#include "arithmetics.hpp"
+#include "equation-solver.h"
+#include <cmath>
+#include <cstring>
+
+#if !defined(MSDFGEN_NO_SIMD) && defined(__AVX__)
+#define MSDFGEN_BATCH_AVX
+#include <immintrin.h>
+#elif !defined(MSDFGEN_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MSDFGEN_BATCH_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace msdfgen
+{
+
+  // Lane types hold one value per sample point of the batch, in double or single precision. Comparisons return masks with all bits set in the lanes where they hold.
+  // Every operation is a single IEEE operation per lane in the same order as the scalar code, so double precision results match it exactly.
+
+  template <class L>
+  inline L lanes(double value);
+
+  /// Loads MSDFGEN_BATCH_SIZE values, rounding them to the precision of the lanes.
+  template <class L>
+  inline L load(const double *values);
+
+#if defined(MSDFGEN_BATCH_AVX) || defined(MSDFGEN_BATCH_SSE2)
+
+  struct FloatLanes
+  {
+    typedef float Scalar;
+    __m128 v;
+  };
+
+  template <>
+  inline FloatLanes lanes<FloatLanes>(double value)
+  {
+    FloatLanes r;
+    r.v = _mm_set1_ps(float(value));
+    return r;
+  }
+
+  template <>
+  inline FloatLanes load<FloatLanes>(const double *values)
+  {
+    FloatLanes r;
+    r.v = _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(values)), _mm_cvtpd_ps(_mm_loadu_pd(values + 2)));
+    return r;
+  }
+
+  static inline void store(double *values, const FloatLanes &a)
+  {
+    _mm_storeu_pd(values, _mm_cvtps_pd(a.v));
+    _mm_storeu_pd(values + 2, _mm_cvtps_pd(_mm_movehl_ps(a.v, a.v)));
+  }
+
+  static inline FloatLanes operator+(const FloatLanes &a, const FloatLanes &b)
+  {
+    FloatLanes r;
+    r.v = _mm_add_ps(a.v, b.v);
+    return r;
+  }
+
+  static inline FloatLanes operator-(const FloatLanes &a, const FloatLanes &b)
+  {
+    FloatLanes r;
+    r.v = _mm_sub_ps(a.v, b.v);
+    return r;
+  }
+
+  static inline FloatLanes operator*(const FloatLanes &a, const FloatLanes &b)
+  {
+    FloatLanes r;
+    r.v = _mm_mul_ps(a.v, b.v);
+    return r;
+  }
+
+  static inline FloatLanes operator/(const FloatLanes &a, const FloatLanes &b)
+  {
+    FloatLanes r;
+    r.v = _mm_div_ps(a.v, b.v);
+    return r;
+  }
+
+  static inline FloatLanes laneSqrt(const FloatLanes &a)
+  {
+    FloatLanes r;
+    r.v = _mm_sqrt_ps(a.v);
+    return r;
+  }
+
+  static inline FloatLanes laneAbs(const FloatLanes &a)
+  {
+    FloatLanes r;
+    r.v = _mm_andnot_ps(_mm_set1_ps(-0.f), a.v);
+    return r;
+  }
+
+  static inline FloatLanes negate(const FloatLanes &a)
+  {
+    FloatLanes r;
+    r.v = _mm_xor_ps(_mm_set1_ps(-0.f), a.v);
+    return r;
+  }
+
+  static inline FloatLanes less(const FloatLanes &a, const FloatLanes &b)
+  {
+    FloatLanes r;
+    r.v = _mm_cmplt_ps(a.v, b.v);
+    return r;
+  }
+
+  static inline FloatLanes lessEqual(const FloatLanes &a, const FloatLanes &b)
+  {
+    FloatLanes r;
+    r.v = _mm_cmple_ps(a.v, b.v);
+    return r;
+  }
+
+  static inline FloatLanes equal(const FloatLanes &a, const FloatLanes &b)
+  {
+    FloatLanes r;
+    r.v = _mm_cmpeq_ps(a.v, b.v);
+    return r;
+  }
+
+  static inline FloatLanes maskAnd(const FloatLanes &a, const FloatLanes &b)
+  {
+    FloatLanes r;
+    r.v = _mm_and_ps(a.v, b.v);
+    return r;
+  }
+
+  static inline FloatLanes maskOr(const FloatLanes &a, const FloatLanes &b)
+  {
+    FloatLanes r;
+    r.v = _mm_or_ps(a.v, b.v);
+    return r;
+  }
+
+  /// Lanes of a where b is not set.
+  static inline FloatLanes maskAndNot(const FloatLanes &a, const FloatLanes &b)
+  {
+    FloatLanes r;
+    r.v = _mm_andnot_ps(b.v, a.v);
+    return r;
+  }
+
+  static inline FloatLanes select(const FloatLanes &mask, const FloatLanes &a, const FloatLanes &b)
+  {
+    FloatLanes r;
+    r.v = _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+    return r;
+  }
+
+  static inline bool anyLane(const FloatLanes &mask)
+  {
+    return _mm_movemask_ps(mask.v) != 0;
+  }
+
+#endif
+
+#if defined(MSDFGEN_BATCH_AVX)
+
+  struct DoubleLanes
+  {
+    typedef double Scalar;
+    __m256d v;
+  };
+
+  template <>
+  inline DoubleLanes lanes<DoubleLanes>(double value)
+  {
+    DoubleLanes r;
+    r.v = _mm256_set1_pd(value);
+    return r;
+  }
+
+  template <>
+  inline DoubleLanes load<DoubleLanes>(const double *values)
+  {
+    DoubleLanes r;
+    r.v = _mm256_loadu_pd(values);
+    return r;
+  }
+
+  static inline void store(double *values, const DoubleLanes &a)
+  {
+    _mm256_storeu_pd(values, a.v);
+  }
+
+  static inline DoubleLanes operator+(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v = _mm256_add_pd(a.v, b.v);
+    return r;
+  }
+
+  static inline DoubleLanes operator-(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v = _mm256_sub_pd(a.v, b.v);
+    return r;
+  }
+
+  static inline DoubleLanes operator*(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v = _mm256_mul_pd(a.v, b.v);
+    return r;
+  }
+
+  static inline DoubleLanes operator/(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v = _mm256_div_pd(a.v, b.v);
+    return r;
+  }
+
+  static inline DoubleLanes laneSqrt(const DoubleLanes &a)
+  {
+    DoubleLanes r;
+    r.v = _mm256_sqrt_pd(a.v);
+    return r;
+  }
+
+  static inline DoubleLanes laneAbs(const DoubleLanes &a)
+  {
+    DoubleLanes r;
+    r.v = _mm256_andnot_pd(_mm256_set1_pd(-0.), a.v);
+    return r;
+  }
+
+  static inline DoubleLanes negate(const DoubleLanes &a)
+  {
+    DoubleLanes r;
+    r.v = _mm256_xor_pd(_mm256_set1_pd(-0.), a.v);
+    return r;
+  }
+
+  static inline DoubleLanes less(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v = _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ);
+    return r;
+  }
+
+  static inline DoubleLanes lessEqual(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v = _mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ);
+    return r;
+  }
+
+  static inline DoubleLanes equal(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v = _mm256_cmp_pd(a.v, b.v, _CMP_EQ_OQ);
+    return r;
+  }
+
+  static inline DoubleLanes maskAnd(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v = _mm256_and_pd(a.v, b.v);
+    return r;
+  }
+
+  static inline DoubleLanes maskOr(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v = _mm256_or_pd(a.v, b.v);
+    return r;
+  }
+
+  /// DoubleLanes of a where b is not set.
+  static inline DoubleLanes maskAndNot(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v = _mm256_andnot_pd(b.v, a.v);
+    return r;
+  }
+
+  static inline DoubleLanes select(const DoubleLanes &mask, const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v = _mm256_blendv_pd(b.v, a.v, mask.v);
+    return r;
+  }
+
+  static inline bool anyLane(const DoubleLanes &mask)
+  {
+    return _mm256_movemask_pd(mask.v) != 0;
+  }
+
+#elif defined(MSDFGEN_BATCH_SSE2)
+
+  struct DoubleLanes
+  {
+    typedef double Scalar;
+    __m128d v[2];
+  };
+
+  template <>
+  inline DoubleLanes lanes<DoubleLanes>(double value)
+  {
+    DoubleLanes r;
+    r.v[0] = r.v[1] = _mm_set1_pd(value);
+    return r;
+  }
+
+  template <>
+  inline DoubleLanes load<DoubleLanes>(const double *values)
+  {
+    DoubleLanes r;
+    r.v[0] = _mm_loadu_pd(values);
+    r.v[1] = _mm_loadu_pd(values + 2);
+    return r;
+  }
+
+  static inline void store(double *values, const DoubleLanes &a)
+  {
+    _mm_storeu_pd(values, a.v[0]);
+    _mm_storeu_pd(values + 2, a.v[1]);
+  }
+
+  static inline DoubleLanes operator+(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v[0] = _mm_add_pd(a.v[0], b.v[0]);
+    r.v[1] = _mm_add_pd(a.v[1], b.v[1]);
+    return r;
+  }
+
+  static inline DoubleLanes operator-(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v[0] = _mm_sub_pd(a.v[0], b.v[0]);
+    r.v[1] = _mm_sub_pd(a.v[1], b.v[1]);
+    return r;
+  }
+
+  static inline DoubleLanes operator*(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v[0] = _mm_mul_pd(a.v[0], b.v[0]);
+    r.v[1] = _mm_mul_pd(a.v[1], b.v[1]);
+    return r;
+  }
+
+  static inline DoubleLanes operator/(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v[0] = _mm_div_pd(a.v[0], b.v[0]);
+    r.v[1] = _mm_div_pd(a.v[1], b.v[1]);
+    return r;
+  }
+
+  static inline DoubleLanes laneSqrt(const DoubleLanes &a)
+  {
+    DoubleLanes r;
+    r.v[0] = _mm_sqrt_pd(a.v[0]);
+    r.v[1] = _mm_sqrt_pd(a.v[1]);
+    return r;
+  }
+
+  static inline DoubleLanes laneAbs(const DoubleLanes &a)
+  {
+    __m128d signBit = _mm_set1_pd(-0.);
+    DoubleLanes r;
+    r.v[0] = _mm_andnot_pd(signBit, a.v[0]);
+    r.v[1] = _mm_andnot_pd(signBit, a.v[1]);
+    return r;
+  }
+
+  static inline DoubleLanes negate(const DoubleLanes &a)
+  {
+    __m128d signBit = _mm_set1_pd(-0.);
+    DoubleLanes r;
+    r.v[0] = _mm_xor_pd(signBit, a.v[0]);
+    r.v[1] = _mm_xor_pd(signBit, a.v[1]);
+    return r;
+  }
+
+  static inline DoubleLanes less(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v[0] = _mm_cmplt_pd(a.v[0], b.v[0]);
+    r.v[1] = _mm_cmplt_pd(a.v[1], b.v[1]);
+    return r;
+  }
+
+  static inline DoubleLanes lessEqual(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v[0] = _mm_cmple_pd(a.v[0], b.v[0]);
+    r.v[1] = _mm_cmple_pd(a.v[1], b.v[1]);
+    return r;
+  }
+
+  static inline DoubleLanes equal(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v[0] = _mm_cmpeq_pd(a.v[0], b.v[0]);
+    r.v[1] = _mm_cmpeq_pd(a.v[1], b.v[1]);
+    return r;
+  }
+
+  static inline DoubleLanes maskAnd(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v[0] = _mm_and_pd(a.v[0], b.v[0]);
+    r.v[1] = _mm_and_pd(a.v[1], b.v[1]);
+    return r;
+  }
+
+  static inline DoubleLanes maskOr(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v[0] = _mm_or_pd(a.v[0], b.v[0]);
+    r.v[1] = _mm_or_pd(a.v[1], b.v[1]);
+    return r;
+  }
+
+  /// DoubleLanes of a where b is not set.
+  static inline DoubleLanes maskAndNot(const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v[0] = _mm_andnot_pd(b.v[0], a.v[0]);
+    r.v[1] = _mm_andnot_pd(b.v[1], a.v[1]);
+    return r;
+  }
+
+  static inline DoubleLanes select(const DoubleLanes &mask, const DoubleLanes &a, const DoubleLanes &b)
+  {
+    DoubleLanes r;
+    r.v[0] = _mm_or_pd(_mm_and_pd(mask.v[0], a.v[0]), _mm_andnot_pd(mask.v[0], b.v[0]));
+    r.v[1] = _mm_or_pd(_mm_and_pd(mask.v[1], a.v[1]), _mm_andnot_pd(mask.v[1], b.v[1]));
+    return r;
+  }
+
+  static inline bool anyLane(const DoubleLanes &mask)
+  {
+    return (_mm_movemask_pd(mask.v[0]) | _mm_movemask_pd(mask.v[1])) != 0;
+  }
+
+#else
+
+  template <typename T>
+  struct ScalarLanes
+  {
+    typedef T Scalar;
+    T v[MSDFGEN_BATCH_SIZE];
+  };
+
+  typedef ScalarLanes<double> DoubleLanes;
+  typedef ScalarLanes<float> FloatLanes;
+
+  template <typename T>
+  static inline T maskValue(bool set)
+  {
+    T value;
+    memset(&value, set ? 0xff : 0, sizeof(value));
+    return value;
+  }
+
+  template <typename T>
+  static inline bool isMaskSet(T value)
+  {
+    unsigned char bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(value));
+    return bytes[0] != 0;
+  }
+
+  template <class L>
+  inline L lanes(double value)
+  {
+    L r;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+      r.v[i] = typename L::Scalar(value);
+    return r;
+  }
+
+  template <class L>
+  inline L load(const double *values)
+  {
+    L r;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+      r.v[i] = typename L::Scalar(values[i]);
+    return r;
+  }
+
+  template <typename T>
+  static inline void store(double *values, const ScalarLanes<T> &a)
+  {
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+      values[i] = a.v[i];
+  }
+
+  template <typename T>
+  static inline ScalarLanes<T> operator+(const ScalarLanes<T> &a, const ScalarLanes<T> &b)
+  {
+    ScalarLanes<T> r;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+      r.v[i] = a.v[i] + b.v[i];
+    return r;
+  }
+
+  template <typename T>
+  static inline ScalarLanes<T> operator-(const ScalarLanes<T> &a, const ScalarLanes<T> &b)
+  {
+    ScalarLanes<T> r;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+      r.v[i] = a.v[i] - b.v[i];
+    return r;
+  }
+
+  template <typename T>
+  static inline ScalarLanes<T> operator*(const ScalarLanes<T> &a, const ScalarLanes<T> &b)
+  {
+    ScalarLanes<T> r;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+      r.v[i] = a.v[i] * b.v[i];
+    return r;
+  }
+
+  template <typename T>
+  static inline ScalarLanes<T> operator/(const ScalarLanes<T> &a, const ScalarLanes<T> &b)
+  {
+    ScalarLanes<T> r;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+      r.v[i] = a.v[i] / b.v[i];
+    return r;
+  }
+
+  template <typename T>
+  static inline ScalarLanes<T> laneSqrt(const ScalarLanes<T> &a)
+  {
+    ScalarLanes<T> r;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+      r.v[i] = std::sqrt(a.v[i]);
+    return r;
+  }
+
+  template <typename T>
+  static inline ScalarLanes<T> laneAbs(const ScalarLanes<T> &a)
+  {
+    ScalarLanes<T> r;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+      r.v[i] = std::fabs(a.v[i]);
+    return r;
+  }
+
+  template <typename T>
+  static inline ScalarLanes<T> negate(const ScalarLanes<T> &a)
+  {
+    ScalarLanes<T> r;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+      r.v[i] = -a.v[i];
+    return r;
+  }
+
+  template <typename T>
+  static inline ScalarLanes<T> less(const ScalarLanes<T> &a, const ScalarLanes<T> &b)
+  {
+    ScalarLanes<T> r;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+      r.v[i] = maskValue<T>(a.v[i] < b.v[i]);
+    return r;
+  }
+
+  template <typename T>
+  static inline ScalarLanes<T> lessEqual(const ScalarLanes<T> &a, const ScalarLanes<T> &b)
+  {
+    ScalarLanes<T> r;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+      r.v[i] = maskValue<T>(a.v[i] <= b.v[i]);
+    return r;
+  }
+
+  template <typename T>
+  static inline ScalarLanes<T> equal(const ScalarLanes<T> &a, const ScalarLanes<T> &b)
+  {
+    ScalarLanes<T> r;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+      r.v[i] = maskValue<T>(a.v[i] == b.v[i]);
+    return r;
+  }
+
+  template <typename T>
+  static inline ScalarLanes<T> maskAnd(const ScalarLanes<T> &a, const ScalarLanes<T> &b)
+  {
+    ScalarLanes<T> r;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+      r.v[i] = maskValue<T>(isMaskSet(a.v[i]) && isMaskSet(b.v[i]));
+    return r;
+  }
+
+  template <typename T>
+  static inline ScalarLanes<T> maskOr(const ScalarLanes<T> &a, const ScalarLanes<T> &b)
+  {
+    ScalarLanes<T> r;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+      r.v[i] = maskValue<T>(isMaskSet(a.v[i]) || isMaskSet(b.v[i]));
+    return r;
+  }
+
+  /// Lanes of a where b is not set.
+  template <typename T>
+  static inline ScalarLanes<T> maskAndNot(const ScalarLanes<T> &a, const ScalarLanes<T> &b)
+  {
+    ScalarLanes<T> r;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+      r.v[i] = maskValue<T>(isMaskSet(a.v[i]) && !isMaskSet(b.v[i]));
+    return r;
+  }
+
+  template <typename T>
+  static inline ScalarLanes<T> select(const ScalarLanes<T> &mask, const ScalarLanes<T> &a, const ScalarLanes<T> &b)
+  {
+    ScalarLanes<T> r;
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+      r.v[i] = isMaskSet(mask.v[i]) ? a.v[i] : b.v[i];
+    return r;
+  }
+
+  template <typename T>
+  static inline bool anyLane(const ScalarLanes<T> &mask)
+  {
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+      if (isMaskSet(mask.v[i]))
+        return true;
+    return false;
+  }
+
+#endif
+
+  template <class L>
+  static inline L greater(const L &a, const L &b)
+  {
+    return less(b, a);
+  }
+
+  template <class L>
+  static inline L greaterEqual(const L &a, const L &b)
+  {
+    return lessEqual(b, a);
+  }
+
+  /// Equivalent of nonZeroSign(sign) * distance.
+  template <class L>
+  static inline L applyNonZeroSign(const L &sign, const L &distance)
+  {
+    return select(greater(sign, lanes<L>(0)), distance, negate(distance));
+  }
+
+  /// Equivalent of fabs(dotProduct(dir, Vector2(x, y).normalize())), where length is the length of (x, y).
+  template <class L>
+  static inline L absDotNormalized(const Vector2 &dir, const L &x, const L &y, const L &length)
+  {
+    L zeroLength = equal(length, lanes<L>(0));
+    L nx = select(zeroLength, lanes<L>(0), x / length);
+    L ny = select(zeroLength, lanes<L>(1), y / length);
+    return laneAbs(lanes<L>(dir.x) * nx + lanes<L>(dir.y) * ny);
+  }
+
+  template <class L>
+  static inline void storeSignedDistances(SignedDistance distance[MSDFGEN_BATCH_SIZE], double param[MSDFGEN_BATCH_SIZE], const L &distances, const L &dots, const L &params)
+  {
+    double d[MSDFGEN_BATCH_SIZE], dot[MSDFGEN_BATCH_SIZE];
+    store(d, distances);
+    store(dot, dots);
+    store(param, params);
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+      distance[i] = SignedDistance(d[i], dot[i]);
+  }
+
+  EdgeSegmentType edgeSegmentType(const EdgeSegment *edge)
+  {
+    if (dynamic_cast<const LinearSegment *>(edge))
+      return EDGE_SEGMENT_LINEAR;
+    if (dynamic_cast<const QuadraticSegment *>(edge))
+      return EDGE_SEGMENT_QUADRATIC;
+    return EDGE_SEGMENT_CUBIC;
+  }
+
+  template <class L>
+  static void signedDistanceLinearLanes(SignedDistance distance[MSDFGEN_BATCH_SIZE], double param[MSDFGEN_BATCH_SIZE], const PreparedShape &shape, int edgeIndex, const double originX[MSDFGEN_BATCH_SIZE], const double originY[MSDFGEN_BATCH_SIZE])
+  {
+    const Point2 &p0 = shape.p0[edgeIndex], &p1 = shape.p1[edgeIndex];
+    const Vector2 &ab = shape.ab[edgeIndex];
+    const Vector2 &orthonormal = shape.orthonormal[edgeIndex];
+    const Vector2 &abDir = shape.aDirNormalized[edgeIndex];
+
+    L ox = load<L>(originX), oy = load<L>(originY);
+    L aqx = ox - lanes<L>(p0.x), aqy = oy - lanes<L>(p0.y);
+    L t = (aqx * lanes<L>(ab.x) + aqy * lanes<L>(ab.y)) / lanes<L>(shape.abLengthSquared[edgeIndex]);
+
+    L farEnd = greater(t, lanes<L>(.5));
+    L eqx = select(farEnd, lanes<L>(p1.x), lanes<L>(p0.x)) - ox;
+    L eqy = select(farEnd, lanes<L>(p1.y), lanes<L>(p0.y)) - oy;
+    L endpointDistance = laneSqrt(eqx * eqx + eqy * eqy);
+
+    L orthoDistance = lanes<L>(orthonormal.x) * aqx + lanes<L>(orthonormal.y) * aqy;
+    L useOrtho = maskAnd(maskAnd(greater(t, lanes<L>(0)), less(t, lanes<L>(1))), less(laneAbs(orthoDistance), endpointDistance));
+
+    L endpointSignedDistance = applyNonZeroSign(aqx * lanes<L>(ab.y) - aqy * lanes<L>(ab.x), endpointDistance);
+    L endpointDot = absDotNormalized(abDir, eqx, eqy, endpointDistance);
+
+    storeSignedDistances(distance, param, select(useOrtho, orthoDistance, endpointSignedDistance), select(useOrtho, lanes<L>(0), endpointDot), t);
+  }
+
+  template <typename T>
+  static void signedDistanceQuadraticLanes(SignedDistance distance[MSDFGEN_BATCH_SIZE], double param[MSDFGEN_BATCH_SIZE], const PreparedShape &shape, int edgeIndex, const double originX[MSDFGEN_BATCH_SIZE], const double originY[MSDFGEN_BATCH_SIZE])
+  {
+    typedef DoubleLanes L;
+    const Point2 &p0 = shape.p0[edgeIndex], &p1 = shape.p1[edgeIndex], &p2 = shape.p2[edgeIndex];
+    const Vector2 &ab = shape.ab[edgeIndex];
+    const Vector2 &br = shape.br[edgeIndex];
+    double a = shape.quadraticA[edgeIndex];
+    double b = shape.quadraticB[edgeIndex];
+    const Vector2 &aDir = shape.aDir[edgeIndex];
+    const Vector2 &bDir = shape.bDir[edgeIndex];
+
+    L ox = load<L>(originX), oy = load<L>(originY);
+    L qax = lanes<L>(p0.x) - ox, qay = lanes<L>(p0.y) - oy;
+    L bqx = lanes<L>(p2.x) - ox, bqy = lanes<L>(p2.y) - oy;
+    L c = lanes<L>(2 * shape.abLengthSquared[edgeIndex]) + (qax * lanes<L>(br.x) + qay * lanes<L>(br.y));
+    L d = qax * lanes<L>(ab.x) + qay * lanes<L>(ab.y);
+
+    // Distance from A
+    L aDistance = laneSqrt(qax * qax + qay * qay);
+    L minDistance = applyNonZeroSign(lanes<L>(aDir.x) * qay - lanes<L>(aDir.y) * qax, aDistance);
+    L t = negate(qax * lanes<L>(aDir.x) + qay * lanes<L>(aDir.y)) / lanes<L>(shape.aDirLengthSquared[edgeIndex]);
+
+    // Distance from B
+    L bDistance = laneSqrt(bqx * bqx + bqy * bqy);
+    L closerToB = less(bDistance, laneAbs(minDistance));
+    minDistance = select(closerToB, applyNonZeroSign(lanes<L>(bDir.x) * bqy - lanes<L>(bDir.y) * bqx, bDistance), minDistance);
+    t = select(closerToB, ((ox - lanes<L>(p1.x)) * lanes<L>(bDir.x) + (oy - lanes<L>(p1.y)) * lanes<L>(bDir.y)) / lanes<L>(shape.bDirLengthSquared[edgeIndex]), t);
+
+    // The cubic solver branches too much to vectorize, so the interior candidates are resolved per point.
+    // Only the roots are found in the precision T, each of them is measured in double so it ties with the endpoints like in the scalar code.
+    const Vector2 &p21 = shape.p21[edgeIndex];
+    const Vector2 &p20 = shape.p20[edgeIndex];
+    double cs[MSDFGEN_BATCH_SIZE], ds[MSDFGEN_BATCH_SIZE], minDistances[MSDFGEN_BATCH_SIZE], params[MSDFGEN_BATCH_SIZE];
+    store(cs, c);
+    store(ds, d);
+    store(minDistances, minDistance);
+    store(params, t);
+    for (int i = 0; i < MSDFGEN_BATCH_SIZE; ++i)
+    {
+      T roots[3];
+      int solutions = solveCubic(roots, T(a), T(b), T(cs[i]), T(ds[i]));
+      for (int j = 0; j < solutions; ++j)
+      {
+        double root = roots[j];
+        if (root > 0 && root < 1)
+        {
+          double qex = p0.x + 2 * root * ab.x + root * root * br.x - originX[i];
+          double qey = p0.y + 2 * root * ab.y + root * root * br.y - originY[i];
+          double distance = sqrt(qex * qex + qey * qey);
+          if (distance <= fabs(minDistances[i]))
+          {
+            // direction(root)
+            double dirx = (1 - root) * ab.x + root * p21.x;
+            double diry = (1 - root) * ab.y + root * p21.y;
+            if (dirx == 0 && diry == 0)
+            {
+              dirx = p20.x;
+              diry = p20.y;
+            }
+            minDistances[i] = nonZeroSign(dirx * qey - diry * qex) * distance;
+            params[i] = root;
+          }
+        }
+      }
+    }
+    minDistance = load<L>(minDistances);
+    t = load<L>(params);
+
+    L inside = maskAnd(greaterEqual(t, lanes<L>(0)), lessEqual(t, lanes<L>(1)));
+    L dot = select(less(t, lanes<L>(.5)), absDotNormalized(shape.aDirNormalized[edgeIndex], qax, qay, aDistance), absDotNormalized(shape.bDirNormalized[edgeIndex], bqx, bqy, bDistance));
+    storeSignedDistances(distance, param, minDistance, select(inside, lanes<L>(0), dot), t);
+  }
+
+  /// The search for the closest interior point runs in the lanes S, everything else in double.
+  template <class S>
+  static void signedDistanceCubicLanes(SignedDistance distance[MSDFGEN_BATCH_SIZE], double param[MSDFGEN_BATCH_SIZE], const PreparedShape &shape, int edgeIndex, const double originX[MSDFGEN_BATCH_SIZE], const double originY[MSDFGEN_BATCH_SIZE])
+  {
+    typedef DoubleLanes L;
+    const Point2 &p0 = shape.p0[edgeIndex], &p3 = shape.p3[edgeIndex];
+    const Vector2 &ab = shape.ab[edgeIndex];
+    const Vector2 &br = shape.br[edgeIndex];
+    const Vector2 &as = shape.as[edgeIndex];
+    const Vector2 &p21 = shape.p21[edgeIndex];
+    const Vector2 &p32 = shape.p32[edgeIndex];
+    const Vector2 &aDir = shape.aDir[edgeIndex];
+    const Vector2 &bDir = shape.bDir[edgeIndex];
+
+    L ox = load<L>(originX), oy = load<L>(originY);
+    L qax = lanes<L>(p0.x) - ox, qay = lanes<L>(p0.y) - oy;
+    L bqx = lanes<L>(p3.x) - ox, bqy = lanes<L>(p3.y) - oy;
+
+    // Distance from A
+    L aDistance = laneSqrt(qax * qax + qay * qay);
+    L minDistance = applyNonZeroSign(lanes<L>(aDir.x) * qay - lanes<L>(aDir.y) * qax, aDistance);
+    L minParam = negate(qax * lanes<L>(aDir.x) + qay * lanes<L>(aDir.y)) / lanes<L>(shape.aDirLengthSquared[edgeIndex]);
+
+    // Distance from B
+    L bDistance = laneSqrt(bqx * bqx + bqy * bqy);
+    L closerToB = less(bDistance, laneAbs(minDistance));
+    minDistance = select(closerToB, applyNonZeroSign(lanes<L>(bDir.x) * bqy - lanes<L>(bDir.y) * bqx, bDistance), minDistance);
+    minParam = select(closerToB, ((lanes<L>(bDir.x) - bqx) * lanes<L>(bDir.x) + (lanes<L>(bDir.y) - bqy) * lanes<L>(bDir.y)) / lanes<L>(shape.bDirLengthSquared[edgeIndex]), minParam);
+
+    // Iterative minimum distance search, lanes drop out of a search start as soon as t leaves the edge.
+    // The closest interior point is tracked apart from the endpoints, which it has to beat strictly, so this picks the same point as the scalar code.
+    S sqax = lanes<S>(p0.x) - load<S>(originX), sqay = lanes<S>(p0.y) - load<S>(originY);
+    S bestDistance = lanes<S>(HUGE_VAL), bestParam = lanes<S>(0);
+    for (int i = 0; i <= MSDFGEN_CUBIC_SEARCH_STARTS; ++i)
+    {
+      double t0 = (double)i / MSDFGEN_CUBIC_SEARCH_STARTS;
+      S t = lanes<S>(t0);
+      S qex = ((sqax + lanes<S>(3 * t0 * ab.x)) + lanes<S>(3 * t0 * t0 * br.x)) + lanes<S>(t0 * t0 * t0 * as.x);
+      S qey = ((sqay + lanes<S>(3 * t0 * ab.y)) + lanes<S>(3 * t0 * t0 * br.y)) + lanes<S>(t0 * t0 * t0 * as.y);
+      S active = equal(t, t);
+      for (int step = 0; step < MSDFGEN_CUBIC_SEARCH_STEPS; ++step)
+      {
+        // Improve t
+        S d1x = ((lanes<S>(3 * as.x) * t) * t + lanes<S>(6 * br.x) * t) + lanes<S>(3 * ab.x);
+        S d1y = ((lanes<S>(3 * as.y) * t) * t + lanes<S>(6 * br.y) * t) + lanes<S>(3 * ab.y);
+        S d2x = lanes<S>(6 * as.x) * t + lanes<S>(6 * br.x);
+        S d2y = lanes<S>(6 * as.y) * t + lanes<S>(6 * br.y);
+        t = select(active, t - (qex * d1x + qey * d1y) / ((d1x * d1x + d1y * d1y) + (qex * d2x + qey * d2y)), t);
+        active = maskAndNot(active, maskOr(lessEqual(t, lanes<S>(0)), greaterEqual(t, lanes<S>(1))));
+        if (!anyLane(active))
+          break;
+
+        S t3 = lanes<S>(3) * t;
+        S ttt = (t * t) * t;
+        qex = ((sqax + t3 * lanes<S>(ab.x)) + (t3 * t) * lanes<S>(br.x)) + ttt * lanes<S>(as.x);
+        qey = ((sqay + t3 * lanes<S>(ab.y)) + (t3 * t) * lanes<S>(br.y)) + ttt * lanes<S>(as.y);
+        S qeDistance = laneSqrt(qex * qex + qey * qey);
+        S closer = maskAnd(active, less(qeDistance, bestDistance));
+        bestDistance = select(closer, qeDistance, bestDistance);
+        bestParam = select(closer, t, bestParam);
+      }
+    }
+
+    // Measures the closest interior point in double, which reproduces the search's own value when it ran in double
+    double bestDistances[MSDFGEN_BATCH_SIZE], bestParams[MSDFGEN_BATCH_SIZE];
+    store(bestDistances, bestDistance);
+    store(bestParams, bestParam);
+    L t = load<L>(bestParams);
+    L t3 = lanes<L>(3) * t;
+    L ttt = (t * t) * t;
+    L qex = ((qax + t3 * lanes<L>(ab.x)) + (t3 * t) * lanes<L>(br.x)) + ttt * lanes<L>(as.x);
+    L qey = ((qay + t3 * lanes<L>(ab.y)) + (t3 * t) * lanes<L>(br.y)) + ttt * lanes<L>(as.y);
+    L qeDistance = laneSqrt(qex * qex + qey * qey);
+    L closer = maskAnd(less(load<L>(bestDistances), lanes<L>(HUGE_VAL)), less(qeDistance, laneAbs(minDistance)));
+    if (anyLane(closer))
+    {
+      // direction(t)
+      L s = lanes<L>(1) - t;
+      L dirx = s * (s * lanes<L>(ab.x) + t * lanes<L>(p21.x)) + t * (s * lanes<L>(p21.x) + t * lanes<L>(p32.x));
+      L diry = s * (s * lanes<L>(ab.y) + t * lanes<L>(p21.y)) + t * (s * lanes<L>(p21.y) + t * lanes<L>(p32.y));
+      minDistance = select(closer, applyNonZeroSign(dirx * qey - diry * qex, qeDistance), minDistance);
+      minParam = select(closer, t, minParam);
+    }
+
+    L inside = maskAnd(greaterEqual(minParam, lanes<L>(0)), lessEqual(minParam, lanes<L>(1)));
+    L dot = select(less(minParam, lanes<L>(.5)), absDotNormalized(shape.aDirNormalized[edgeIndex], qax, qay, aDistance), absDotNormalized(shape.bDirNormalized[edgeIndex], bqx, bqy, bDistance));
+    storeSignedDistances(distance, param, minDistance, select(inside, lanes<L>(0), dot), minParam);
+  }
+
+  template <typename T>
+  struct BatchLanes;
+
+  template <>
+  struct BatchLanes<double>
+  {
+    typedef DoubleLanes Type;
+  };
+
+  template <>
+  struct BatchLanes<float>
+  {
+    typedef FloatLanes Type;
+  };
+
+  template <typename T>
+  void signedDistanceBatch(SignedDistance distance[MSDFGEN_BATCH_SIZE], double param[MSDFGEN_BATCH_SIZE], const PreparedShape &shape, int edgeIndex, const double originX[MSDFGEN_BATCH_SIZE], const double originY[MSDFGEN_BATCH_SIZE])
+  {
+    switch (shape.types[edgeIndex])
+    {
+    case EDGE_SEGMENT_LINEAR:
+      signedDistanceLinearLanes<DoubleLanes>(distance, param, shape, edgeIndex, originX, originY);
+      break;
+    case EDGE_SEGMENT_QUADRATIC:
+      signedDistanceQuadraticLanes<T>(distance, param, shape, edgeIndex, originX, originY);
+      break;
+    case EDGE_SEGMENT_CUBIC:
+      signedDistanceCubicLanes<typename BatchLanes<T>::Type>(distance, param, shape, edgeIndex, originX, originY);
+      break;
+    }
+  }
+
+  template void signedDistanceBatch<double>(SignedDistance distance[MSDFGEN_BATCH_SIZE], double param[MSDFGEN_BATCH_SIZE], const PreparedShape &shape, int edgeIndex, const double originX[MSDFGEN_BATCH_SIZE], const double originY[MSDFGEN_BATCH_SIZE]);
+  template void signedDistanceBatch<float>(SignedDistance distance[MSDFGEN_BATCH_SIZE], double param[MSDFGEN_BATCH_SIZE], const PreparedShape &shape, int edgeIndex, const double originX[MSDFGEN_BATCH_SIZE], const double originY[MSDFGEN_BATCH_SIZE]);
+
+} // namespace msdfgen
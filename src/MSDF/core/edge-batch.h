@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Vector2.h"
+#include "SignedDistance.h"
+#include "edge-segments.h"
+
+// Number of sample points evaluated together by the batched distance kernels.
+#define MSDFGEN_BATCH_SIZE 4
+
+namespace msdfgen {
+
+class PreparedShape;
+
+/// The concrete type of an edge segment, resolved once so batched kernels can be called without virtual dispatch.
+/// LinearSegment, QuadraticSegment and CubicSegment are the only subclasses of EdgeSegment.
+enum EdgeSegmentType {
+    EDGE_SEGMENT_LINEAR,
+    EDGE_SEGMENT_QUADRATIC,
+    EDGE_SEGMENT_CUBIC
+};
+
+/// Determines the concrete type of the edge segment.
+EdgeSegmentType edgeSegmentType(const EdgeSegment *edge);
+
+/// Computes the minimum signed distances between MSDFGEN_BATCH_SIZE origins and an edge of the prepared shape, in the precision T, which is double or float.
+/// In double precision, produces the same results as EdgeSegment::signedDistance. In single precision, only the roots of quadratic edges and the closest point search of cubic edges
+/// are carried out in float. The candidates they yield are measured in double, so the signs and the ties at shared vertices come out like in double precision.
+template <typename T>
+void signedDistanceBatch(SignedDistance distance[MSDFGEN_BATCH_SIZE], double param[MSDFGEN_BATCH_SIZE], const PreparedShape &shape, int edgeIndex, const double originX[MSDFGEN_BATCH_SIZE], const double originY[MSDFGEN_BATCH_SIZE]);
+
+}
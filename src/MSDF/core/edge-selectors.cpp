@@ -1,6 +1,7 @@
 
 #include "edge-selectors.h"
 
+#include "PreparedShape.h"
 #include "arithmetics.hpp"
 
 namespace msdfgen
@@ -8,6 +9,20 @@ namespace msdfgen
 
 #define DISTANCE_DELTA_FACTOR 1.001
 
+  EdgeEnds::EdgeEnds(const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge)
+      : a(edge->point(0)), b(edge->point(1)), aDir(edge->direction(0).normalize(true)), bDir(edge->direction(1).normalize(true))
+  {
+    Vector2 prevDir = prevEdge->direction(1).normalize(true);
+    Vector2 nextDir = nextEdge->direction(0).normalize(true);
+    aBisector = (prevDir + aDir).normalize(true);
+    bBisector = (bDir + nextDir).normalize(true);
+  }
+
+  EdgeEnds::EdgeEnds(const PreparedShape &shape, int edgeIndex)
+      : a(shape.pointA[edgeIndex]), b(shape.pointB[edgeIndex]), aDir(shape.aTangent[edgeIndex]), bDir(shape.bTangent[edgeIndex]), aBisector(shape.aBisector[edgeIndex]), bBisector(shape.bBisector[edgeIndex])
+  {
+  }
+
   TrueDistanceSelector::EdgeCache::EdgeCache()
       : absDistance(0)
   {
@@ -20,10 +35,15 @@ namespace msdfgen
     this->p = p;
   }
 
-  void TrueDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge)
+  bool TrueDistanceSelector::isEdgeRelevant(const EdgeCache &cache, EdgeColor) const
   {
     double delta = DISTANCE_DELTA_FACTOR * (p - cache.point).length();
-    if (cache.absDistance - delta <= fabs(minDistance.distance))
+    return cache.absDistance - delta <= fabs(minDistance.distance);
+  }
+
+  void TrueDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge)
+  {
+    if (isEdgeRelevant(cache, edge->color))
     {
       double dummy;
       SignedDistance distance = edge->signedDistance(p, dummy);
@@ -34,6 +54,14 @@ namespace msdfgen
     }
   }
 
+  void TrueDistanceSelector::addEdgeDistance(EdgeCache &cache, const PreparedShape &, int, const SignedDistance &distance, double)
+  {
+    if (distance < minDistance)
+      minDistance = distance;
+    cache.point = p;
+    cache.absDistance = fabs(distance.distance);
+  }
+
   void TrueDistanceSelector::merge(const TrueDistanceSelector &other)
   {
     if (other.minDistance < minDistance)
@@ -79,7 +107,7 @@ namespace msdfgen
     nearEdgeParam = 0;
   }
 
-  bool PseudoDistanceSelectorBase::isEdgeRelevant(const EdgeCache &cache, const EdgeSegment *edge, const Point2 &p) const
+  bool PseudoDistanceSelectorBase::isEdgeRelevant(const EdgeCache &cache, const Point2 &p) const
   {
     double delta = DISTANCE_DELTA_FACTOR * (p - cache.point).length();
     return (
@@ -147,41 +175,52 @@ namespace msdfgen
     this->p = p;
   }
 
+  bool PseudoDistanceSelector::isEdgeRelevant(const EdgeCache &cache, EdgeColor) const
+  {
+    return isEdgeRelevant(cache, p);
+  }
+
   void PseudoDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge)
   {
-    if (isEdgeRelevant(cache, edge, p))
+    if (isEdgeRelevant(cache, p))
     {
       double param;
       SignedDistance distance = edge->signedDistance(p, param);
-      addEdgeTrueDistance(edge, distance, param);
-      cache.point = p;
-      cache.absDistance = fabs(distance.distance);
+      addEdgeDistance(cache, edge, EdgeEnds(prevEdge, edge, nextEdge), distance, param);
+    }
+  }
 
-      Vector2 ap = p - edge->point(0);
-      Vector2 bp = p - edge->point(1);
-      Vector2 aDir = edge->direction(0).normalize(true);
-      Vector2 bDir = edge->direction(1).normalize(true);
-      Vector2 prevDir = prevEdge->direction(1).normalize(true);
-      Vector2 nextDir = nextEdge->direction(0).normalize(true);
-      double add = dotProduct(ap, (prevDir + aDir).normalize(true));
-      double bdd = -dotProduct(bp, (bDir + nextDir).normalize(true));
-      if (add > 0)
-      {
-        double pd = distance.distance;
-        if (getPseudoDistance(pd, ap, -aDir))
-          addEdgePseudoDistance(pd = -pd);
-        cache.aPseudoDistance = pd;
-      }
-      if (bdd > 0)
-      {
-        double pd = distance.distance;
-        if (getPseudoDistance(pd, bp, bDir))
-          addEdgePseudoDistance(pd);
-        cache.bPseudoDistance = pd;
-      }
-      cache.aDomainDistance = add;
-      cache.bDomainDistance = bdd;
+  void PseudoDistanceSelector::addEdgeDistance(EdgeCache &cache, const PreparedShape &shape, int edgeIndex, const SignedDistance &distance, double param)
+  {
+    addEdgeDistance(cache, shape.edges[edgeIndex], EdgeEnds(shape, edgeIndex), distance, param);
+  }
+
+  void PseudoDistanceSelector::addEdgeDistance(EdgeCache &cache, const EdgeSegment *edge, const EdgeEnds &ends, const SignedDistance &distance, double param)
+  {
+    addEdgeTrueDistance(edge, distance, param);
+    cache.point = p;
+    cache.absDistance = fabs(distance.distance);
+
+    Vector2 ap = p - ends.a;
+    Vector2 bp = p - ends.b;
+    double add = dotProduct(ap, ends.aBisector);
+    double bdd = -dotProduct(bp, ends.bBisector);
+    if (add > 0)
+    {
+      double pd = distance.distance;
+      if (getPseudoDistance(pd, ap, -ends.aDir))
+        addEdgePseudoDistance(pd = -pd);
+      cache.aPseudoDistance = pd;
     }
+    if (bdd > 0)
+    {
+      double pd = distance.distance;
+      if (getPseudoDistance(pd, bp, ends.bDir))
+        addEdgePseudoDistance(pd);
+      cache.bPseudoDistance = pd;
+    }
+    cache.aDomainDistance = add;
+    cache.bDomainDistance = bdd;
   }
 
   PseudoDistanceSelector::DistanceType PseudoDistanceSelector::distance() const
@@ -198,64 +237,75 @@ namespace msdfgen
     this->p = p;
   }
 
+  bool MultiDistanceSelector::isEdgeRelevant(const EdgeCache &cache, EdgeColor color) const
+  {
+    return (
+        (color & RED && r.isEdgeRelevant(cache, p)) ||
+        (color & GREEN && g.isEdgeRelevant(cache, p)) ||
+        (color & BLUE && b.isEdgeRelevant(cache, p)));
+  }
+
   void MultiDistanceSelector::addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge)
   {
-    if (
-        (edge->color & RED && r.isEdgeRelevant(cache, edge, p)) ||
-        (edge->color & GREEN && g.isEdgeRelevant(cache, edge, p)) ||
-        (edge->color & BLUE && b.isEdgeRelevant(cache, edge, p)))
+    if (isEdgeRelevant(cache, edge->color))
     {
       double param;
       SignedDistance distance = edge->signedDistance(p, param);
-      if (edge->color & RED)
-        r.addEdgeTrueDistance(edge, distance, param);
-      if (edge->color & GREEN)
-        g.addEdgeTrueDistance(edge, distance, param);
-      if (edge->color & BLUE)
-        b.addEdgeTrueDistance(edge, distance, param);
-      cache.point = p;
-      cache.absDistance = fabs(distance.distance);
+      addEdgeDistance(cache, edge, edge->color, EdgeEnds(prevEdge, edge, nextEdge), distance, param);
+    }
+  }
+
+  void MultiDistanceSelector::addEdgeDistance(EdgeCache &cache, const PreparedShape &shape, int edgeIndex, const SignedDistance &distance, double param)
+  {
+    addEdgeDistance(cache, shape.edges[edgeIndex], shape.colors[edgeIndex], EdgeEnds(shape, edgeIndex), distance, param);
+  }
+
+  void MultiDistanceSelector::addEdgeDistance(EdgeCache &cache, const EdgeSegment *edge, EdgeColor color, const EdgeEnds &ends, const SignedDistance &distance, double param)
+  {
+    if (color & RED)
+      r.addEdgeTrueDistance(edge, distance, param);
+    if (color & GREEN)
+      g.addEdgeTrueDistance(edge, distance, param);
+    if (color & BLUE)
+      b.addEdgeTrueDistance(edge, distance, param);
+    cache.point = p;
+    cache.absDistance = fabs(distance.distance);
 
-      Vector2 ap = p - edge->point(0);
-      Vector2 bp = p - edge->point(1);
-      Vector2 aDir = edge->direction(0).normalize(true);
-      Vector2 bDir = edge->direction(1).normalize(true);
-      Vector2 prevDir = prevEdge->direction(1).normalize(true);
-      Vector2 nextDir = nextEdge->direction(0).normalize(true);
-      double add = dotProduct(ap, (prevDir + aDir).normalize(true));
-      double bdd = -dotProduct(bp, (bDir + nextDir).normalize(true));
-      if (add > 0)
+    Vector2 ap = p - ends.a;
+    Vector2 bp = p - ends.b;
+    double add = dotProduct(ap, ends.aBisector);
+    double bdd = -dotProduct(bp, ends.bBisector);
+    if (add > 0)
+    {
+      double pd = distance.distance;
+      if (PseudoDistanceSelectorBase::getPseudoDistance(pd, ap, -ends.aDir))
       {
-        double pd = distance.distance;
-        if (PseudoDistanceSelectorBase::getPseudoDistance(pd, ap, -aDir))
-        {
-          pd = -pd;
-          if (edge->color & RED)
-            r.addEdgePseudoDistance(pd);
-          if (edge->color & GREEN)
-            g.addEdgePseudoDistance(pd);
-          if (edge->color & BLUE)
-            b.addEdgePseudoDistance(pd);
-        }
-        cache.aPseudoDistance = pd;
+        pd = -pd;
+        if (color & RED)
+          r.addEdgePseudoDistance(pd);
+        if (color & GREEN)
+          g.addEdgePseudoDistance(pd);
+        if (color & BLUE)
+          b.addEdgePseudoDistance(pd);
       }
-      if (bdd > 0)
+      cache.aPseudoDistance = pd;
+    }
+    if (bdd > 0)
+    {
+      double pd = distance.distance;
+      if (PseudoDistanceSelectorBase::getPseudoDistance(pd, bp, ends.bDir))
       {
-        double pd = distance.distance;
-        if (PseudoDistanceSelectorBase::getPseudoDistance(pd, bp, bDir))
-        {
-          if (edge->color & RED)
-            r.addEdgePseudoDistance(pd);
-          if (edge->color & GREEN)
-            g.addEdgePseudoDistance(pd);
-          if (edge->color & BLUE)
-            b.addEdgePseudoDistance(pd);
-        }
-        cache.bPseudoDistance = pd;
+        if (color & RED)
+          r.addEdgePseudoDistance(pd);
+        if (color & GREEN)
+          g.addEdgePseudoDistance(pd);
+        if (color & BLUE)
+          b.addEdgePseudoDistance(pd);
       }
-      cache.aDomainDistance = add;
-      cache.bDomainDistance = bdd;
+      cache.bPseudoDistance = pd;
     }
+    cache.aDomainDistance = add;
+    cache.bDomainDistance = bdd;
   }
 
   void MultiDistanceSelector::merge(const MultiDistanceSelector &other)
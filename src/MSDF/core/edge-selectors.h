@@ -7,6 +7,20 @@
 
 namespace msdfgen {
 
+class PreparedShape;
+
+/// The ends of an edge as the pseudo-distance selectors see them: its endpoints, its unit directions at them,
+/// and the unit bisectors of these and the adjacent directions of the neighboring edges, which bound the domains of the endpoints.
+struct EdgeEnds {
+    Point2 a, b;
+    Vector2 aDir, bDir;
+    Vector2 aBisector, bBisector;
+
+    EdgeEnds(const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge);
+    /// Reads the ends that the prepared shape has computed in advance.
+    EdgeEnds(const PreparedShape &shape, int edgeIndex);
+};
+
 struct MultiDistance {
     double r, g, b;
 };
@@ -28,7 +42,11 @@ public:
     };
 
     void reset(const Point2 &p);
+    /// Returns false if the cached distance of an edge of the given color proves it cannot affect the result at the current point.
+    bool isEdgeRelevant(const EdgeCache &cache, EdgeColor color) const;
     void addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge);
+    /// Adds an edge of the prepared shape whose signed distance from the current point has already been computed.
+    void addEdgeDistance(EdgeCache &cache, const PreparedShape &shape, int edgeIndex, const SignedDistance &distance, double param);
     void merge(const TrueDistanceSelector &other);
     DistanceType distance() const;
 
@@ -54,7 +72,7 @@ public:
 
     PseudoDistanceSelectorBase();
     void reset(double delta);
-    bool isEdgeRelevant(const EdgeCache &cache, const EdgeSegment *edge, const Point2 &p) const;
+    bool isEdgeRelevant(const EdgeCache &cache, const Point2 &p) const;
     void addEdgeTrueDistance(const EdgeSegment *edge, const SignedDistance &distance, double param);
     void addEdgePseudoDistance(double distance);
     void merge(const PseudoDistanceSelectorBase &other);
@@ -76,13 +94,21 @@ class PseudoDistanceSelector : public PseudoDistanceSelectorBase {
 public:
     typedef double DistanceType;
 
+    using PseudoDistanceSelectorBase::isEdgeRelevant;
+
     void reset(const Point2 &p);
+    /// Returns false if the cached distance of an edge of the given color proves it cannot affect the result at the current point.
+    bool isEdgeRelevant(const EdgeCache &cache, EdgeColor color) const;
     void addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge);
+    /// Adds an edge of the prepared shape whose signed distance from the current point has already been computed.
+    void addEdgeDistance(EdgeCache &cache, const PreparedShape &shape, int edgeIndex, const SignedDistance &distance, double param);
     DistanceType distance() const;
 
 private:
     Point2 p;
 
+    void addEdgeDistance(EdgeCache &cache, const EdgeSegment *edge, const EdgeEnds &ends, const SignedDistance &distance, double param);
+
 };
 
 /// Selects the nearest edge for each of the three channels by its pseudo-distance.
@@ -93,7 +119,11 @@ public:
     typedef PseudoDistanceSelectorBase::EdgeCache EdgeCache;
 
     void reset(const Point2 &p);
+    /// Returns false if the cached distance of an edge of the given color proves it cannot affect the result at the current point.
+    bool isEdgeRelevant(const EdgeCache &cache, EdgeColor color) const;
     void addEdge(EdgeCache &cache, const EdgeSegment *prevEdge, const EdgeSegment *edge, const EdgeSegment *nextEdge);
+    /// Adds an edge of the prepared shape whose signed distance from the current point has already been computed.
+    void addEdgeDistance(EdgeCache &cache, const PreparedShape &shape, int edgeIndex, const SignedDistance &distance, double param);
     void merge(const MultiDistanceSelector &other);
     DistanceType distance() const;
     SignedDistance trueDistance() const;
@@ -102,6 +132,8 @@ private:
     Point2 p;
     PseudoDistanceSelectorBase r, g, b;
 
+    void addEdgeDistance(EdgeCache &cache, const EdgeSegment *edge, EdgeColor color, const EdgeEnds &ends, const SignedDistance &distance, double param);
+
 };
 
 /// Selects the nearest edge for each of the three color channels by its pseudo-distance and by true distance for the alpha channel.
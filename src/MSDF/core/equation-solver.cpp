@@ -1,21 +1,50 @@
-
 #include "equation-solver.h"
 
 #define _USE_MATH_DEFINES
 #include <cmath>
 
-#define TOO_LARGE_RATIO 1e12
-
 namespace msdfgen
 {
 
-  int solveQuadratic(double x[2], double a, double b, double c)
+  /// Thresholds of the solvers, scaled to the precision of the floating point type.
+  template <typename T>
+  struct SolverLimits;
+
+  template <>
+  struct SolverLimits<double>
+  {
+    static double tooLargeRatio()
+    {
+      return 1e12;
+    }
+    static double zeroImaginary()
+    {
+      return 1e-14;
+    }
+  };
+
+  template <>
+  struct SolverLimits<float>
+  {
+    static float tooLargeRatio()
+    {
+      return 1e6f;
+    }
+    static float zeroImaginary()
+    {
+      return 1e-6f;
+    }
+  };
+
+  template <typename T>
+  static int solveQuadraticT(T x[2], T a, T b, T c)
   {
+    const T tooLargeRatio = SolverLimits<T>::tooLargeRatio();
     // a = 0 -> linear equation
-    if (a == 0 || fabs(b) + fabs(c) > TOO_LARGE_RATIO * fabs(a))
+    if (a == 0 || std::fabs(b) + std::fabs(c) > tooLargeRatio * std::fabs(a))
     {
       // a, b = 0 -> no solution
-      if (b == 0 || fabs(c) > TOO_LARGE_RATIO * fabs(b))
+      if (b == 0 || std::fabs(c) > tooLargeRatio * std::fabs(b))
       {
         if (c == 0)
           return -1; // 0 = 0
@@ -24,10 +53,10 @@ namespace msdfgen
       x[0] = -c / b;
       return 1;
     }
-    double dscr = b * b - 4 * a * c;
+    T dscr = b * b - 4 * a * c;
     if (dscr > 0)
     {
-      dscr = sqrt(dscr);
+      dscr = std::sqrt(dscr);
       x[0] = (-b + dscr) / (2 * a);
       x[1] = (-b - dscr) / (2 * a);
       return 2;
@@ -41,55 +70,78 @@ namespace msdfgen
       return 0;
   }
 
-  static int solveCubicNormed(double x[3], double a, double b, double c)
+  template <typename T>
+  static int solveCubicNormed(T x[3], T a, T b, T c)
   {
-    double a2 = a * a;
-    double q = (a2 - 3 * b) / 9;
-    double r = (a * (2 * a2 - 9 * b) + 27 * c) / 54;
-    double r2 = r * r;
-    double q3 = q * q * q;
-    double A, B;
+    T a2 = a * a;
+    T q = (a2 - 3 * b) / 9;
+    T r = (a * (2 * a2 - 9 * b) + 27 * c) / 54;
+    T r2 = r * r;
+    T q3 = q * q * q;
+    T A, B;
     if (r2 < q3)
     {
-      double t = r / sqrt(q3);
+      T t = r / std::sqrt(q3);
       if (t < -1)
         t = -1;
       if (t > 1)
         t = 1;
-      t = acos(t);
+      t = std::acos(t);
       a /= 3;
-      q = -2 * sqrt(q);
-      x[0] = q * cos(t / 3) - a;
-      x[1] = q * cos((t + 2 * M_PI) / 3) - a;
-      x[2] = q * cos((t - 2 * M_PI) / 3) - a;
+      q = -2 * std::sqrt(q);
+      x[0] = q * std::cos(t / 3) - a;
+      x[1] = q * std::cos((t + T(2 * M_PI)) / 3) - a;
+      x[2] = q * std::cos((t - T(2 * M_PI)) / 3) - a;
       return 3;
     }
     else
     {
-      A = -pow(fabs(r) + sqrt(r2 - q3), 1 / 3.);
+      A = -std::pow(std::fabs(r) + std::sqrt(r2 - q3), T(1 / 3.));
       if (r < 0)
         A = -A;
       B = A == 0 ? 0 : q / A;
       a /= 3;
       x[0] = (A + B) - a;
-      x[1] = -0.5 * (A + B) - a;
-      x[2] = 0.5 * sqrt(3.) * (A - B);
-      if (fabs(x[2]) < 1e-14)
+      x[1] = T(-0.5) * (A + B) - a;
+      x[2] = T(0.5 * sqrt(3.)) * (A - B);
+      if (std::fabs(x[2]) < SolverLimits<T>::zeroImaginary())
         return 2;
       return 1;
     }
   }
 
-  int solveCubic(double x[3], double a, double b, double c, double d)
+  template <typename T>
+  static int solveCubicT(T x[3], T a, T b, T c, T d)
   {
     if (a != 0)
     {
-      double bn = b / a, cn = c / a, dn = d / a;
+      T bn = b / a, cn = c / a, dn = d / a;
       // Check that a isn't "almost zero"
-      if (fabs(bn) < TOO_LARGE_RATIO && fabs(cn) < TOO_LARGE_RATIO && fabs(dn) < TOO_LARGE_RATIO)
+      const T tooLargeRatio = SolverLimits<T>::tooLargeRatio();
+      if (std::fabs(bn) < tooLargeRatio && std::fabs(cn) < tooLargeRatio && std::fabs(dn) < tooLargeRatio)
         return solveCubicNormed(x, bn, cn, dn);
     }
-    return solveQuadratic(x, b, c, d);
+    return solveQuadraticT(x, b, c, d);
+  }
+
+  int solveQuadratic(double x[2], double a, double b, double c)
+  {
+    return solveQuadraticT(x, a, b, c);
+  }
+
+  int solveQuadratic(float x[2], float a, float b, float c)
+  {
+    return solveQuadraticT(x, a, b, c);
+  }
+
+  int solveCubic(double x[3], double a, double b, double c, double d)
+  {
+    return solveCubicT(x, a, b, c, d);
+  }
+
+  int solveCubic(float x[3], float a, float b, float c, float d)
+  {
+    return solveCubicT(x, a, b, c, d);
   }
 
 } // namespace msdfgen
@@ -5,8 +5,10 @@ namespace msdfgen {
 
 // ax^2 + bx + c = 0
 int solveQuadratic(double x[2], double a, double b, double c);
+int solveQuadratic(float x[2], float a, float b, float c);
 
 // ax^3 + bx^2 + cx + d = 0
 int solveCubic(double x[3], double a, double b, double c, double d);
+int solveCubic(float x[3], float a, float b, float c, float d);
 
 }
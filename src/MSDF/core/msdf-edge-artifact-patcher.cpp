@@ -7,9 +7,9 @@
 #include "contour-combiners.h"
 #include "edge-selectors.h"
 #include "equation-solver.h"
+#include "working-storage.h"
 #include <cstring>
 #include <utility>
-#include <vector>
 
 namespace msdfgen
 {
@@ -76,8 +76,9 @@ namespace msdfgen
     return found;
   }
 
+  /// Finds the hotspots in output pixel coordinates, where the sdf's first pixel lies at offsetX, offsetY
   template <int N>
-  void findHotspots(std::vector<Point2> &hotspots, const BitmapConstRef<float, N> &sdf)
+  void findHotspots(WorkingVector<Point2> &hotspots, const BitmapConstRef<float, N> &sdf, int offsetX, int offsetY)
   {
     // All hotspots intersect either the horizontal, vertical, or diagonal line that connects neighboring texels
     // Horizontal:
@@ -90,7 +91,7 @@ namespace msdfgen
         double t[3];
         int found = findLinearHotspots(t, left, right);
         for (int i = 0; i < found; ++i)
-          hotspots.push_back(Point2(x + .5 + t[i], y + .5));
+          hotspots.push_back(Point2(offsetX + x + .5 + t[i], offsetY + y + .5));
         left += N, right += N;
       }
     }
@@ -104,7 +105,7 @@ namespace msdfgen
         double t[3];
         int found = findLinearHotspots(t, bottom, top);
         for (int i = 0; i < found; ++i)
-          hotspots.push_back(Point2(x + .5, y + .5 + t[i]));
+          hotspots.push_back(Point2(offsetX + x + .5, offsetY + y + .5 + t[i]));
         bottom += N, top += N;
       }
     }
@@ -121,51 +122,57 @@ namespace msdfgen
         int found = 0;
         found = findDiagonalHotspots(t, lb, rb, lt, rt);
         for (int i = 0; i < found; ++i)
-          hotspots.push_back(Point2(x + .5 + t[i], y + .5 + t[i]));
+          hotspots.push_back(Point2(offsetX + x + .5 + t[i], offsetY + y + .5 + t[i]));
         found = findDiagonalHotspots(t, lt, rt, lb, rb);
         for (int i = 0; i < found; ++i)
-          hotspots.push_back(Point2(x + .5 + t[i], y + 1.5 - t[i]));
+          hotspots.push_back(Point2(offsetX + x + .5 + t[i], offsetY + y + 1.5 - t[i]));
         lb += N, rb += N, lt += N, rt += N;
       }
     }
   }
 
   template <template <typename> class ContourCombiner, int N>
-  static void msdfPatchEdgeArtifactsInner(const BitmapRef<float, N> &sdf, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate)
+  static void msdfPatchEdgeArtifactsInner(const BitmapRef<float, N> &sdf, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, int regionX, int regionY, int outputHeight)
   {
-    ShapeDistanceFinder<ContourCombiner<PseudoDistanceSelector>> distanceFinder(shape);
-    std::vector<Point2> hotspots;
-    findHotspots(hotspots, BitmapConstRef<float, N>(sdf));
-    std::vector<std::pair<int, int>> artifacts;
+    // Kept by the thread for its later calls
+    static thread_local ShapeDistanceFinder<ContourCombiner<PseudoDistanceSelector>> distanceFinder;
+    static thread_local WorkingVector<Point2> hotspots;
+    static thread_local WorkingVector<std::pair<int, int>> artifacts;
+    distanceFinder.setShape(shape);
+    hotspots.clear();
+    findHotspots(hotspots, BitmapConstRef<float, N>(sdf), regionX, regionY);
+    artifacts.clear();
     artifacts.reserve(hotspots.size());
-    for (std::vector<Point2>::const_iterator hotspot = hotspots.begin(); hotspot != hotspots.end(); ++hotspot)
+    for (WorkingVector<Point2>::const_iterator hotspot = hotspots.begin(); hotspot != hotspots.end(); ++hotspot)
     {
-      Point2 pos = *hotspot / scale - translate;
+      // Rows of the output run opposite to the shape's Y axis if it is inverted
+      Point2 pos = Point2(hotspot->x, shape.inverseYAxis ? outputHeight - hotspot->y : hotspot->y) / scale - translate;
+      Point2 local = *hotspot - Vector2(regionX, regionY);
       double actualDistance = distanceFinder.distance(pos);
       float sd = float(actualDistance / range + .5);
 
       // Store hotspot's closest texel's current color
-      float *subject = sdf((int)hotspot->x, (int)hotspot->y);
+      float *subject = sdf((int)local.x, (int)local.y);
       float texel[N];
       memcpy(texel, subject, N * sizeof(float));
       // Sample signed distance at hotspot
       float msd[N];
-      interpolate(msd, BitmapConstRef<float, N>(sdf), *hotspot);
+      interpolate(msd, BitmapConstRef<float, N>(sdf), local);
       float oldSsd = median(msd[0], msd[1], msd[2]);
       // Flatten hotspot's closest texel
       float med = median(subject[0], subject[1], subject[2]);
       subject[0] = med, subject[1] = med, subject[2] = med;
       // Sample signed distance at hotspot after flattening
-      interpolate(msd, BitmapConstRef<float, N>(sdf), *hotspot);
+      interpolate(msd, BitmapConstRef<float, N>(sdf), local);
       float newSsd = median(msd[0], msd[1], msd[2]);
       // Revert modified texel
       memcpy(subject, texel, N * sizeof(float));
 
       // Consider hotspot an artifact if flattening improved the sample
       if (fabsf(newSsd - sd) < fabsf(oldSsd - sd))
-        artifacts.push_back(std::make_pair((int)hotspot->x, (int)hotspot->y));
+        artifacts.push_back(std::make_pair((int)local.x, (int)local.y));
     }
-    for (std::vector<std::pair<int, int>>::const_iterator artifact = artifacts.begin(); artifact != artifacts.end(); ++artifact)
+    for (WorkingVector<std::pair<int, int>>::const_iterator artifact = artifacts.begin(); artifact != artifacts.end(); ++artifact)
     {
       float *pixel = sdf(artifact->first, artifact->second);
       float med = median(pixel[0], pixel[1], pixel[2]);
@@ -174,19 +181,29 @@ namespace msdfgen
   }
 
   void msdfPatchEdgeArtifacts(const BitmapRef<float, 3> &sdf, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport)
+  {
+    msdfPatchEdgeArtifacts(sdf, shape, range, scale, translate, overlapSupport, 0, 0, sdf.height);
+  }
+
+  void msdfPatchEdgeArtifacts(const BitmapRef<float, 4> &sdf, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport)
+  {
+    msdfPatchEdgeArtifacts(sdf, shape, range, scale, translate, overlapSupport, 0, 0, sdf.height);
+  }
+
+  void msdfPatchEdgeArtifacts(const BitmapRef<float, 3> &sdf, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport, int regionX, int regionY, int outputHeight)
   {
     if (overlapSupport)
-      msdfPatchEdgeArtifactsInner<OverlappingContourCombiner>(sdf, shape, range, scale, translate);
+      msdfPatchEdgeArtifactsInner<OverlappingContourCombiner>(sdf, shape, range, scale, translate, regionX, regionY, outputHeight);
     else
-      msdfPatchEdgeArtifactsInner<SimpleContourCombiner>(sdf, shape, range, scale, translate);
+      msdfPatchEdgeArtifactsInner<SimpleContourCombiner>(sdf, shape, range, scale, translate, regionX, regionY, outputHeight);
   }
 
-  void msdfPatchEdgeArtifacts(const BitmapRef<float, 4> &sdf, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport)
+  void msdfPatchEdgeArtifacts(const BitmapRef<float, 4> &sdf, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport, int regionX, int regionY, int outputHeight)
   {
     if (overlapSupport)
-      msdfPatchEdgeArtifactsInner<OverlappingContourCombiner>(sdf, shape, range, scale, translate);
+      msdfPatchEdgeArtifactsInner<OverlappingContourCombiner>(sdf, shape, range, scale, translate, regionX, regionY, outputHeight);
     else
-      msdfPatchEdgeArtifactsInner<SimpleContourCombiner>(sdf, shape, range, scale, translate);
+      msdfPatchEdgeArtifactsInner<SimpleContourCombiner>(sdf, shape, range, scale, translate, regionX, regionY, outputHeight);
   }
 
 } // namespace msdfgen
@@ -2,7 +2,9 @@
 #include "msdf-error-correction.h"
 
 #include "arithmetics.hpp"
-#include <vector>
+#include "working-storage.h"
+#include <algorithm>
+#include <cstdint>
 
 namespace msdfgen
 {
@@ -33,45 +35,125 @@ namespace msdfgen
            fabsf(a2 - .5f) >= fabsf(b2 - .5f); // Out of the pair, only flag the pixel farther from a shape edge
   }
 
+  /// One clash flag per pixel. Every row starts at a new word, so separate rows can be flagged in parallel.
+  class ClashMask
+  {
+  public:
+    ClashMask() : rowWords(0)
+    {
+    }
+
+    /// Sizes the mask for a bitmap and clears it, keeping the storage of previous sizes
+    void reset(int width, int height)
+    {
+      rowWords = (width + 63) >> 6;
+      bits.assign(size_t(rowWords) * height, uint64_t(0));
+    }
+
+    inline uint64_t *row(int y)
+    {
+      return &bits[size_t(y) * rowWords];
+    }
+
+    inline void clear()
+    {
+      std::fill(bits.begin(), bits.end(), uint64_t(0));
+    }
+
+    int rowWords;
+
+  private:
+    WorkingVector<uint64_t> bits;
+  };
+
+  inline static void flagClash(uint64_t *flags, int x)
+  {
+    flags[x >> 6] |= uint64_t(1) << (x & 63);
+  }
+
+  /// Flags the pixels of a row which clash with their horizontal or vertical neighbors. above and below are NULL at the bitmap border.
   template <int N>
-  void msdfErrorCorrectionInner(const BitmapRef<float, N> &output, const Vector2 &threshold)
+  static void flagOrthogonalClashes(uint64_t *flags, const float *above, const float *row, const float *below, int w, const Vector2 &threshold)
   {
-    std::vector<std::pair<int, int>> clashes;
-    int w = output.width, h = output.height;
-    for (int y = 0; y < h; ++y)
-      for (int x = 0; x < w; ++x)
+    for (int x = 0; x < w; ++x)
+    {
+      const float *pixel = row + N * x;
+      if (
+          (x > 0 && detectClash(pixel, pixel - N, threshold.x)) ||
+          (x < w - 1 && detectClash(pixel, pixel + N, threshold.x)) ||
+          (above && detectClash(pixel, above + N * x, threshold.y)) ||
+          (below && detectClash(pixel, below + N * x, threshold.y)))
+        flagClash(flags, x);
+    }
+  }
+
+  /// Flags the pixels of a row which clash with their diagonal neighbors. above and below are NULL at the bitmap border.
+  template <int N>
+  static void flagDiagonalClashes(uint64_t *flags, const float *above, const float *row, const float *below, int w, double threshold)
+  {
+    for (int x = 0; x < w; ++x)
+    {
+      const float *pixel = row + N * x;
+      if (
+          (x > 0 && above && detectClash(pixel, above + N * (x - 1), threshold)) ||
+          (x < w - 1 && above && detectClash(pixel, above + N * (x + 1), threshold)) ||
+          (x > 0 && below && detectClash(pixel, below + N * (x - 1), threshold)) ||
+          (x < w - 1 && below && detectClash(pixel, below + N * (x + 1), threshold)))
+        flagClash(flags, x);
+    }
+  }
+
+  /// Sets all three color channels of the flagged pixels of a row to their median.
+  template <int N>
+  static void equalizeClashes(const uint64_t *flags, float *row, int rowWords)
+  {
+    for (int word = 0; word < rowWords; ++word)
+    {
+      int x = word << 6;
+      for (uint64_t bits = flags[word]; bits; bits >>= 1, ++x)
       {
-        if (
-            (x > 0 && detectClash(output(x, y), output(x - 1, y), threshold.x)) ||
-            (x < w - 1 && detectClash(output(x, y), output(x + 1, y), threshold.x)) ||
-            (y > 0 && detectClash(output(x, y), output(x, y - 1), threshold.y)) ||
-            (y < h - 1 && detectClash(output(x, y), output(x, y + 1), threshold.y)))
-          clashes.push_back(std::make_pair(x, y));
+        if (bits & 1)
+        {
+          float *pixel = row + N * x;
+          float med = median(pixel[0], pixel[1], pixel[2]);
+          pixel[0] = med, pixel[1] = med, pixel[2] = med;
+        }
       }
-    for (std::vector<std::pair<int, int>>::const_iterator clash = clashes.begin(); clash != clashes.end(); ++clash)
-    {
-      float *pixel = output(clash->first, clash->second);
-      float med = median(pixel[0], pixel[1], pixel[2]);
-      pixel[0] = med, pixel[1] = med, pixel[2] = med;
     }
+  }
+
+  template <int N>
+  void msdfErrorCorrectionInner(const BitmapRef<float, N> &output, const Vector2 &threshold)
+  {
+    // Clashes are detected on the unmodified bitmap, so all rows are flagged before any is equalized.
+    // Each thread takes a contiguous band of rows and only reads the rows directly above and below.
+    int w = output.width, h = output.height;
+    // The mask is kept by the calling thread, the threads of the parallel loops only reach it through the reference
+    static thread_local ClashMask callerClashes;
+    ClashMask &clashes = callerClashes;
+    clashes.reset(w, h);
+#ifdef MSDFGEN_USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int y = 0; y < h; ++y)
+      flagOrthogonalClashes<N>(clashes.row(y), y > 0 ? output(0, y - 1) : NULL, output(0, y), y < h - 1 ? output(0, y + 1) : NULL, w, threshold);
+#ifdef MSDFGEN_USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int y = 0; y < h; ++y)
+      equalizeClashes<N>(clashes.row(y), output(0, y), clashes.rowWords);
 #ifndef MSDFGEN_NO_DIAGONAL_CLASH_DETECTION
     clashes.clear();
+#ifdef MSDFGEN_USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
     for (int y = 0; y < h; ++y)
-      for (int x = 0; x < w; ++x)
-      {
-        if (
-            (x > 0 && y > 0 && detectClash(output(x, y), output(x - 1, y - 1), threshold.x + threshold.y)) ||
-            (x < w - 1 && y > 0 && detectClash(output(x, y), output(x + 1, y - 1), threshold.x + threshold.y)) ||
-            (x > 0 && y < h - 1 && detectClash(output(x, y), output(x - 1, y + 1), threshold.x + threshold.y)) ||
-            (x < w - 1 && y < h - 1 && detectClash(output(x, y), output(x + 1, y + 1), threshold.x + threshold.y)))
-          clashes.push_back(std::make_pair(x, y));
-      }
-    for (std::vector<std::pair<int, int>>::const_iterator clash = clashes.begin(); clash != clashes.end(); ++clash)
-    {
-      float *pixel = output(clash->first, clash->second);
-      float med = median(pixel[0], pixel[1], pixel[2]);
-      pixel[0] = med, pixel[1] = med, pixel[2] = med;
-    }
+      flagDiagonalClashes<N>(clashes.row(y), y > 0 ? output(0, y - 1) : NULL, output(0, y), y < h - 1 ? output(0, y + 1) : NULL, w, threshold.x + threshold.y);
+#ifdef MSDFGEN_USE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int y = 0; y < h; ++y)
+      equalizeClashes<N>(clashes.row(y), output(0, y), clashes.rowWords);
 #endif
   }
 
@@ -1,12 +1,20 @@
 
 #include "../msdfgen.h"
 
+#include "PreparedShape.h"
 #include "ShapeDistanceFinder.h"
+#include "ShapeEdgeGrid.h"
 #include "contour-combiners.h"
 #include "edge-selectors.h"
 #include "msdf-edge-artifact-patcher.h"
 #include <vector>
 
+// Width and height of the blocks of output pixels that are each evaluated by a distance finder without the history of previous blocks,
+// so that the samples of a pixel do not depend on which region of the output it is generated in. A multiple of MSDFGEN_BATCH_SIZE and MSDFGEN_EDGE_GRID_CELL_SIZE.
+#ifndef MSDFGEN_GENERATOR_BLOCK_SIZE
+#define MSDFGEN_GENERATOR_BLOCK_SIZE 16
+#endif
+
 namespace msdfgen
 {
 
@@ -51,71 +59,203 @@ namespace msdfgen
     }
   };
 
-  template <class ContourCombiner>
-  void generateDistanceField(const typename DistancePixelConversion<typename ContourCombiner::DistanceType>::BitmapRefType &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate)
+  /// Generates the distance field, whose sample indices are offset by offsetX, offsetY so that it can hold a region of a larger output with identical samples.
+  /// The offsets must not be negative.
+  template <class ContourCombiner, typename Precision>
+  void generateDistanceField(const typename DistancePixelConversion<typename ContourCombiner::DistanceType>::BitmapRefType &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport, int offsetX, int offsetY)
   {
+    // The edge coefficients are computed once and shared by all threads. Like all working storage, they are kept by the calling thread for its later calls,
+    // and the parallel region below only reaches them through these references, as each of its threads has thread_local instances of its own.
+    static thread_local PreparedShape callerPreparedShape;
+    static thread_local ShapeEdgeGrid callerEdgeGrid;
+    PreparedShape &preparedShape = callerPreparedShape;
+    ShapeEdgeGrid &edgeGrid = callerEdgeGrid;
+    preparedShape.setShape(shape);
+
+    // Blocks are aligned to the whole output rather than to the region, and the ones at its borders are evaluated whole, their samples outside of it discarded
+    const int blockSize = MSDFGEN_GENERATOR_BLOCK_SIZE;
+    int firstBlockX = offsetX / blockSize, firstBlockY = offsetY / blockSize;
+    int blockColumns = (offsetX + output.width + blockSize - 1) / blockSize - firstBlockX;
+    int blockRows = (offsetY + output.height + blockSize - 1) / blockSize - firstBlockY;
+
+    // Shapes with many edges get a grid of output pixel blocks, which lets the distance finder skip the edges that cannot be nearest within a block.
+    // It covers the whole blocks, so its cells fall on the same pixels of the output whatever the region.
+    bool useEdgeGrid = preparedShape.edgeCount() >= MSDFGEN_EDGE_GRID_MIN_EDGES;
+    if (useEdgeGrid)
+    {
+      int gridX = firstBlockX * blockSize, gridY = firstBlockY * blockSize;
+      int columns = blockColumns * blockSize / MSDFGEN_EDGE_GRID_CELL_SIZE;
+      int rows = blockRows * blockSize / MSDFGEN_EDGE_GRID_CELL_SIZE;
+      edgeGrid.setShape(preparedShape, Point2(gridX / scale.x - translate.x, gridY / scale.y - translate.y), Vector2(MSDFGEN_EDGE_GRID_CELL_SIZE / scale.x, MSDFGEN_EDGE_GRID_CELL_SIZE / scale.y), columns, rows, overlapSupport);
+    }
+
+    int blockCount = blockColumns * blockRows;
 #ifdef MSDFGEN_USE_OPENMP
 #pragma omp parallel
 #endif
     {
-      ShapeDistanceFinder<ContourCombiner> distanceFinder(shape);
-      bool rightToLeft = false;
-      Point2 p;
+      static thread_local BatchShapeDistanceFinder<ContourCombiner, Precision> distanceFinder;
+      distanceFinder.setShape(preparedShape, useEdgeGrid ? &edgeGrid : NULL);
+      const int stripWidth = blockSize / MSDFGEN_BATCH_SIZE;
+      Point2 p[MSDFGEN_BATCH_SIZE];
+      typename ContourCombiner::DistanceType distances[MSDFGEN_BATCH_SIZE];
 #ifdef MSDFGEN_USE_OPENMP
 #pragma omp for
 #endif
-      for (int y = 0; y < output.height; ++y)
+      for (int block = 0; block < blockCount; ++block)
       {
-        int row = shape.inverseYAxis ? output.height - y - 1 : y;
-        p.y = (y + .5) / scale.y - translate.y;
-        for (int col = 0; col < output.width; ++col)
+        int blockX = (firstBlockX + block % blockColumns) * blockSize;
+        int blockY = (firstBlockY + block / blockColumns) * blockSize;
+        distanceFinder.reset();
+        // Each lane of the batch walks its own vertical strip of the block, back and forth, so consecutive queries of a lane stay close together
+        for (int blockRow = 0; blockRow < blockSize; ++blockRow)
         {
-          int x = rightToLeft ? output.width - col - 1 : col;
-          p.x = (x + .5) / scale.x - translate.x;
-          typename ContourCombiner::DistanceType distance = distanceFinder.distance(p);
-          DistancePixelConversion<typename ContourCombiner::DistanceType>::convert(output(x, row), distance, range);
+          int y = blockY + blockRow - offsetY;
+          for (int lane = 0; lane < MSDFGEN_BATCH_SIZE; ++lane)
+            p[lane].y = (blockY + blockRow + .5) / scale.y - translate.y;
+          for (int col = 0; col < stripWidth; ++col)
+          {
+            int stripX = blockRow % 2 ? stripWidth - col - 1 : col;
+            for (int lane = 0; lane < MSDFGEN_BATCH_SIZE; ++lane)
+              p[lane].x = (blockX + lane * stripWidth + stripX + .5) / scale.x - translate.x;
+            distanceFinder.distance(distances, p);
+            if (y < 0 || y >= output.height)
+              continue;
+            int row = shape.inverseYAxis ? output.height - y - 1 : y;
+            for (int lane = 0; lane < MSDFGEN_BATCH_SIZE; ++lane)
+            {
+              int x = blockX + lane * stripWidth + stripX - offsetX;
+              if (x >= 0 && x < output.width)
+                DistancePixelConversion<typename ContourCombiner::DistanceType>::convert(output(x, row), distances[lane], range);
+            }
+          }
         }
-        rightToLeft = !rightToLeft;
       }
     }
   }
 
-  void generateSDF(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport)
+  template <class EdgeSelector>
+  void generateDistanceField(const typename DistancePixelConversion<typename EdgeSelector::DistanceType>::BitmapRefType &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport, GeneratorPrecision precision, int offsetX, int offsetY)
   {
     if (overlapSupport)
-      generateDistanceField<OverlappingContourCombiner<TrueDistanceSelector>>(output, shape, range, scale, translate);
+    {
+      if (precision == PRECISION_FLOAT)
+        generateDistanceField<OverlappingContourCombiner<EdgeSelector>, float>(output, shape, range, scale, translate, true, offsetX, offsetY);
+      else
+        generateDistanceField<OverlappingContourCombiner<EdgeSelector>, double>(output, shape, range, scale, translate, true, offsetX, offsetY);
+    }
     else
-      generateDistanceField<SimpleContourCombiner<TrueDistanceSelector>>(output, shape, range, scale, translate);
+    {
+      if (precision == PRECISION_FLOAT)
+        generateDistanceField<SimpleContourCombiner<EdgeSelector>, float>(output, shape, range, scale, translate, false, offsetX, offsetY);
+      else
+        generateDistanceField<SimpleContourCombiner<EdgeSelector>, double>(output, shape, range, scale, translate, false, offsetX, offsetY);
+    }
   }
 
-  void generatePseudoSDF(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport)
+  void generateSDF(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport, GeneratorPrecision precision)
   {
-    if (overlapSupport)
-      generateDistanceField<OverlappingContourCombiner<PseudoDistanceSelector>>(output, shape, range, scale, translate);
-    else
-      generateDistanceField<SimpleContourCombiner<PseudoDistanceSelector>>(output, shape, range, scale, translate);
+    generateDistanceField<TrueDistanceSelector>(output, shape, range, scale, translate, overlapSupport, precision, 0, 0);
   }
 
-  void generateMSDF(const BitmapRef<float, 3> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool overlapSupport)
+  void generatePseudoSDF(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport, GeneratorPrecision precision)
   {
-    if (overlapSupport)
-      generateDistanceField<OverlappingContourCombiner<MultiDistanceSelector>>(output, shape, range, scale, translate);
-    else
-      generateDistanceField<SimpleContourCombiner<MultiDistanceSelector>>(output, shape, range, scale, translate);
+    generateDistanceField<PseudoDistanceSelector>(output, shape, range, scale, translate, overlapSupport, precision, 0, 0);
+  }
+
+  void generateMSDF(const BitmapRef<float, 3> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool overlapSupport, GeneratorPrecision precision)
+  {
+    generateDistanceField<MultiDistanceSelector>(output, shape, range, scale, translate, overlapSupport, precision, 0, 0);
     if (edgeThreshold > 0)
       msdfErrorCorrection(output, edgeThreshold / (scale * range));
-    msdfPatchEdgeArtifacts(output, shape, range, scale, translate, overlapSupport);
+    msdfPatchEdgeArtifacts(output, shape, range, scale, translate, overlapSupport, 0, 0, output.height);
   }
 
-  void generateMTSDF(const BitmapRef<float, 4> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool overlapSupport)
+  void generateMTSDF(const BitmapRef<float, 4> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool overlapSupport, GeneratorPrecision precision)
+  {
+    generateDistanceField<MultiAndTrueDistanceSelector>(output, shape, range, scale, translate, overlapSupport, precision, 0, 0);
+    if (edgeThreshold > 0)
+      msdfErrorCorrection(output, edgeThreshold / (scale * range));
+    msdfPatchEdgeArtifacts(output, shape, range, scale, translate, overlapSupport, 0, 0, output.height);
+  }
+
+  void generateMSDFUncorrected(const BitmapRef<float, 3> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport, GeneratorPrecision precision)
+  {
+    generateDistanceField<MultiDistanceSelector>(output, shape, range, scale, translate, overlapSupport, precision, 0, 0);
+  }
+
+  void generateMTSDFUncorrected(const BitmapRef<float, 4> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport, GeneratorPrecision precision)
+  {
+    generateDistanceField<MultiAndTrueDistanceSelector>(output, shape, range, scale, translate, overlapSupport, precision, 0, 0);
+  }
+
+  // Extra pixels generated around each tile. Error correction looks two pixels deep and edge artifact patching one more.
+  static const int TILE_HALO = 4;
+
+  template <int N>
+  static void correctTile(const BitmapRef<float, N> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool overlapSupport, int regionX, int regionY, int outputHeight)
   {
-    if (overlapSupport)
-      generateDistanceField<OverlappingContourCombiner<MultiAndTrueDistanceSelector>>(output, shape, range, scale, translate);
-    else
-      generateDistanceField<SimpleContourCombiner<MultiAndTrueDistanceSelector>>(output, shape, range, scale, translate);
     if (edgeThreshold > 0)
       msdfErrorCorrection(output, edgeThreshold / (scale * range));
-    msdfPatchEdgeArtifacts(output, shape, range, scale, translate, overlapSupport);
+    msdfPatchEdgeArtifacts(output, shape, range, scale, translate, overlapSupport, regionX, regionY, outputHeight);
+  }
+
+  /// Generates the output tile by tile. Unless correctTile is NULL, each tile is generated with a halo, and corrected before it is written.
+  template <class EdgeSelector, int N>
+  static bool generateTiled(BitmapTileWriter<N> &writer, int width, int height, int tileSize, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool overlapSupport, GeneratorPrecision precision,
+                            void (*correctTile)(const BitmapRef<float, N> &, const Shape &, double, const Vector2 &, const Vector2 &, double, bool, int, int, int))
+  {
+    tileSize = max(tileSize, 1);
+    // The samples of a pixel do not depend on the region, so without correction no neighborhood is needed
+    int halo = correctTile ? TILE_HALO : 0;
+    // Both buffers are sized for the largest tile and reused
+    std::vector<float> region(N * min(tileSize + 2 * halo, width) * min(tileSize + 2 * halo, height));
+    std::vector<byte> tile(N * min(tileSize, width) * min(tileSize, height));
+    for (int tileY = 0; tileY < height; tileY += tileSize)
+    {
+      for (int tileX = 0; tileX < width; tileX += tileSize)
+      {
+        int tileWidth = min(tileSize, width - tileX), tileHeight = min(tileSize, height - tileY);
+
+        // The generated region is the tile grown by the halo, clipped to the output, so pixels at the output border are treated as in a whole bitmap
+        int regionX = max(tileX - halo, 0), regionY = max(tileY - halo, 0);
+        int regionWidth = min(tileX + tileWidth + halo, width) - regionX;
+        int regionHeight = min(tileY + tileHeight + halo, height) - regionY;
+        // With an inverted Y axis, the region's rows are sampled from the opposite end of the output
+        int sampleY = shape.inverseYAxis ? height - regionY - regionHeight : regionY;
+        BitmapRef<float, N> regionRef(&region[0], regionWidth, regionHeight);
+        generateDistanceField<EdgeSelector>(regionRef, shape, range, scale, translate, overlapSupport, precision, regionX, sampleY);
+        if (correctTile)
+          correctTile(regionRef, shape, range, scale, translate, edgeThreshold, overlapSupport, regionX, regionY, height);
+
+        BitmapRef<byte, N> tileRef(&tile[0], tileWidth, tileHeight);
+        for (int y = 0; y < tileHeight; ++y)
+        {
+          const float *src = regionRef(tileX - regionX, tileY - regionY + y);
+          byte *dst = tileRef(0, y);
+          for (int i = 0; i < N * tileWidth; ++i)
+            dst[i] = pixelFloatToByte(src[i]);
+        }
+        if (!writer.writeTile(tileX, tileY, tileRef))
+          return false;
+      }
+    }
+    return true;
+  }
+
+  bool generateSDFTiled(BitmapTileWriter<1> &writer, int width, int height, int tileSize, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport, GeneratorPrecision precision)
+  {
+    return generateTiled<TrueDistanceSelector, 1>(writer, width, height, tileSize, shape, range, scale, translate, 0, overlapSupport, precision, NULL);
+  }
+
+  bool generateMSDFTiled(BitmapTileWriter<3> &writer, int width, int height, int tileSize, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool overlapSupport, GeneratorPrecision precision)
+  {
+    return generateTiled<MultiDistanceSelector>(writer, width, height, tileSize, shape, range, scale, translate, edgeThreshold, overlapSupport, precision, &correctTile<3>);
+  }
+
+  bool generateMTSDFTiled(BitmapTileWriter<4> &writer, int width, int height, int tileSize, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold, bool overlapSupport, GeneratorPrecision precision)
+  {
+    return generateTiled<MultiAndTrueDistanceSelector>(writer, width, height, tileSize, shape, range, scale, translate, edgeThreshold, overlapSupport, precision, &correctTile<4>);
   }
 
   // Legacy version
@@ -2,45 +2,59 @@
 #include "rasterization.h"
 
 #include "arithmetics.hpp"
-#include <vector>
+#include "working-storage.h"
 
 namespace msdfgen
 {
 
   void rasterize(const BitmapRef<float, 1> &output, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule)
   {
-    Point2 p;
-    Scanline scanline;
-    for (int y = 0; y < output.height; ++y)
+#ifdef MSDFGEN_USE_OPENMP
+#pragma omp parallel
+#endif
     {
-      int row = shape.inverseYAxis ? output.height - y - 1 : y;
-      p.y = (y + .5) / scale.y - translate.y;
-      shape.scanline(scanline, p.y);
-      for (int x = 0; x < output.width; ++x)
+      // Kept by the thread for its later calls
+      static thread_local Scanline scanline;
+      static thread_local WorkingVector<char> fill;
+      fill.resize(output.width);
+#ifdef MSDFGEN_USE_OPENMP
+#pragma omp for
+#endif
+      for (int y = 0; y < output.height; ++y)
       {
-        p.x = (x + .5) / scale.x - translate.x;
-        bool fill = scanline.filled(p.x, fillRule);
-        *output(x, row) = (float)fill;
+        int row = shape.inverseYAxis ? output.height - y - 1 : y;
+        shape.scanline(scanline, (y + .5) / scale.y - translate.y);
+        scanline.filledSamples(fill.data(), output.width, scale.x, translate.x, fillRule);
+        float *pixel = output(0, row);
+        for (int x = 0; x < output.width; ++x)
+          pixel[x] = (float)fill[x];
       }
     }
   }
 
   void distanceSignCorrection(const BitmapRef<float, 1> &sdf, const Shape &shape, const Vector2 &scale, const Vector2 &translate, FillRule fillRule)
   {
-    Point2 p;
-    Scanline scanline;
-    for (int y = 0; y < sdf.height; ++y)
+#ifdef MSDFGEN_USE_OPENMP
+#pragma omp parallel
+#endif
     {
-      int row = shape.inverseYAxis ? sdf.height - y - 1 : y;
-      p.y = (y + .5) / scale.y - translate.y;
-      shape.scanline(scanline, p.y);
-      for (int x = 0; x < sdf.width; ++x)
+      static thread_local Scanline scanline;
+      static thread_local WorkingVector<char> fill;
+      fill.resize(sdf.width);
+#ifdef MSDFGEN_USE_OPENMP
+#pragma omp for
+#endif
+      for (int y = 0; y < sdf.height; ++y)
       {
-        p.x = (x + .5) / scale.x - translate.x;
-        bool fill = scanline.filled(p.x, fillRule);
-        float &sd = *sdf(x, row);
-        if ((sd > .5f) != fill)
-          sd = 1.f - sd;
+        int row = shape.inverseYAxis ? sdf.height - y - 1 : y;
+        shape.scanline(scanline, (y + .5) / scale.y - translate.y);
+        scanline.filledSamples(fill.data(), sdf.width, scale.x, translate.x, fillRule);
+        float *sd = sdf(0, row);
+        for (int x = 0; x < sdf.width; ++x)
+        {
+          if ((sd[x] > .5f) != (bool)fill[x])
+            sd[x] = 1.f - sd[x];
+        }
       }
     }
   }
@@ -51,47 +65,59 @@ namespace msdfgen
     int w = sdf.width, h = sdf.height;
     if (!(w * h))
       return;
-    Point2 p;
-    Scanline scanline;
     bool ambiguous = false;
-    std::vector<char> matchMap;
-    matchMap.resize(w * h);
-    char *match = &matchMap[0];
-    for (int y = 0; y < h; ++y)
+    // The map is kept by the calling thread, the threads of the parallel regions only reach it through the reference
+    static thread_local WorkingVector<char> callerMatchMap;
+    WorkingVector<char> &matchMap = callerMatchMap;
+    matchMap.assign(w * h, 0);
+#ifdef MSDFGEN_USE_OPENMP
+#pragma omp parallel reduction(|| : ambiguous)
+#endif
     {
-      int row = shape.inverseYAxis ? h - y - 1 : y;
-      p.y = (y + .5) / scale.y - translate.y;
-      shape.scanline(scanline, p.y);
-      for (int x = 0; x < w; ++x)
+      static thread_local Scanline scanline;
+      static thread_local WorkingVector<char> fill;
+      fill.resize(w);
+#ifdef MSDFGEN_USE_OPENMP
+#pragma omp for
+#endif
+      for (int y = 0; y < h; ++y)
       {
-        p.x = (x + .5) / scale.x - translate.x;
-        bool fill = scanline.filled(p.x, fillRule);
-        float *msd = sdf(x, row);
-        float sd = median(msd[0], msd[1], msd[2]);
-        if (sd == .5f)
-          ambiguous = true;
-        else if ((sd > .5f) != fill)
+        int row = shape.inverseYAxis ? h - y - 1 : y;
+        shape.scanline(scanline, (y + .5) / scale.y - translate.y);
+        scanline.filledSamples(fill.data(), w, scale.x, translate.x, fillRule);
+        char *match = &matchMap[y * w];
+        float *msd = sdf(0, row);
+        for (int x = 0; x < w; ++x, msd += N)
         {
-          msd[0] = 1.f - msd[0];
-          msd[1] = 1.f - msd[1];
-          msd[2] = 1.f - msd[2];
-          *match = -1;
+          float sd = median(msd[0], msd[1], msd[2]);
+          if (sd == .5f)
+            ambiguous = true;
+          else if ((sd > .5f) != (bool)fill[x])
+          {
+            msd[0] = 1.f - msd[0];
+            msd[1] = 1.f - msd[1];
+            msd[2] = 1.f - msd[2];
+            match[x] = -1;
+          }
+          else
+            match[x] = 1;
+          if (N >= 4 && (msd[3] > .5f) != (bool)fill[x])
+            msd[3] = 1.f - msd[3];
         }
-        else
-          *match = 1;
-        if (N >= 4 && (msd[3] > .5f) != fill)
-          msd[3] = 1.f - msd[3];
-        ++match;
       }
     }
     // This step is necessary to avoid artifacts when whole shape is inverted
     if (ambiguous)
     {
-      match = &matchMap[0];
+      // Only ambiguous pixels are flipped, and their match values are left untouched, so rows can be resolved in parallel
+#ifdef MSDFGEN_USE_OPENMP
+#pragma omp parallel for
+#endif
       for (int y = 0; y < h; ++y)
       {
         int row = shape.inverseYAxis ? h - y - 1 : y;
-        for (int x = 0; x < w; ++x)
+        const char *match = &matchMap[y * w];
+        for (int x = 0; x < w; ++x, ++match)
         {
           if (!*match)
           {
@@ -112,7 +138,6 @@ namespace msdfgen
               msd[2] = 1.f - msd[2];
             }
           }
-          ++match;
         }
       }
     }
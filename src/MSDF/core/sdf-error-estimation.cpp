@@ -9,8 +9,9 @@ namespace msdfgen
 
   void scanlineSDF(Scanline &line, const BitmapConstRef<float, 1> &sdf, const Vector2 &scale, const Vector2 &translate, bool inverseYAxis, double y)
   {
+    line.beginIntersections();
     if (!(sdf.width > 0 && sdf.height > 0))
-      return line.setIntersections(std::vector<Scanline::Intersection>());
+      return line.endIntersections();
     double pixelY = clamp(scale.x * (y + translate.y) - .5, double(sdf.height - 1));
     if (inverseYAxis)
       pixelY = sdf.height - 1 - pixelY;
@@ -24,12 +25,10 @@ namespace msdfgen
       bt = 1;
     }
     bool inside = false;
-    std::vector<Scanline::Intersection> intersections;
     float lv, rv = mix(*sdf(0, b), *sdf(0, t), bt);
     if ((inside = rv > .5f))
     {
-      Scanline::Intersection intersection = {-1e240, 1};
-      intersections.push_back(intersection);
+      line.addIntersection(-1e240, 1);
     }
     for (int l = 0, r = 1; r < sdf.width; ++l, ++r)
     {
@@ -39,24 +38,18 @@ namespace msdfgen
       {
         double lr = double(.5f - lv) / double(rv - lv);
         if (lr >= 0 && lr <= 1)
-        {
-          Scanline::Intersection intersection = {(l + lr + .5) / scale.x - translate.x, sign(rv - lv)};
-          intersections.push_back(intersection);
-        }
+          line.addIntersection((l + lr + .5) / scale.x - translate.x, sign(rv - lv));
       }
     }
-#ifdef MSDFGEN_USE_CPP11
-    line.setIntersections((std::vector<Scanline::Intersection> &&) intersections);
-#else
-    line.setIntersections(intersections);
-#endif
+    line.endIntersections();
   }
 
   template <int N>
   void scanlineMSDF(Scanline &line, const BitmapConstRef<float, N> &sdf, const Vector2 &scale, const Vector2 &translate, bool inverseYAxis, double y)
   {
+    line.beginIntersections();
     if (!(sdf.width > 0 && sdf.height > 0))
-      return line.setIntersections(std::vector<Scanline::Intersection>());
+      return line.endIntersections();
     double pixelY = clamp(scale.x * (y + translate.y) - .5, double(sdf.height - 1));
     if (inverseYAxis)
       pixelY = sdf.height - 1 - pixelY;
@@ -70,15 +63,13 @@ namespace msdfgen
       bt = 1;
     }
     bool inside = false;
-    std::vector<Scanline::Intersection> intersections;
     float lv[3], rv[3];
     rv[0] = mix(sdf(0, b)[0], sdf(0, t)[0], bt);
     rv[1] = mix(sdf(0, b)[1], sdf(0, t)[1], bt);
     rv[2] = mix(sdf(0, b)[2], sdf(0, t)[2], bt);
     if ((inside = median(rv[0], rv[1], rv[2]) > .5f))
     {
-      Scanline::Intersection intersection = {-1e240, 1};
-      intersections.push_back(intersection);
+      line.addIntersection(-1e240, 1);
     }
     for (int l = 0, r = 1; r < sdf.width; ++l, ++r)
     {
@@ -124,23 +115,16 @@ namespace msdfgen
       {
         if ((newIntersections[i].direction > 0) == !inside)
         {
-          intersections.push_back(newIntersections[i]);
+          line.addIntersection(newIntersections[i].x, newIntersections[i].direction);
           inside = !inside;
         }
       }
       // Consistency check
       float rvScalar = median(rv[0], rv[1], rv[2]);
-      if ((rvScalar > .5f) != inside && rvScalar != .5f && !intersections.empty())
-      {
-        intersections.pop_back();
+      if ((rvScalar > .5f) != inside && rvScalar != .5f && line.removeLastIntersection())
         inside = !inside;
-      }
     }
-#ifdef MSDFGEN_USE_CPP11
-    line.setIntersections((std::vector<Scanline::Intersection> &&) intersections);
-#else
-    line.setIntersections(intersections);
-#endif
+    line.endIntersections();
   }
 
   void scanlineSDF(Scanline &line, const BitmapConstRef<float, 3> &sdf, const Vector2 &scale, const Vector2 &translate, bool inverseYAxis, double y)
@@ -162,7 +146,8 @@ namespace msdfgen
     double xTo = (sdf.width - .5) / scale.x - translate.x;
     double overlapFactor = 1 / (xTo - xFrom);
     double error = 0;
-    Scanline refScanline, sdfScanline;
+    // Kept by the thread for its later calls
+    static thread_local Scanline refScanline, sdfScanline;
     for (int row = 0; row < sdf.height - 1; ++row)
     {
       for (int subRow = 0; subRow < scanlinesPerRow; ++subRow)
@@ -0,0 +1,260 @@
+#define _CRT_SECURE_NO_WARNINGS
+#define _USE_MATH_DEFINES
+#include "svg-path.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+
+namespace msdfgen
+{
+
+  static void skipSeparators(const char *&pathDef)
+  {
+    while (*pathDef == ' ' || *pathDef == '\t' || *pathDef == '\r' || *pathDef == '\n' || *pathDef == ',')
+      ++pathDef;
+  }
+
+  static bool readCommand(char &output, const char *&pathDef)
+  {
+    skipSeparators(pathDef);
+    char c = *pathDef;
+    if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'))
+    {
+      if (c == 'e' || c == 'E')
+        return false;
+      output = c;
+      ++pathDef;
+      return true;
+    }
+    return false;
+  }
+
+  static bool readDouble(double &output, const char *&pathDef)
+  {
+    skipSeparators(pathDef);
+    int read = 0;
+    if (sscanf(pathDef, "%lf%n", &output, &read) == 1 && read > 0)
+    {
+      pathDef += read;
+      return true;
+    }
+    return false;
+  }
+
+  static bool readCoord(Point2 &output, const char *&pathDef)
+  {
+    return readDouble(output.x, pathDef) && readDouble(output.y, pathDef);
+  }
+
+  // Arc flags are single digits that may follow each other without a separator
+  static bool readFlag(bool &output, const char *&pathDef)
+  {
+    skipSeparators(pathDef);
+    if (*pathDef == '0' || *pathDef == '1')
+    {
+      output = *pathDef++ == '1';
+      return true;
+    }
+    return false;
+  }
+
+  static void addArc(Contour &contour, Point2 p0, Point2 p1, double rx, double ry, double rotation, bool largeArc, bool sweep)
+  {
+    rx = fabs(rx), ry = fabs(ry);
+    if (rx == 0 || ry == 0)
+    {
+      contour.addEdge(EdgeHolder(p0, p1));
+      return;
+    }
+
+    // Endpoint to center parameterization, as in the SVG specification's implementation notes
+    double cosPhi = cos(rotation * M_PI / 180), sinPhi = sin(rotation * M_PI / 180);
+    Vector2 half = .5 * (p0 - p1);
+    Vector2 p(cosPhi * half.x + sinPhi * half.y, -sinPhi * half.x + cosPhi * half.y);
+    double lambda = p.x * p.x / (rx * rx) + p.y * p.y / (ry * ry);
+    if (lambda > 1)
+    {
+      rx *= sqrt(lambda);
+      ry *= sqrt(lambda);
+    }
+    double numerator = rx * rx * ry * ry - rx * rx * p.y * p.y - ry * ry * p.x * p.x;
+    double denominator = rx * rx * p.y * p.y + ry * ry * p.x * p.x;
+    double coefficient = sqrt(numerator > 0 ? numerator / denominator : 0) * (largeArc == sweep ? -1 : 1);
+    Vector2 c(coefficient * rx * p.y / ry, -coefficient * ry * p.x / rx);
+    Point2 center(cosPhi * c.x - sinPhi * c.y + .5 * (p0.x + p1.x), sinPhi * c.x + cosPhi * c.y + .5 * (p0.y + p1.y));
+
+    double startAngle = atan2((p.y - c.y) / ry, (p.x - c.x) / rx);
+    double sweepAngle = atan2((-p.y - c.y) / ry, (-p.x - c.x) / rx) - startAngle;
+    if (!sweep && sweepAngle > 0)
+      sweepAngle -= 2 * M_PI;
+    else if (sweep && sweepAngle < 0)
+      sweepAngle += 2 * M_PI;
+
+    // One cubic per quarter turn at most keeps the approximation error far below a pixel
+    int segments = (int)ceil(fabs(sweepAngle) / (.5 * M_PI) - 1e-9);
+    if (segments < 1)
+      segments = 1;
+    double step = sweepAngle / segments;
+    double handle = 4. / 3. * tan(.25 * step);
+    Point2 start = p0;
+    for (int i = 0; i < segments; ++i)
+    {
+      double a0 = startAngle + i * step, a1 = a0 + step;
+      Vector2 u0(cos(a0) - handle * sin(a0), sin(a0) + handle * cos(a0));
+      Vector2 u1(cos(a1) + handle * sin(a1), sin(a1) - handle * cos(a1));
+      Point2 c0(center.x + cosPhi * rx * u0.x - sinPhi * ry * u0.y, center.y + sinPhi * rx * u0.x + cosPhi * ry * u0.y);
+      Point2 c1(center.x + cosPhi * rx * u1.x - sinPhi * ry * u1.y, center.y + sinPhi * rx * u1.x + cosPhi * ry * u1.y);
+      Point2 end = i == segments - 1 ? p1 : Point2(center.x + cosPhi * rx * cos(a1) - sinPhi * ry * sin(a1), center.y + sinPhi * rx * cos(a1) + cosPhi * ry * sin(a1));
+      contour.addEdge(EdgeHolder(start, c0, c1, end));
+      start = end;
+    }
+  }
+
+  bool buildShapeFromSvgPath(Shape &shape, const char *pathDef)
+  {
+    Contour *contour = NULL;
+    Point2 current, subpathStart, prevControl;
+    char command = '\0', prevCommand = '\0';
+
+    while (true)
+    {
+      char nextCommand;
+      if (readCommand(nextCommand, pathDef))
+        command = nextCommand;
+      else
+      {
+        skipSeparators(pathDef);
+        if (!*pathDef)
+          break;
+        // Coordinates without a command repeat the previous one, where a moveto repeats as a lineto
+        if (command == '\0' || command == 'Z' || command == 'z')
+          return false;
+        if (command == 'M')
+          command = 'L';
+        else if (command == 'm')
+          command = 'l';
+      }
+
+      char upper = (char)toupper(command);
+      // Path data has to begin with a moveto, anything else has no current point to start from
+      if (prevCommand == '\0' && upper != 'M')
+        return false;
+      Vector2 offset = command == upper ? Vector2() : current;
+
+      if (upper == 'M' || upper == 'Z')
+      {
+        if (contour && current != subpathStart)
+          contour->addEdge(EdgeHolder(current, subpathStart));
+        contour = NULL;
+        current = subpathStart;
+        if (upper == 'M')
+        {
+          Point2 p;
+          if (!readCoord(p, pathDef))
+            return false;
+          current = subpathStart = p + offset;
+        }
+        prevCommand = upper;
+        continue;
+      }
+
+      if (!contour)
+      {
+        contour = &shape.addContour();
+        subpathStart = current;
+      }
+
+      Point2 p[3];
+      switch (upper)
+      {
+      case 'L':
+        if (!readCoord(p[0], pathDef))
+          return false;
+        p[0] += offset;
+        if (p[0] != current)
+          contour->addEdge(EdgeHolder(current, p[0]));
+        current = p[0];
+        break;
+      case 'H':
+        if (!readDouble(p[0].x, pathDef))
+          return false;
+        p[0].x += offset.x;
+        p[0].y = current.y;
+        if (p[0] != current)
+          contour->addEdge(EdgeHolder(current, p[0]));
+        current = p[0];
+        break;
+      case 'V':
+        if (!readDouble(p[0].y, pathDef))
+          return false;
+        p[0].x = current.x;
+        p[0].y += offset.y;
+        if (p[0] != current)
+          contour->addEdge(EdgeHolder(current, p[0]));
+        current = p[0];
+        break;
+      case 'Q':
+      case 'T':
+        if (upper == 'Q')
+        {
+          if (!(readCoord(p[0], pathDef) && readCoord(p[1], pathDef)))
+            return false;
+          p[0] += offset;
+        }
+        else
+        {
+          if (!readCoord(p[1], pathDef))
+            return false;
+          // The control point is the reflection of the previous quadratic's, or the current point
+          p[0] = prevCommand == 'Q' || prevCommand == 'T' ? 2 * current - prevControl : current;
+        }
+        p[1] += offset;
+        contour->addEdge(EdgeHolder(current, p[0], p[1]));
+        prevControl = p[0];
+        current = p[1];
+        break;
+      case 'C':
+      case 'S':
+        if (upper == 'C')
+        {
+          if (!(readCoord(p[0], pathDef) && readCoord(p[1], pathDef) && readCoord(p[2], pathDef)))
+            return false;
+          p[0] += offset;
+        }
+        else
+        {
+          if (!(readCoord(p[1], pathDef) && readCoord(p[2], pathDef)))
+            return false;
+          p[0] = prevCommand == 'C' || prevCommand == 'S' ? 2 * current - prevControl : current;
+        }
+        p[1] += offset;
+        p[2] += offset;
+        contour->addEdge(EdgeHolder(current, p[0], p[1], p[2]));
+        prevControl = p[1];
+        current = p[2];
+        break;
+      case 'A':
+      {
+        double rx, ry, rotation;
+        bool largeArc, sweep;
+        if (!(readDouble(rx, pathDef) && readDouble(ry, pathDef) && readDouble(rotation, pathDef) && readFlag(largeArc, pathDef) && readFlag(sweep, pathDef) && readCoord(p[0], pathDef)))
+          return false;
+        p[0] += offset;
+        if (p[0] != current)
+          addArc(*contour, current, p[0], rx, ry, rotation, largeArc, sweep);
+        current = p[0];
+        break;
+      }
+      default:
+        return false;
+      }
+      prevCommand = upper;
+    }
+
+    if (contour && current != subpathStart)
+      contour->addEdge(EdgeHolder(current, subpathStart));
+    return true;
+  }
+
+} // namespace msdfgen
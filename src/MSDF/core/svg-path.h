@@ -0,0 +1,12 @@
+#pragma once
+
+#include "Shape.h"
+
+namespace msdfgen {
+
+/// Appends the contours described by SVG path data (the d attribute of a path element) to the shape.
+/// Supports every path command, with arcs approximated by cubic segments. Open subpaths are closed, since only their fill is of interest.
+/// The coordinates are kept as they are, so the shape is in the SVG's top-to-bottom Y space. Returns false if the path data is malformed or does not begin with a moveto.
+bool buildShapeFromSvgPath(Shape &shape, const char *pathDef);
+
+}
@@ -0,0 +1,20 @@
+#include "working-storage.h"
+
+#include <atomic>
+
+namespace msdfgen
+{
+
+  static std::atomic<unsigned long long> allocationCount(0);
+
+  unsigned long long workingStorageAllocationCount()
+  {
+    return allocationCount.load(std::memory_order_relaxed);
+  }
+
+  void countWorkingStorageAllocation()
+  {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+  }
+
+} // namespace msdfgen
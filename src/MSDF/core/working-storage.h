@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace msdfgen {
+
+/// Returns the number of heap allocations made so far for the working storage of the generators, rasterization, sign correction and error estimation.
+/// That storage is kept by each thread and reused by its later calls, so repeating a call allocates nothing once the first one has run.
+unsigned long long workingStorageAllocationCount();
+
+/// Adds an allocation to workingStorageAllocationCount.
+void countWorkingStorageAllocation();
+
+/// The standard allocator, counting its allocations in workingStorageAllocationCount.
+template <typename T>
+class WorkingStorageAllocator {
+
+public:
+    typedef T value_type;
+
+    WorkingStorageAllocator() { }
+    template <typename U>
+    WorkingStorageAllocator(const WorkingStorageAllocator<U> &) { }
+
+    T * allocate(std::size_t n) {
+        countWorkingStorageAllocation();
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T *p, std::size_t n) {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+};
+
+template <typename T, typename U>
+inline bool operator==(const WorkingStorageAllocator<T> &, const WorkingStorageAllocator<U> &) {
+    return true;
+}
+
+template <typename T, typename U>
+inline bool operator!=(const WorkingStorageAllocator<T> &, const WorkingStorageAllocator<U> &) {
+    return false;
+}
+
+/// A vector of working storage. Only ever cleared or resized between uses, never destroyed with the call that filled it.
+template <typename T>
+using WorkingVector = std::vector<T, WorkingStorageAllocator<T> >;
+
+}
@@ -27,30 +27,62 @@
 #include "core/Shape.h"
 #include "core/BitmapRef.hpp"
 #include "core/Bitmap.h"
+#include "core/BitmapTileWriter.h"
 #include "core/bitmap-interpolation.hpp"
 #include "core/pixel-conversion.hpp"
 #include "core/edge-coloring.h"
 #include "core/msdf-error-correction.h"
+#include "core/msdf-edge-artifact-patcher.h"
 #include "core/render-sdf.h"
 #include "core/rasterization.h"
 #include "core/sdf-error-estimation.h"
 #include "core/shape-description.h"
+#include "core/svg-path.h"
+#include "core/working-storage.h"
 
 #define MSDFGEN_VERSION "1.8"
 
 namespace msdfgen {
 
+/// The floating-point precision in which the generators compute edge distances.
+enum GeneratorPrecision {
+    /// Computes distances in double precision, matching the reference results.
+    PRECISION_DOUBLE,
+    /// Searches curved edges for their closest points in single precision. Distances, signs and ties between edges are still resolved in double.
+    PRECISION_FLOAT
+};
+
+// The generators, rasterization, sign correction and error estimation keep their working storage per thread and reuse it in later calls,
+// so that repeated calls stop allocating once it has grown large enough. See workingStorageAllocationCount.
+
 /// Generates a conventional single-channel signed distance field.
-void generateSDF(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport = true);
+void generateSDF(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport = true, GeneratorPrecision precision = PRECISION_DOUBLE);
 
 /// Generates a single-channel signed pseudo-distance field.
-void generatePseudoSDF(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport = true);
+void generatePseudoSDF(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport = true, GeneratorPrecision precision = PRECISION_DOUBLE);
 
 /// Generates a multi-channel signed distance field. Edge colors must be assigned first! (See edgeColoringSimple)
-void generateMSDF(const BitmapRef<float, 3> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = MSDFGEN_DEFAULT_ERROR_CORRECTION_THRESHOLD, bool overlapSupport = true);
+void generateMSDF(const BitmapRef<float, 3> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = MSDFGEN_DEFAULT_ERROR_CORRECTION_THRESHOLD, bool overlapSupport = true, GeneratorPrecision precision = PRECISION_DOUBLE);
 
 /// Generates a multi-channel signed distance field with true distance in the alpha channel. Edge colors must be assigned first.
-void generateMTSDF(const BitmapRef<float, 4> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = MSDFGEN_DEFAULT_ERROR_CORRECTION_THRESHOLD, bool overlapSupport = true);
+void generateMTSDF(const BitmapRef<float, 4> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = MSDFGEN_DEFAULT_ERROR_CORRECTION_THRESHOLD, bool overlapSupport = true, GeneratorPrecision precision = PRECISION_DOUBLE);
+
+/// Generates the raw fields of generateMSDF and generateMTSDF, without error correction or edge artifact patching, so that callers may fix the signs
+/// first (see distanceSignCorrection) and apply msdfErrorCorrection and msdfPatchEdgeArtifacts afterwards.
+void generateMSDFUncorrected(const BitmapRef<float, 3> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport = true, GeneratorPrecision precision = PRECISION_DOUBLE);
+void generateMTSDFUncorrected(const BitmapRef<float, 4> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport = true, GeneratorPrecision precision = PRECISION_DOUBLE);
+
+/// Generates a width x height SDF like generateSDF, in tiles of at most tileSize x tileSize pixels, each of which is quantized and passed to the writer
+/// as soon as it is complete, so that only one tile is held in floating point at a time. Returns false if the writer aborted.
+/// Samples do not depend on the tile they are generated in, so the result is identical to that of generateSDF.
+bool generateSDFTiled(BitmapTileWriter<1> &writer, int width, int height, int tileSize, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, bool overlapSupport = true, GeneratorPrecision precision = PRECISION_DOUBLE);
+
+/// Generates a width x height MSDF like generateMSDF, in tiles passed to the writer as by generateSDFTiled.
+/// Each tile is generated with a halo, so that error correction and edge artifact patching see the same neighborhood as in a whole bitmap.
+bool generateMSDFTiled(BitmapTileWriter<3> &writer, int width, int height, int tileSize, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = MSDFGEN_DEFAULT_ERROR_CORRECTION_THRESHOLD, bool overlapSupport = true, GeneratorPrecision precision = PRECISION_DOUBLE);
+
+/// Generates a width x height MTSDF like generateMTSDF, in tiles passed to the writer as by generateMSDFTiled.
+bool generateMTSDFTiled(BitmapTileWriter<4> &writer, int width, int height, int tileSize, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate, double edgeThreshold = MSDFGEN_DEFAULT_ERROR_CORRECTION_THRESHOLD, bool overlapSupport = true, GeneratorPrecision precision = PRECISION_DOUBLE);
 
 // Original simpler versions of the previous functions, which work well under normal circumstances, but cannot deal with overlapping contours.
 void generateSDF_legacy(const BitmapRef<float, 1> &output, const Shape &shape, double range, const Vector2 &scale, const Vector2 &translate);
@@ -1,5 +1,7 @@
 
 #include "Command.hpp"
+#include "Command_BenchSDF.hpp"
+#include "Command_BenchSkinning.hpp"
 #include "Command_CreateDefaultMaterial.hpp"
 #include "Command_CreateEmptyMaterial.hpp"
 #include "Command_CreateShaderModule.hpp"
@@ -7,7 +9,13 @@
 #include "Command_ImportMesh.hpp"
 #include "Command_ImportPhysicsMesh.hpp"
 #include "Command_ImportTexture.hpp"
+#include "Command_ImportVector.hpp"
 #include "Command_TestCompression.hpp"
+#include "Command_TestSDFAllocations.hpp"
+#include "Command_TestSDFBatch.hpp"
+#include "Command_TestSDFGrid.hpp"
+#include "Command_TestSDFPrecision.hpp"
+#include "Command_TestSDFTiles.hpp"
 
 #include <KIT/Engine.hpp>
 
@@ -37,12 +45,20 @@ int main(int argc, char **argv)
 
   registerCommand(new Command_CreateShaderModule());
   registerCommand(new Command_TestCompression());
+  registerCommand(new Command_TestSDFBatch());
+  registerCommand(new Command_TestSDFPrecision());
+  registerCommand(new Command_TestSDFAllocations());
+  registerCommand(new Command_TestSDFTiles());
+  registerCommand(new Command_TestSDFGrid());
+  registerCommand(new Command_BenchSDF());
+  registerCommand(new Command_BenchSkinning());
   registerCommand(new Command_ImportMesh());
   registerCommand(new Command_ImportPhysicsMesh());
   registerCommand(new Command_CreateDefaultMaterial());
   registerCommand(new Command_CreateEmptyMaterial());
   registerCommand(new Command_ImportTexture());
   registerCommand(new Command_ImportFont());
+  registerCommand(new Command_ImportVector());
 
   std::vector<std::string> args;
   for (int32_t i = 0; i < argc; i++)
@@ -0,0 +1,293 @@
+#include "MeshClustering.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+  constexpr uint8_t notInMeshlet = 0xff;
+
+  // How much a misaligned normal costs compared to a triangle one meshlet radius away
+  constexpr float coneWeight = 0.5f;
+
+  /** Computes the bounding sphere and normal cone of a finished meshlet */
+  void computeBounds(meshing::Meshlet &meshlet, meshing::MeshletData const &output, std::vector<glm::vec3> const &positions)
+  {
+    glm::vec3 minimum(FLT_MAX);
+    glm::vec3 maximum(-FLT_MAX);
+    for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+    {
+      glm::vec3 const &p = positions[output.vertices[meshlet.vertexOffset + i]];
+      minimum = glm::min(minimum, p);
+      maximum = glm::max(maximum, p);
+    }
+
+    meshlet.center = (minimum + maximum) * 0.5f;
+    meshlet.radius = 0.0f;
+    for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+    {
+      meshlet.radius = (glm::max)(meshlet.radius, glm::distance(meshlet.center, positions[output.vertices[meshlet.vertexOffset + i]]));
+    }
+
+    // The axis is the average of the triangle normals, and the cone has to contain every one of them
+    std::vector<glm::vec3> corners(meshlet.triangleCount * 3);
+    std::vector<glm::vec3> normals(meshlet.triangleCount);
+    glm::vec3 axis(0.0f);
+    for (uint32_t t = 0; t < meshlet.triangleCount; t++)
+    {
+      for (uint32_t c = 0; c < 3; c++)
+      {
+        uint8_t local = output.triangles[(meshlet.triangleOffset + t) * 3 + c];
+        corners[t * 3 + c] = positions[output.vertices[meshlet.vertexOffset + local]];
+      }
+
+      glm::vec3 normal = glm::cross(corners[t * 3 + 1] - corners[t * 3], corners[t * 3 + 2] - corners[t * 3]);
+      float length = glm::length(normal);
+      normals[t] = length > 0.0f ? normal * (1.0f / length) : glm::vec3(0.0f);
+      axis += normals[t];
+    }
+
+    meshlet.coneApex = meshlet.center;
+    meshlet.coneAxis = glm::vec3(0.0f);
+    meshlet.coneCutoff = 1.0f;
+
+    float axisLength = glm::length(axis);
+    if (axisLength <= 0.0f)
+    {
+      return;
+    }
+    axis = axis * (1.0f / axisLength);
+
+    float minimumDot = 1.0f;
+    for (auto const &normal : normals)
+    {
+      minimumDot = (glm::min)(minimumDot, glm::dot(normal, axis));
+    }
+
+    // Past about 85 degrees the cone would almost never cull anything, so it is left as one that never does
+    meshlet.coneAxis = axis;
+    if (minimumDot <= 0.1f)
+    {
+      return;
+    }
+
+    // Move the apex back along the axis until every triangle plane passes in front of it, which keeps the test conservative
+    // under perspective
+    float maximumT = 0.0f;
+    for (uint32_t t = 0; t < meshlet.triangleCount; t++)
+    {
+      float normalDot = glm::dot(normals[t], axis);
+      if (normalDot <= 0.0f)
+      {
+        continue;
+      }
+
+      float distance = glm::dot(meshlet.center - corners[t * 3], normals[t]);
+      maximumT = (glm::max)(maximumT, distance / normalDot);
+    }
+
+    meshlet.coneApex = meshlet.center - axis * maximumT;
+    meshlet.coneCutoff = std::sqrt(1.0f - minimumDot * minimumDot);
+  }
+} // namespace
+
+void meshing::buildMeshlets(MeshletData &output, KXF::Submesh const *submesh, uint32_t maxVertices, uint32_t maxTriangles)
+{
+  output.meshlets.clear();
+  output.vertices.clear();
+  output.triangles.clear();
+
+  auto const &indices = submesh->indices;
+  size_t const vertexCount = submesh->vertices.size();
+  size_t const triangleCount = indices.size() / 3;
+  if (triangleCount == 0)
+  {
+    return;
+  }
+
+  maxVertices = glm::clamp(maxVertices, 3u, uint32_t(notInMeshlet));
+  maxTriangles = (glm::max)(maxTriangles, 1u);
+
+  std::vector<glm::vec3> positions(vertexCount);
+  for (size_t i = 0; i < vertexCount; i++)
+  {
+    positions[i] = glm::vec3(submesh->vertices[i].position);
+  }
+
+  std::vector<glm::vec3> triangleCenters(triangleCount);
+  std::vector<glm::vec3> triangleNormals(triangleCount);
+  for (size_t t = 0; t < triangleCount; t++)
+  {
+    glm::vec3 const &p0 = positions[indices[t * 3]];
+    glm::vec3 const &p1 = positions[indices[t * 3 + 1]];
+    glm::vec3 const &p2 = positions[indices[t * 3 + 2]];
+    triangleCenters[t] = (p0 + p1 + p2) * (1.0f / 3.0f);
+
+    glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+    float length = glm::length(normal);
+    triangleNormals[t] = length > 0.0f ? normal * (1.0f / length) : glm::vec3(0.0f);
+  }
+
+  // Triangles around every vertex
+  std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+  for (uint32_t index : indices)
+  {
+    adjacencyOffsets[index + 1]++;
+  }
+  std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+  std::vector<uint32_t> adjacency(triangleCount * 3);
+  {
+    std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; i++)
+    {
+      adjacency[fill[indices[i]]++] = uint32_t(i / 3);
+    }
+  }
+
+  std::vector<bool> emitted(triangleCount, false);
+  std::vector<uint8_t> localIndices(vertexCount, notInMeshlet);
+  std::vector<uint32_t> candidates;
+  size_t scanCursor = 0;
+
+  Meshlet meshlet;
+  glm::vec3 centerSum(0.0f);
+  glm::vec3 normalSum(0.0f);
+
+  auto newVertexCount = [&](uint32_t triangle) {
+    uint32_t count = 0;
+    for (uint32_t c = 0; c < 3; c++)
+    {
+      count += localIndices[indices[triangle * 3 + c]] == notInMeshlet ? 1 : 0;
+    }
+    return count;
+  };
+
+  auto fits = [&](uint32_t triangle) {
+    return meshlet.vertexCount + newVertexCount(triangle) <= maxVertices && meshlet.triangleCount + 1 <= maxTriangles;
+  };
+
+  auto finishMeshlet = [&]() {
+    if (meshlet.triangleCount == 0)
+    {
+      return;
+    }
+
+    computeBounds(meshlet, output, positions);
+    output.meshlets.push_back(meshlet);
+
+    for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+    {
+      localIndices[output.vertices[meshlet.vertexOffset + i]] = notInMeshlet;
+    }
+
+    meshlet = Meshlet();
+    meshlet.vertexOffset = uint32_t(output.vertices.size());
+    meshlet.triangleOffset = uint32_t(output.triangles.size() / 3);
+    centerSum = glm::vec3(0.0f);
+    normalSum = glm::vec3(0.0f);
+    candidates.clear();
+  };
+
+  auto addTriangle = [&](uint32_t triangle) {
+    for (uint32_t c = 0; c < 3; c++)
+    {
+      uint32_t vertex = indices[triangle * 3 + c];
+      if (localIndices[vertex] == notInMeshlet)
+      {
+        localIndices[vertex] = uint8_t(meshlet.vertexCount++);
+        output.vertices.push_back(vertex);
+
+        // Triangles sharing the new vertex are the candidates to grow into
+        for (uint32_t a = adjacencyOffsets[vertex]; a < adjacencyOffsets[vertex + 1]; a++)
+        {
+          if (!emitted[adjacency[a]])
+          {
+            candidates.push_back(adjacency[a]);
+          }
+        }
+      }
+
+      output.triangles.push_back(localIndices[vertex]);
+    }
+
+    meshlet.triangleCount++;
+    emitted[triangle] = true;
+    centerSum += triangleCenters[triangle];
+    normalSum += triangleNormals[triangle];
+  };
+
+  size_t emittedCount = 0;
+  while (emittedCount < triangleCount)
+  {
+    // Pick the connected triangle adding the fewest vertices, then the closest one facing the same way
+    int64_t best = -1;
+    uint32_t bestNewVertices = 4;
+    float bestScore = FLT_MAX;
+    if (meshlet.triangleCount > 0)
+    {
+      glm::vec3 center = centerSum * (1.0f / float(meshlet.triangleCount));
+      float normalLength = glm::length(normalSum);
+      glm::vec3 normal = normalLength > 0.0f ? normalSum * (1.0f / normalLength) : glm::vec3(0.0f);
+
+      float radius = 0.0f;
+      for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+      {
+        radius = (glm::max)(radius, glm::distance(center, positions[output.vertices[meshlet.vertexOffset + i]]));
+      }
+      radius = radius > 0.0f ? radius : 1.0f;
+
+      size_t kept = 0;
+      for (size_t c = 0; c < candidates.size(); c++)
+      {
+        uint32_t triangle = candidates[c];
+        if (emitted[triangle])
+        {
+          continue;
+        }
+        candidates[kept++] = triangle;
+
+        if (!fits(triangle))
+        {
+          continue;
+        }
+
+        uint32_t newVertices = newVertexCount(triangle);
+        float score = glm::distance(center, triangleCenters[triangle]) / radius + coneWeight * (1.0f - glm::dot(normal, triangleNormals[triangle]));
+        if (newVertices < bestNewVertices || (newVertices == bestNewVertices && score < bestScore))
+        {
+          best = triangle;
+          bestNewVertices = newVertices;
+          bestScore = score;
+        }
+      }
+      candidates.resize(kept);
+    }
+
+    // Nothing connected fits, so continue with the next triangle in index order, which is close by after cache optimization
+    if (best < 0)
+    {
+      while (emitted[scanCursor])
+      {
+        scanCursor++;
+      }
+      best = int64_t(scanCursor);
+
+      if (!fits(uint32_t(best)))
+      {
+        finishMeshlet();
+      }
+    }
+
+    addTriangle(uint32_t(best));
+    emittedCount++;
+
+    if (meshlet.triangleCount == maxTriangles || meshlet.vertexCount == maxVertices)
+    {
+      finishMeshlet();
+    }
+  }
+
+  finishMeshlet();
+}
@@ -0,0 +1,329 @@
+#include "MeshCompression.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if !defined(MESHING_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MESHING_CODEC_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+  // Vertices are encoded in blocks, each holding its planes next to each other, so decoding reads memory in order
+  constexpr size_t vertexBlockSize = 256;
+
+  inline uint8_t zigzag8(uint8_t delta)
+  {
+    return uint8_t((delta << 1) ^ uint8_t(int8_t(delta) >> 7));
+  }
+
+  inline uint8_t unzigzag8(uint8_t value)
+  {
+    return uint8_t((value >> 1) ^ uint8_t(0u - (value & 1)));
+  }
+
+  inline uint16_t zigzag16(uint16_t delta)
+  {
+    return uint16_t((delta << 1) ^ uint16_t(int16_t(delta) >> 15));
+  }
+
+  inline uint16_t unzigzag16(uint16_t value)
+  {
+    return uint16_t((value >> 1) ^ uint16_t(0u - (value & 1)));
+  }
+
+  inline uint32_t zigzag32(uint32_t delta)
+  {
+    return (delta << 1) ^ uint32_t(int32_t(delta) >> 31);
+  }
+
+  inline uint32_t unzigzag32(uint32_t value)
+  {
+    return (value >> 1) ^ (0u - (value & 1));
+  }
+
+  /** Decodes the vertices of a block from begin onwards, one byte at a time */
+  void decodeVerticesScalar(uint8_t *vertices, size_t begin, size_t vertexCount, size_t stride, uint8_t const *data, uint8_t *previous)
+  {
+    for (size_t i = begin; i < vertexCount; i++)
+    {
+      for (size_t k = 0; k < stride; k++)
+      {
+        previous[k] = uint8_t(previous[k] + unzigzag8(data[k * vertexCount + i]));
+        vertices[i * stride + k] = previous[k];
+      }
+    }
+  }
+
+  /** Decodes indices from begin onwards, one index at a time */
+  template <typename T>
+  void decodeIndicesScalar(T *indices, size_t begin, size_t indexCount, uint8_t const *data, T previous)
+  {
+    for (size_t i = begin; i < indexCount; i++)
+    {
+      uint32_t value = 0;
+      for (size_t b = 0; b < sizeof(T); b++)
+      {
+        value |= uint32_t(data[b * indexCount + i]) << (b * 8);
+      }
+
+      previous = T(previous + (sizeof(T) == 2 ? unzigzag16(uint16_t(value)) : unzigzag32(value)));
+      indices[i] = previous;
+    }
+  }
+
+#if defined(MESHING_CODEC_SSE2)
+  // Largest vertex stride decoded with SSE2, which keeps the running sums of every plane in L1
+  constexpr size_t maxSSE2Stride = 64;
+
+  inline __m128i unzigzag8(__m128i value)
+  {
+    __m128i half = _mm_and_si128(_mm_srli_epi16(value, 1), _mm_set1_epi8(0x7f));
+    __m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(value, _mm_set1_epi8(1)));
+    return _mm_xor_si128(half, sign);
+  }
+
+  inline __m128i unzigzag16(__m128i value)
+  {
+    __m128i sign = _mm_sub_epi16(_mm_setzero_si128(), _mm_and_si128(value, _mm_set1_epi16(1)));
+    return _mm_xor_si128(_mm_srli_epi16(value, 1), sign);
+  }
+
+  inline __m128i unzigzag32(__m128i value)
+  {
+    __m128i sign = _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(value, _mm_set1_epi32(1)));
+    return _mm_xor_si128(_mm_srli_epi32(value, 1), sign);
+  }
+
+  /** Running sums over the lanes, continuing from the last lane of previous */
+  inline __m128i prefixSum8(__m128i value, __m128i previous)
+  {
+    value = _mm_add_epi8(value, _mm_slli_si128(value, 1));
+    value = _mm_add_epi8(value, _mm_slli_si128(value, 2));
+    value = _mm_add_epi8(value, _mm_slli_si128(value, 4));
+    value = _mm_add_epi8(value, _mm_slli_si128(value, 8));
+
+    previous = _mm_unpackhi_epi8(previous, previous);
+    previous = _mm_unpackhi_epi16(previous, previous);
+    return _mm_add_epi8(value, _mm_shuffle_epi32(previous, 0xff));
+  }
+
+  inline __m128i prefixSum16(__m128i value, __m128i previous)
+  {
+    value = _mm_add_epi16(value, _mm_slli_si128(value, 2));
+    value = _mm_add_epi16(value, _mm_slli_si128(value, 4));
+    value = _mm_add_epi16(value, _mm_slli_si128(value, 8));
+
+    previous = _mm_unpackhi_epi16(previous, previous);
+    return _mm_add_epi16(value, _mm_shuffle_epi32(previous, 0xff));
+  }
+
+  inline __m128i prefixSum32(__m128i value, __m128i previous)
+  {
+    value = _mm_add_epi32(value, _mm_slli_si128(value, 4));
+    value = _mm_add_epi32(value, _mm_slli_si128(value, 8));
+    return _mm_add_epi32(value, _mm_shuffle_epi32(previous, 0xff));
+  }
+
+  inline void store32(uint8_t *destination, __m128i value)
+  {
+    int32_t bits = _mm_cvtsi128_si32(value);
+    std::memcpy(destination, &bits, sizeof(bits));
+  }
+
+  /**
+   * Decodes the vertices of a block 16 at a time and 4 planes at a time: the planes are summed in registers and transposed back
+   * into 4 bytes of each vertex. Returns the first vertex left for the scalar decoder.
+   */
+  size_t decodeVerticesSSE2(uint8_t *vertices, size_t vertexCount, size_t stride, uint8_t const *data, uint8_t *previous)
+  {
+    if (stride % 4 != 0 || stride > maxSSE2Stride || vertexCount < 16)
+    {
+      return 0;
+    }
+
+    // Last decoded value of every plane, in the last lane
+    __m128i sums[maxSSE2Stride];
+    for (size_t k = 0; k < stride; k++)
+    {
+      sums[k] = _mm_set1_epi8(char(previous[k]));
+    }
+
+    size_t const end = vertexCount / 16 * 16;
+    for (size_t begin = 0; begin < end; begin += 16)
+    {
+      for (size_t k = 0; k < stride; k += 4)
+      {
+        __m128i planes[4];
+        for (size_t p = 0; p < 4; p++)
+        {
+          __m128i deltas = unzigzag8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(data + (k + p) * vertexCount + begin)));
+          planes[p] = sums[k + p] = prefixSum8(deltas, sums[k + p]);
+        }
+
+        __m128i low01 = _mm_unpacklo_epi8(planes[0], planes[1]);
+        __m128i high01 = _mm_unpackhi_epi8(planes[0], planes[1]);
+        __m128i low23 = _mm_unpacklo_epi8(planes[2], planes[3]);
+        __m128i high23 = _mm_unpackhi_epi8(planes[2], planes[3]);
+
+        __m128i quads[4] = {_mm_unpacklo_epi16(low01, low23), _mm_unpackhi_epi16(low01, low23), _mm_unpacklo_epi16(high01, high23), _mm_unpackhi_epi16(high01, high23)};
+        uint8_t *destination = vertices + begin * stride + k;
+        for (size_t q = 0; q < 4; q++)
+        {
+          store32(destination, quads[q]);
+          store32(destination + stride, _mm_srli_si128(quads[q], 4));
+          store32(destination + stride * 2, _mm_srli_si128(quads[q], 8));
+          store32(destination + stride * 3, _mm_srli_si128(quads[q], 12));
+          destination += stride * 4;
+        }
+      }
+    }
+
+    for (size_t k = 0; k < stride; k++)
+    {
+      previous[k] = uint8_t(_mm_extract_epi16(sums[k], 7) >> 8);
+    }
+
+    return end;
+  }
+
+  size_t decodeIndicesSSE2(uint16_t *indices, size_t indexCount, uint8_t const *data, uint16_t &previous)
+  {
+    __m128i sum = _mm_setzero_si128();
+    size_t const end = indexCount / 16 * 16;
+    for (size_t begin = 0; begin < end; begin += 16)
+    {
+      __m128i plane0 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(data + begin));
+      __m128i plane1 = _mm_loadu_si128(reinterpret_cast<__m128i const *>(data + indexCount + begin));
+
+      __m128i low = sum = prefixSum16(unzigzag16(_mm_unpacklo_epi8(plane0, plane1)), sum);
+      __m128i high = sum = prefixSum16(unzigzag16(_mm_unpackhi_epi8(plane0, plane1)), sum);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(indices + begin), low);
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(indices + begin + 8), high);
+    }
+
+    previous = uint16_t(_mm_extract_epi16(sum, 7));
+    return end;
+  }
+
+  size_t decodeIndicesSSE2(uint32_t *indices, size_t indexCount, uint8_t const *data, uint32_t &previous)
+  {
+    __m128i sum = _mm_setzero_si128();
+    size_t const end = indexCount / 16 * 16;
+    for (size_t begin = 0; begin < end; begin += 16)
+    {
+      __m128i planes[4];
+      for (size_t p = 0; p < 4; p++)
+      {
+        planes[p] = _mm_loadu_si128(reinterpret_cast<__m128i const *>(data + p * indexCount + begin));
+      }
+
+      __m128i low01 = _mm_unpacklo_epi8(planes[0], planes[1]);
+      __m128i high01 = _mm_unpackhi_epi8(planes[0], planes[1]);
+      __m128i low23 = _mm_unpacklo_epi8(planes[2], planes[3]);
+      __m128i high23 = _mm_unpackhi_epi8(planes[2], planes[3]);
+
+      __m128i quads[4] = {_mm_unpacklo_epi16(low01, low23), _mm_unpackhi_epi16(low01, low23), _mm_unpacklo_epi16(high01, high23), _mm_unpackhi_epi16(high01, high23)};
+      for (size_t q = 0; q < 4; q++)
+      {
+        sum = prefixSum32(unzigzag32(quads[q]), sum);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(indices + begin + q * 4), sum);
+      }
+    }
+
+    previous = uint32_t(_mm_cvtsi128_si32(_mm_shuffle_epi32(sum, 0xff)));
+    return end;
+  }
+#endif
+} // namespace
+
+void meshing::encodeVertexBuffer(std::vector<uint8_t> &output, uint8_t const *vertices, size_t vertexCount, size_t stride)
+{
+  output.resize(vertexCount * stride);
+
+  std::vector<uint8_t> previous(stride, 0);
+  for (size_t begin = 0; begin < vertexCount; begin += vertexBlockSize)
+  {
+    size_t count = (std::min)(vertexBlockSize, vertexCount - begin);
+    for (size_t k = 0; k < stride; k++)
+    {
+      uint8_t *plane = output.data() + begin * stride + k * count;
+      for (size_t i = 0; i < count; i++)
+      {
+        uint8_t value = vertices[(begin + i) * stride + k];
+        plane[i] = zigzag8(uint8_t(value - previous[k]));
+        previous[k] = value;
+      }
+    }
+  }
+}
+
+bool meshing::decodeVertexBuffer(uint8_t *vertices, size_t vertexCount, size_t stride, uint8_t const *data, size_t size)
+{
+  if (size != vertexCount * stride)
+  {
+    return false;
+  }
+
+  std::vector<uint8_t> previous(stride, 0);
+  for (size_t begin = 0; begin < vertexCount; begin += vertexBlockSize)
+  {
+    size_t count = (std::min)(vertexBlockSize, vertexCount - begin);
+    uint8_t *blockVertices = vertices + begin * stride;
+    uint8_t const *blockData = data + begin * stride;
+
+    size_t decoded = 0;
+#if defined(MESHING_CODEC_SSE2)
+    decoded = decodeVerticesSSE2(blockVertices, count, stride, blockData, previous.data());
+#endif
+    decodeVerticesScalar(blockVertices, decoded, count, stride, blockData, previous.data());
+  }
+
+  return true;
+}
+
+void meshing::encodeIndexBuffer(std::vector<uint8_t> &output, std::vector<uint32_t> const &indices, uint32_t indexSize)
+{
+  size_t const indexCount = indices.size();
+  output.resize(indexCount * indexSize);
+
+  uint32_t previous = 0;
+  for (size_t i = 0; i < indexCount; i++)
+  {
+    uint32_t delta = indexSize == 2 ? zigzag16(uint16_t(indices[i] - previous)) : zigzag32(indices[i] - previous);
+    for (uint32_t b = 0; b < indexSize; b++)
+    {
+      output[b * indexCount + i] = uint8_t(delta >> (b * 8));
+    }
+    previous = indices[i];
+  }
+}
+
+bool meshing::decodeIndexBuffer(void *indices, size_t indexCount, uint32_t indexSize, uint8_t const *data, size_t size)
+{
+  if ((indexSize != 2 && indexSize != 4) || size != indexCount * indexSize)
+  {
+    return false;
+  }
+
+  size_t begin = 0;
+  if (indexSize == 2)
+  {
+    uint16_t previous = 0;
+#if defined(MESHING_CODEC_SSE2)
+    begin = decodeIndicesSSE2(static_cast<uint16_t *>(indices), indexCount, data, previous);
+#endif
+    decodeIndicesScalar(static_cast<uint16_t *>(indices), begin, indexCount, data, previous);
+  }
+  else
+  {
+    uint32_t previous = 0;
+#if defined(MESHING_CODEC_SSE2)
+    begin = decodeIndicesSSE2(static_cast<uint32_t *>(indices), indexCount, data, previous);
+#endif
+    decodeIndicesScalar(static_cast<uint32_t *>(indices), begin, indexCount, data, previous);
+  }
+
+  return true;
+}
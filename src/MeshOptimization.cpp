@@ -0,0 +1,359 @@
+#include "MeshOptimization.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+  /**
+   * FIFO cache simulation with timestamps: a vertex is cached if it was transformed less than cacheSize transforms ago.
+   * Advancing the timestamp past cacheSize flushes the cache.
+   */
+  struct CacheSimulation
+  {
+    std::vector<uint32_t> timestamps;
+    uint32_t time;
+    uint32_t cacheSize;
+
+    CacheSimulation(size_t vertexCount, uint32_t size)
+      : timestamps(vertexCount, 0)
+      , time(size + 1)
+      , cacheSize(size)
+    {
+    }
+
+    uint32_t transform(uint32_t vertex)
+    {
+      if (time - timestamps[vertex] > cacheSize)
+      {
+        timestamps[vertex] = time++;
+        return 1;
+      }
+
+      return 0;
+    }
+
+    uint32_t transform(uint32_t a, uint32_t b, uint32_t c)
+    {
+      return transform(a) + transform(b) + transform(c);
+    }
+
+    void flush()
+    {
+      time += cacheSize + 1;
+    }
+  };
+
+  /** Triangles that reference each vertex, as offsets into one flat list */
+  struct TriangleAdjacency
+  {
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+
+    TriangleAdjacency(std::vector<uint32_t> const &indices, size_t vertexCount)
+      : offsets(vertexCount + 1, 0)
+      , triangles(indices.size())
+    {
+      for (uint32_t index : indices)
+      {
+        offsets[index + 1]++;
+      }
+
+      std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+      std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+      for (size_t i = 0; i < indices.size(); i++)
+      {
+        triangles[fill[indices[i]]++] = uint32_t(i / 3);
+      }
+    }
+  };
+} // namespace
+
+meshing::VertexCacheStatistics meshing::analyzeVertexCache(std::vector<uint32_t> const &indices, size_t vertexCount, uint32_t cacheSize)
+{
+  VertexCacheStatistics statistics;
+  if (indices.size() < 3)
+  {
+    return statistics;
+  }
+
+  CacheSimulation cache(vertexCount, cacheSize);
+  std::vector<bool> referenced(vertexCount, false);
+  uint64_t referencedCount = 0;
+  for (uint32_t index : indices)
+  {
+    statistics.misses += cache.transform(index);
+    if (!referenced[index])
+    {
+      referenced[index] = true;
+      referencedCount++;
+    }
+  }
+
+  statistics.acmr = float(statistics.misses) / float(indices.size() / 3);
+  statistics.atvr = float(statistics.misses) / float(referencedCount);
+  return statistics;
+}
+
+void meshing::optimizeVertexCache(std::vector<uint32_t> &indices, size_t vertexCount, uint32_t cacheSize)
+{
+  size_t triangleCount = indices.size() / 3;
+  if (triangleCount == 0)
+  {
+    return;
+  }
+
+  TriangleAdjacency adjacency(indices, vertexCount);
+
+  std::vector<uint32_t> liveTriangles(vertexCount);
+  for (size_t i = 0; i < vertexCount; i++)
+  {
+    liveTriangles[i] = adjacency.offsets[i + 1] - adjacency.offsets[i];
+  }
+
+  std::vector<uint32_t> cacheTimestamps(vertexCount, 0);
+  std::vector<bool> emitted(triangleCount, false);
+  std::vector<uint32_t> deadEnds;
+  std::vector<uint32_t> candidates;
+  std::vector<uint32_t> output;
+  output.reserve(indices.size());
+
+  uint32_t timestamp = cacheSize + 1;
+  size_t scanCursor = 0;
+  int64_t fanningVertex = 0;
+
+  while (fanningVertex >= 0)
+  {
+    // Emit every remaining triangle around the fanning vertex
+    candidates.clear();
+    for (uint32_t a = adjacency.offsets[fanningVertex]; a < adjacency.offsets[fanningVertex + 1]; a++)
+    {
+      uint32_t triangle = adjacency.triangles[a];
+      if (emitted[triangle])
+      {
+        continue;
+      }
+
+      for (uint32_t corner = 0; corner < 3; corner++)
+      {
+        uint32_t vertex = indices[triangle * 3 + corner];
+        output.push_back(vertex);
+        deadEnds.push_back(vertex);
+        candidates.push_back(vertex);
+        liveTriangles[vertex]--;
+
+        if (timestamp - cacheTimestamps[vertex] > cacheSize)
+        {
+          cacheTimestamps[vertex] = timestamp++;
+        }
+      }
+
+      emitted[triangle] = true;
+    }
+
+    // Continue with the candidate that stays in the cache for all of its remaining triangles and entered it the earliest
+    fanningVertex = -1;
+    int64_t bestPriority = -1;
+    for (uint32_t vertex : candidates)
+    {
+      if (liveTriangles[vertex] == 0)
+      {
+        continue;
+      }
+
+      int64_t priority = 0;
+      int64_t age = int64_t(timestamp - cacheTimestamps[vertex]);
+      if (age + 2 * int64_t(liveTriangles[vertex]) <= int64_t(cacheSize))
+      {
+        priority = age;
+      }
+
+      if (priority > bestPriority)
+      {
+        bestPriority = priority;
+        fanningVertex = vertex;
+      }
+    }
+
+    if (fanningVertex >= 0)
+    {
+      continue;
+    }
+
+    // Dead end, go back to the most recently emitted vertex with live triangles, or scan for the next one
+    while (!deadEnds.empty())
+    {
+      uint32_t vertex = deadEnds.back();
+      deadEnds.pop_back();
+      if (liveTriangles[vertex] > 0)
+      {
+        fanningVertex = vertex;
+        break;
+      }
+    }
+
+    while (fanningVertex < 0 && scanCursor < vertexCount)
+    {
+      if (liveTriangles[scanCursor] > 0)
+      {
+        fanningVertex = int64_t(scanCursor);
+      }
+      scanCursor++;
+    }
+  }
+
+  indices.swap(output);
+}
+
+void meshing::optimizeOverdraw(std::vector<uint32_t> &indices, std::vector<KXF::Vertex> const &vertices, float threshold, uint32_t cacheSize)
+{
+  size_t triangleCount = indices.size() / 3;
+  if (triangleCount == 0)
+  {
+    return;
+  }
+
+  CacheSimulation cache(vertices.size(), cacheSize);
+
+  // Hard boundaries, where a triangle misses all three vertices the cache optimized list starts a new patch of the mesh
+  std::vector<uint32_t> hardClusters;
+  for (size_t i = 0; i < triangleCount; i++)
+  {
+    uint32_t misses = cache.transform(indices[i * 3], indices[i * 3 + 1], indices[i * 3 + 2]);
+    if (i == 0 || misses == 3)
+    {
+      hardClusters.push_back(uint32_t(i));
+    }
+  }
+  hardClusters.push_back(uint32_t(triangleCount));
+
+  // Soft boundaries, each patch is split wherever the cluster so far is about as cache efficient as the whole patch
+  std::vector<uint32_t> clusters;
+  for (size_t h = 0; h + 1 < hardClusters.size(); h++)
+  {
+    uint32_t begin = hardClusters[h];
+    uint32_t end = hardClusters[h + 1];
+
+    cache.flush();
+    uint32_t patchMisses = 0;
+    for (uint32_t i = begin; i < end; i++)
+    {
+      patchMisses += cache.transform(indices[i * 3], indices[i * 3 + 1], indices[i * 3 + 2]);
+    }
+    float clusterThreshold = threshold * float(patchMisses) / float(end - begin);
+
+    cache.flush();
+    uint32_t clusterBegin = begin;
+    uint32_t clusterMisses = 0;
+    for (uint32_t i = begin; i < end; i++)
+    {
+      clusterMisses += cache.transform(indices[i * 3], indices[i * 3 + 1], indices[i * 3 + 2]);
+      if (float(clusterMisses) / float(i + 1 - clusterBegin) <= clusterThreshold)
+      {
+        clusters.push_back(clusterBegin);
+        clusterBegin = i + 1;
+        clusterMisses = 0;
+        cache.flush();
+      }
+    }
+
+    if (clusterBegin < end)
+    {
+      clusters.push_back(clusterBegin);
+    }
+  }
+  clusters.push_back(uint32_t(triangleCount));
+
+  size_t clusterCount = clusters.size() - 1;
+
+  // Area weighted centroids and normals, per cluster and for the whole mesh
+  std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3(0.0f));
+  std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+  glm::vec3 meshCentroid(0.0f);
+  float meshArea = 0.0f;
+  for (size_t c = 0; c < clusterCount; c++)
+  {
+    float clusterArea = 0.0f;
+    for (uint32_t i = clusters[c]; i < clusters[c + 1]; i++)
+    {
+      glm::vec3 p0 = glm::vec3(vertices[indices[i * 3]].position);
+      glm::vec3 p1 = glm::vec3(vertices[indices[i * 3 + 1]].position);
+      glm::vec3 p2 = glm::vec3(vertices[indices[i * 3 + 2]].position);
+
+      glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+      float area = glm::length(normal);
+
+      clusterCentroids[c] += (p0 + p1 + p2) * (area / 3.0f);
+      clusterNormals[c] += normal;
+      clusterArea += area;
+    }
+
+    meshCentroid += clusterCentroids[c];
+    meshArea += clusterArea;
+    clusterCentroids[c] = clusterArea > 0.0f ? clusterCentroids[c] * (1.0f / clusterArea) : glm::vec3(vertices[indices[clusters[c] * 3]].position);
+  }
+
+  if (meshArea > 0.0f)
+  {
+    meshCentroid = meshCentroid * (1.0f / meshArea);
+  }
+
+  // Clusters facing away from the center occlude the ones facing it, so they are drawn first
+  std::vector<float> sortKeys(clusterCount);
+  for (size_t c = 0; c < clusterCount; c++)
+  {
+    float normalLength = glm::length(clusterNormals[c]);
+    sortKeys[c] = normalLength > 0.0f ? glm::dot(clusterCentroids[c] - meshCentroid, clusterNormals[c]) / normalLength : 0.0f;
+  }
+
+  std::vector<uint32_t> order(clusterCount);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+    return sortKeys[a] > sortKeys[b];
+  });
+
+  std::vector<uint32_t> output;
+  output.reserve(indices.size());
+  for (uint32_t c : order)
+  {
+    output.insert(output.end(), indices.begin() + size_t(clusters[c]) * 3, indices.begin() + size_t(clusters[c + 1]) * 3);
+  }
+
+  indices.swap(output);
+}
+
+size_t meshing::optimizeVertexFetch(std::vector<KXF::Vertex> &vertices, std::vector<uint32_t> &indices)
+{
+  constexpr uint32_t unassigned = UINT32_MAX;
+  std::vector<uint32_t> remap(vertices.size(), unassigned);
+  std::vector<KXF::Vertex> output;
+  output.reserve(vertices.size());
+
+  for (uint32_t &index : indices)
+  {
+    if (remap[index] == unassigned)
+    {
+      remap[index] = uint32_t(output.size());
+      output.push_back(vertices[index]);
+    }
+
+    index = remap[index];
+  }
+
+  output.shrink_to_fit();
+  vertices.swap(output);
+  return vertices.size();
+}
+
+void meshing::optimizeSubmesh(KXF::Submesh *submesh, float overdrawThreshold, VertexCacheStatistics &before, VertexCacheStatistics &after)
+{
+  before = analyzeVertexCache(submesh->indices, submesh->vertices.size());
+
+  optimizeVertexCache(submesh->indices, submesh->vertices.size());
+  optimizeOverdraw(submesh->indices, submesh->vertices, overdrawThreshold);
+  optimizeVertexFetch(submesh->vertices, submesh->indices);
+
+  after = analyzeVertexCache(submesh->indices, submesh->vertices.size());
+}
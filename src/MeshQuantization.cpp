@@ -0,0 +1,254 @@
+#include "MeshQuantization.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+  uint16_t quantizeUnorm16(float value)
+  {
+    value = (std::min)((std::max)(value, 0.0f), 1.0f);
+    return uint16_t(value * 65535.0f + 0.5f);
+  }
+
+  int16_t quantizeSnorm16(float value)
+  {
+    value = (std::min)((std::max)(value, -1.0f), 1.0f);
+    return int16_t(value * 32767.0f + (value >= 0.0f ? 0.5f : -0.5f));
+  }
+
+  uint32_t packSnorm16x2(glm::vec2 const &value)
+  {
+    return uint32_t(uint16_t(quantizeSnorm16(value.x))) | (uint32_t(uint16_t(quantizeSnorm16(value.y))) << 16);
+  }
+
+  /** Copies one encoded attribute of every vertex into its place in the interleaved buffer */
+  template <typename T>
+  void interleave(meshing::QuantizedVertices &output, uint32_t &offset, std::vector<T> const &attribute)
+  {
+    for (size_t i = 0; i < attribute.size(); i++)
+    {
+      std::memcpy(output.data.data() + i * output.stride + offset, &attribute[i], sizeof(T));
+    }
+
+    offset += uint32_t(sizeof(T));
+  }
+} // namespace
+
+uint16_t meshing::quantizeHalf(float value)
+{
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+
+  uint32_t sign = (bits >> 16) & 0x8000;
+  uint32_t magnitude = bits & 0x7fffffff;
+
+  // Rebias the exponent from 127 to 15 and round the mantissa from 23 to 10 bits
+  uint32_t half = (magnitude - (112u << 23) + (1u << 12)) >> 13;
+
+  // Below the smallest normal half flushes to zero, past the largest goes to infinity, and NaN stays NaN
+  half = magnitude < (113u << 23) ? 0u : half;
+  half = magnitude >= (143u << 23) ? 0x7c00u : half;
+  half = magnitude > (255u << 23) ? 0x7e00u : half;
+
+  return uint16_t(sign | half);
+}
+
+glm::vec2 meshing::encodeOctahedral(glm::vec3 const &direction)
+{
+  float length = std::fabs(direction.x) + std::fabs(direction.y) + std::fabs(direction.z);
+  float inverse = length > 0.0f ? 1.0f / length : 0.0f;
+  float x = direction.x * inverse;
+  float y = direction.y * inverse;
+
+  // The lower hemisphere folds over the diagonals, written as selects so the loops calling this vectorize
+  float foldedX = (1.0f - std::fabs(y)) * std::copysign(1.0f, x);
+  float foldedY = (1.0f - std::fabs(x)) * std::copysign(1.0f, y);
+  bool lower = direction.z < 0.0f;
+  return glm::vec2(lower ? foldedX : x, lower ? foldedY : y);
+}
+
+void meshing::quantizeVertices(QuantizedVertices &output, std::vector<KXF::Vertex> const &vertices, KXF::VertexFlags flags)
+{
+  size_t const vertexCount = vertices.size();
+  int64_t const count = int64_t(vertexCount);
+
+  output.flags = flags;
+  output.vertexCount = uint32_t(vertexCount);
+  output.boneIndexSize = 1;
+
+  glm::vec3 minimum(FLT_MAX);
+  glm::vec3 maximum(-FLT_MAX);
+  for (auto const &vertex : vertices)
+  {
+    for (int c = 0; c < 3; c++)
+    {
+      minimum[c] = (std::min)(minimum[c], vertex.position[c]);
+      maximum[c] = (std::max)(maximum[c], vertex.position[c]);
+    }
+  }
+
+  if (vertexCount == 0)
+  {
+    minimum = maximum = glm::vec3(0.0f);
+  }
+
+  glm::vec3 inverseExtent(0.0f);
+  output.positionOffset = minimum;
+  for (int c = 0; c < 3; c++)
+  {
+    float extent = maximum[c] - minimum[c];
+    output.positionScale[c] = extent / 65535.0f;
+    inverseExtent[c] = extent > 0.0f ? 1.0f / extent : 0.0f;
+  }
+
+  if (flags & KXF::VF_Bones)
+  {
+    for (auto const &vertex : vertices)
+    {
+      if ((std::max)((std::max)(vertex.bones.x, vertex.bones.y), (std::max)(vertex.bones.z, vertex.bones.w)) > 255)
+      {
+        output.boneIndexSize = 2;
+        break;
+      }
+    }
+  }
+
+  KXF::VertexFlags const texCoordFlags[4] = {KXF::VF_TexCoords1, KXF::VF_TexCoords2, KXF::VF_TexCoords3, KXF::VF_TexCoords4};
+
+  output.stride = 8;
+  output.stride += (flags & KXF::VF_Normal) ? 4 : 0;
+  output.stride += (flags & KXF::VF_Tangent) ? 4 : 0;
+  for (auto texCoordFlag : texCoordFlags)
+  {
+    output.stride += (flags & texCoordFlag) ? 4 : 0;
+  }
+  output.stride += (flags & KXF::VF_Bones) ? output.boneIndexSize * 4 + 4 : 0;
+
+  output.data.assign(vertexCount * output.stride, 0);
+  uint32_t offset = 0;
+
+  // Every attribute is encoded into its own array first, which keeps the loops free of the interleaving and lets them vectorize
+  {
+    std::vector<uint64_t> positions(vertexCount);
+    bool const tangents = (flags & KXF::VF_Tangent) != 0;
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+    for (int64_t i = 0; i < count; i++)
+    {
+      glm::vec4 const &position = vertices[i].position;
+      uint64_t x = quantizeUnorm16((position.x - minimum.x) * inverseExtent.x);
+      uint64_t y = quantizeUnorm16((position.y - minimum.y) * inverseExtent.y);
+      uint64_t z = quantizeUnorm16((position.z - minimum.z) * inverseExtent.z);
+      uint64_t w = tangents && vertices[i].tangent.w < 0.0f ? 0 : 65535;
+      positions[i] = x | (y << 16) | (z << 32) | (w << 48);
+    }
+    interleave(output, offset, positions);
+  }
+
+  if (flags & KXF::VF_Normal)
+  {
+    std::vector<uint32_t> normals(vertexCount);
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+    for (int64_t i = 0; i < count; i++)
+    {
+      normals[i] = packSnorm16x2(encodeOctahedral(glm::vec3(vertices[i].normal)));
+    }
+    interleave(output, offset, normals);
+  }
+
+  if (flags & KXF::VF_Tangent)
+  {
+    std::vector<uint32_t> tangents(vertexCount);
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+    for (int64_t i = 0; i < count; i++)
+    {
+      tangents[i] = packSnorm16x2(encodeOctahedral(glm::vec3(vertices[i].tangent)));
+    }
+    interleave(output, offset, tangents);
+  }
+
+  for (int t = 0; t < 4; t++)
+  {
+    if (!(flags & texCoordFlags[t]))
+    {
+      continue;
+    }
+
+    std::vector<uint32_t> texCoords(vertexCount);
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+    for (int64_t i = 0; i < count; i++)
+    {
+      KXF::Vertex const &vertex = vertices[i];
+      glm::vec4 const &texCoord = t == 0 ? vertex.texCoords1 : t == 1 ? vertex.texCoords2 : t == 2 ? vertex.texCoords3 : vertex.texCoords4;
+      texCoords[i] = uint32_t(quantizeHalf(texCoord.x)) | (uint32_t(quantizeHalf(texCoord.y)) << 16);
+    }
+    interleave(output, offset, texCoords);
+  }
+
+  if (flags & KXF::VF_Bones)
+  {
+    if (output.boneIndexSize == 1)
+    {
+      std::vector<uint32_t> bones(vertexCount);
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+      for (int64_t i = 0; i < count; i++)
+      {
+        glm::uvec4 const &b = vertices[i].bones;
+        bones[i] = b.x | (b.y << 8) | (b.z << 16) | (b.w << 24);
+      }
+      interleave(output, offset, bones);
+    }
+    else
+    {
+      std::vector<uint64_t> bones(vertexCount);
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+      for (int64_t i = 0; i < count; i++)
+      {
+        glm::uvec4 const &b = vertices[i].bones;
+        bones[i] = uint64_t(b.x & 0xffff) | (uint64_t(b.y & 0xffff) << 16) | (uint64_t(b.z & 0xffff) << 32) | (uint64_t(b.w & 0xffff) << 48);
+      }
+      interleave(output, offset, bones);
+    }
+
+    // Weights are normalized, and the rounding error goes to the largest one so they sum to exactly 255
+    std::vector<uint32_t> weights(vertexCount);
+    for (int64_t i = 0; i < count; i++)
+    {
+      glm::vec4 const &w = vertices[i].weights;
+      float sum = w.x + w.y + w.z + w.w;
+      float scale = sum > 0.0f ? 255.0f / sum : 0.0f;
+
+      int32_t q[4];
+      int32_t total = 0;
+      uint32_t largest = 0;
+      for (uint32_t c = 0; c < 4; c++)
+      {
+        q[c] = int32_t((std::max)(w[c], 0.0f) * scale + 0.5f);
+        total += q[c];
+        largest = w[c] > w[largest] ? c : largest;
+      }
+
+      if (sum > 0.0f)
+      {
+        q[largest] += 255 - total;
+      }
+
+      weights[i] = uint32_t(q[0]) | (uint32_t(q[1]) << 8) | (uint32_t(q[2]) << 16) | (uint32_t(q[3]) << 24);
+    }
+    interleave(output, offset, weights);
+  }
+}
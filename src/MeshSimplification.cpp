@@ -0,0 +1,581 @@
+#include "MeshSimplification.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace
+{
+  enum VertexKind : uint8_t
+  {
+    VK_Manifold, // Interior vertex, can collapse onto any neighbour
+    VK_Border,   // On an open border of the mesh, can only collapse along the border
+    VK_Seam,     // One of two vertices split by an attribute seam, can only collapse along the seam
+    VK_Locked    // Corners, seam ends and anything more complex
+  };
+
+  constexpr uint32_t noEdge = UINT32_MAX;
+  constexpr uint32_t multipleEdges = UINT32_MAX - 1;
+
+  // Borders and seams are held in place by planes perpendicular to them, with this much weight per unit of length
+  constexpr float edgeWeight = 10.0f;
+
+  struct Quadric
+  {
+    float a00 = 0.0f, a11 = 0.0f, a22 = 0.0f;
+    float a10 = 0.0f, a20 = 0.0f, a21 = 0.0f;
+    float b0 = 0.0f, b1 = 0.0f, b2 = 0.0f;
+    float c = 0.0f;
+    float weight = 0.0f;
+
+    /** Adds the squared distance to the plane dot(normal, p) + distance = 0 */
+    void addPlane(glm::vec3 const &normal, float distance, float planeWeight)
+    {
+      a00 += planeWeight * normal.x * normal.x;
+      a11 += planeWeight * normal.y * normal.y;
+      a22 += planeWeight * normal.z * normal.z;
+      a10 += planeWeight * normal.y * normal.x;
+      a20 += planeWeight * normal.z * normal.x;
+      a21 += planeWeight * normal.z * normal.y;
+      b0 += planeWeight * normal.x * distance;
+      b1 += planeWeight * normal.y * distance;
+      b2 += planeWeight * normal.z * distance;
+      c += planeWeight * distance * distance;
+      weight += planeWeight;
+    }
+
+    void add(Quadric const &other)
+    {
+      a00 += other.a00;
+      a11 += other.a11;
+      a22 += other.a22;
+      a10 += other.a10;
+      a20 += other.a20;
+      a21 += other.a21;
+      b0 += other.b0;
+      b1 += other.b1;
+      b2 += other.b2;
+      c += other.c;
+      weight += other.weight;
+    }
+
+    /** Weighted mean squared distance from p to the planes */
+    float error(glm::vec3 const &p) const
+    {
+      float r = a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z;
+      r += 2.0f * (a10 * p.x * p.y + a20 * p.x * p.z + a21 * p.y * p.z);
+      r += 2.0f * (b0 * p.x + b1 * p.y + b2 * p.z);
+      r += c;
+      return weight > 0.0f ? std::fabs(r) / weight : 0.0f;
+    }
+  };
+
+  struct Collapse
+  {
+    uint32_t vertex;
+    uint32_t target;
+    float cost;
+  };
+
+  uint64_t edgeKey(uint32_t a, uint32_t b)
+  {
+    return (uint64_t(a) << 32) | b;
+  }
+
+  /** Sorted half edges of a triangle list, for opposite edge lookups */
+  struct EdgeSet
+  {
+    std::vector<uint64_t> edges;
+
+    void build(std::vector<uint32_t> const &indices, std::vector<uint32_t> const *remap)
+    {
+      edges.resize(indices.size());
+      for (size_t i = 0; i < indices.size(); i += 3)
+      {
+        for (uint32_t e = 0; e < 3; e++)
+        {
+          uint32_t a = indices[i + e];
+          uint32_t b = indices[i + (e + 1) % 3];
+          edges[i + e] = remap ? edgeKey((*remap)[a], (*remap)[b]) : edgeKey(a, b);
+        }
+      }
+      std::sort(edges.begin(), edges.end());
+    }
+
+    bool contains(uint32_t a, uint32_t b) const
+    {
+      return std::binary_search(edges.begin(), edges.end(), edgeKey(a, b));
+    }
+  };
+
+  /** Maps every vertex to the first vertex with the same position, and links the vertices sharing a position in a ring */
+  void buildPositionRemap(std::vector<KXF::Vertex> const &vertices, std::vector<uint32_t> &remap, std::vector<uint32_t> &wedges)
+  {
+    size_t vertexCount = vertices.size();
+    remap.resize(vertexCount);
+    wedges.resize(vertexCount);
+
+    size_t tableSize = 1;
+    while (tableSize < vertexCount * 2)
+    {
+      tableSize <<= 1;
+    }
+    std::vector<uint32_t> table(tableSize, noEdge);
+
+    auto bits = [](float value) {
+      uint32_t result;
+      value = value == 0.0f ? 0.0f : value;
+      std::memcpy(&result, &value, sizeof(result));
+      return result;
+    };
+
+    for (uint32_t i = 0; i < vertexCount; i++)
+    {
+      glm::vec4 const &p = vertices[i].position;
+      uint64_t hash = (uint64_t(bits(p.x)) * 73856093ull) ^ (uint64_t(bits(p.y)) * 19349663ull) ^ (uint64_t(bits(p.z)) * 83492791ull);
+      hash ^= hash >> 29;
+
+      for (size_t slot = hash & (tableSize - 1);; slot = (slot + 1) & (tableSize - 1))
+      {
+        uint32_t candidate = table[slot];
+        if (candidate == noEdge)
+        {
+          table[slot] = i;
+          remap[i] = i;
+          wedges[i] = i;
+          break;
+        }
+
+        glm::vec4 const &q = vertices[candidate].position;
+        if (p.x == q.x && p.y == q.y && p.z == q.z)
+        {
+          remap[i] = candidate;
+          wedges[i] = wedges[candidate];
+          wedges[candidate] = i;
+          break;
+        }
+      }
+    }
+  }
+
+  /** Sum of the absolute bone weight differences, 0 for identical skinning and 2 for entirely different bones */
+  float skinDistance(KXF::Vertex const &a, KXF::Vertex const &b)
+  {
+    float distance = 0.0f;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+      float matched = 0.0f;
+      for (uint32_t j = 0; j < 4; j++)
+      {
+        if (b.weights[j] > 0.0f && b.bones[j] == a.bones[i])
+        {
+          matched = b.weights[j];
+          break;
+        }
+      }
+      distance += std::fabs(a.weights[i] - matched);
+    }
+
+    for (uint32_t j = 0; j < 4; j++)
+    {
+      bool found = false;
+      for (uint32_t i = 0; i < 4; i++)
+      {
+        if (a.weights[i] > 0.0f && a.bones[i] == b.bones[j])
+        {
+          found = true;
+          break;
+        }
+      }
+
+      if (!found)
+      {
+        distance += b.weights[j];
+      }
+    }
+
+    return distance;
+  }
+} // namespace
+
+float meshing::simplify(std::vector<uint32_t> &destination, KXF::Submesh const *submesh, SimplifySettings const &settings)
+{
+  auto const &vertices = submesh->vertices;
+  size_t const vertexCount = vertices.size();
+
+  destination = submesh->indices;
+  size_t const targetTriangleCount = size_t(double(destination.size() / 3) * (glm::max)(settings.ratio, 0.0f));
+  if (vertexCount == 0 || destination.size() / 3 <= targetTriangleCount)
+  {
+    return 0.0f;
+  }
+
+  // Positions are normalized to the unit cube, so that errors are relative to the submesh extent
+  glm::vec3 minimum(FLT_MAX);
+  glm::vec3 maximum(-FLT_MAX);
+  for (auto const &vertex : vertices)
+  {
+    minimum = glm::min(minimum, glm::vec3(vertex.position));
+    maximum = glm::max(maximum, glm::vec3(vertex.position));
+  }
+  glm::vec3 size = maximum - minimum;
+  float extent = (glm::max)(size.x, (glm::max)(size.y, size.z));
+  float scale = extent > 0.0f ? 1.0f / extent : 1.0f;
+
+  std::vector<glm::vec3> positions(vertexCount);
+  for (size_t i = 0; i < vertexCount; i++)
+  {
+    positions[i] = (glm::vec3(vertices[i].position) - minimum) * scale;
+  }
+
+  std::vector<uint32_t> remap;
+  std::vector<uint32_t> wedges;
+  buildPositionRemap(vertices, remap, wedges);
+
+  // Open edges have no opposite half edge. Open in attribute space but not in position space means an attribute seam
+  EdgeSet edges;
+  EdgeSet positionEdges;
+  edges.build(destination, nullptr);
+  positionEdges.build(destination, &remap);
+
+  std::vector<uint32_t> openIn(vertexCount, noEdge);
+  std::vector<uint32_t> openOut(vertexCount, noEdge);
+  for (size_t i = 0; i < destination.size(); i += 3)
+  {
+    for (uint32_t e = 0; e < 3; e++)
+    {
+      uint32_t a = destination[i + e];
+      uint32_t b = destination[i + (e + 1) % 3];
+      if (!edges.contains(b, a))
+      {
+        openOut[a] = openOut[a] == noEdge ? b : multipleEdges;
+        openIn[b] = openIn[b] == noEdge ? a : multipleEdges;
+      }
+    }
+  }
+
+  auto isSingle = [](uint32_t edge) {
+    return edge != noEdge && edge != multipleEdges;
+  };
+
+  std::vector<uint8_t> kinds(vertexCount, VK_Locked);
+  for (uint32_t i = 0; i < vertexCount; i++)
+  {
+    uint32_t wedgeCount = 1;
+    for (uint32_t w = wedges[i]; w != i; w = wedges[w])
+    {
+      wedgeCount++;
+    }
+
+    if (wedgeCount == 1)
+    {
+      if (openIn[i] == noEdge && openOut[i] == noEdge)
+      {
+        kinds[i] = VK_Manifold;
+      }
+      else if (isSingle(openIn[i]) && isSingle(openOut[i]) && !positionEdges.contains(remap[openOut[i]], remap[i]) && !positionEdges.contains(remap[i], remap[openIn[i]]))
+      {
+        kinds[i] = VK_Border;
+      }
+    }
+    else if (wedgeCount == 2)
+    {
+      // Both sides of the seam have exactly one open edge in and out, and they mirror each other
+      uint32_t w = wedges[i];
+      if (isSingle(openIn[i]) && isSingle(openOut[i]) && isSingle(openIn[w]) && isSingle(openOut[w]) && remap[openOut[i]] == remap[openIn[w]] && remap[openIn[i]] == remap[openOut[w]])
+      {
+        kinds[i] = VK_Seam;
+      }
+    }
+  }
+
+  // Quadrics live on the position, shared by every vertex there
+  std::vector<Quadric> quadrics(vertexCount);
+  for (size_t i = 0; i < destination.size(); i += 3)
+  {
+    uint32_t corners[3] = {destination[i], destination[i + 1], destination[i + 2]};
+    glm::vec3 normal = glm::cross(positions[corners[1]] - positions[corners[0]], positions[corners[2]] - positions[corners[0]]);
+    float area = glm::length(normal);
+    if (area <= 0.0f)
+    {
+      continue;
+    }
+    normal = normal * (1.0f / area);
+
+    Quadric plane;
+    plane.addPlane(normal, -glm::dot(normal, positions[corners[0]]), area);
+    for (uint32_t e = 0; e < 3; e++)
+    {
+      quadrics[remap[corners[e]]].add(plane);
+    }
+
+    for (uint32_t e = 0; e < 3; e++)
+    {
+      uint32_t a = corners[e];
+      uint32_t b = corners[(e + 1) % 3];
+      if (edges.contains(b, a))
+      {
+        continue;
+      }
+
+      glm::vec3 direction = positions[b] - positions[a];
+      float length = glm::length(direction);
+      glm::vec3 perpendicular = glm::cross(direction, normal);
+      float perpendicularLength = glm::length(perpendicular);
+      if (perpendicularLength <= 0.0f)
+      {
+        continue;
+      }
+      perpendicular = perpendicular * (1.0f / perpendicularLength);
+
+      Quadric edgePlane;
+      edgePlane.addPlane(perpendicular, -glm::dot(perpendicular, positions[a]), length * edgeWeight);
+      quadrics[remap[a]].add(edgePlane);
+      quadrics[remap[b]].add(edgePlane);
+    }
+  }
+
+  bool const skinned = (submesh->vertexFlags & KXF::VF_Bones) != 0;
+  auto collapseCost = [&](uint32_t vertex, uint32_t target) {
+    float cost = quadrics[remap[vertex]].error(positions[target]);
+    if (skinned)
+    {
+      float distance = skinDistance(vertices[vertex], vertices[target]);
+      cost += settings.skinWeight * distance * distance;
+    }
+    return cost;
+  };
+
+  auto canCollapse = [&](uint32_t vertex, uint32_t target, bool open) {
+    switch (kinds[vertex])
+    {
+    case VK_Manifold:
+      return true;
+    case VK_Border:
+      return open && kinds[target] == VK_Border;
+    case VK_Seam:
+      return open && kinds[target] == VK_Seam && (edges.contains(wedges[vertex], wedges[target]) || edges.contains(wedges[target], wedges[vertex]));
+    default:
+      return false;
+    }
+  };
+
+  std::vector<uint32_t> collapseRemap(vertexCount);
+  std::iota(collapseRemap.begin(), collapseRemap.end(), 0);
+  std::vector<uint8_t> collapseLocked(vertexCount, 0);
+  std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+  std::vector<uint32_t> adjacency;
+  std::vector<Collapse> collapses;
+
+  /** Whether replacing the vertex with the target turns any of the triangles around it over */
+  auto hasTriangleFlips = [&](uint32_t vertex, uint32_t target) {
+    uint32_t position = remap[vertex];
+    for (uint32_t a = adjacencyOffsets[position]; a < adjacencyOffsets[position + 1]; a++)
+    {
+      uint32_t triangle = adjacency[a];
+      uint32_t corners[3];
+      uint32_t replaced = 3;
+      bool collapses = false;
+      for (uint32_t e = 0; e < 3; e++)
+      {
+        corners[e] = collapseRemap[destination[triangle * 3 + e]];
+        if (remap[corners[e]] == position)
+        {
+          replaced = e;
+        }
+        else if (remap[corners[e]] == remap[target])
+        {
+          collapses = true;
+        }
+      }
+
+      if (collapses || replaced == 3)
+      {
+        continue;
+      }
+
+      glm::vec3 p0 = positions[corners[0]];
+      glm::vec3 p1 = positions[corners[1]];
+      glm::vec3 p2 = positions[corners[2]];
+      glm::vec3 before = glm::cross(p1 - p0, p2 - p0);
+      if (before.x == 0.0f && before.y == 0.0f && before.z == 0.0f)
+      {
+        // Already degenerate, like the triangles around the poles of a UV sphere, so there's nothing to flip
+        continue;
+      }
+
+      glm::vec3 moved[3] = {p0, p1, p2};
+      moved[replaced] = positions[target];
+      glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+
+      // Rejecting at about 75 degrees rather than 90 keeps a series of collapses from flipping a triangle bit by bit
+      if (glm::dot(before, after) <= 0.25f * glm::length(before) * glm::length(after))
+      {
+        return true;
+      }
+    }
+
+    return false;
+  };
+
+  float const errorLimit = settings.error * settings.error;
+  float resultError = 0.0f;
+
+  for (uint32_t pass = 0; destination.size() / 3 > targetTriangleCount; pass++)
+  {
+    if (pass > 0)
+    {
+      edges.build(destination, nullptr);
+    }
+
+    // Triangles around every position, for the flip checks
+    std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+    for (uint32_t index : destination)
+    {
+      adjacencyOffsets[remap[index] + 1]++;
+    }
+    std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+    adjacency.resize(destination.size());
+    {
+      std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+      for (size_t i = 0; i < destination.size(); i++)
+      {
+        adjacency[fill[remap[destination[i]]]++] = uint32_t(i / 3);
+      }
+    }
+
+    // Cheapest allowed direction of every edge
+    collapses.clear();
+    for (size_t i = 0; i < destination.size(); i += 3)
+    {
+      for (uint32_t e = 0; e < 3; e++)
+      {
+        uint32_t a = destination[i + e];
+        uint32_t b = destination[i + (e + 1) % 3];
+        if (remap[a] == remap[b])
+        {
+          continue;
+        }
+
+        // Closed edges show up once from each side
+        bool open = !edges.contains(b, a);
+        if (!open && a > b)
+        {
+          continue;
+        }
+
+        bool forward = canCollapse(a, b, open);
+        bool backward = canCollapse(b, a, open);
+        if (!forward && !backward)
+        {
+          continue;
+        }
+
+        float forwardCost = forward ? collapseCost(a, b) : FLT_MAX;
+        float backwardCost = backward ? collapseCost(b, a) : FLT_MAX;
+        if (forwardCost <= backwardCost)
+        {
+          collapses.push_back({a, b, forwardCost});
+        }
+        else
+        {
+          collapses.push_back({b, a, backwardCost});
+        }
+      }
+    }
+
+    std::sort(collapses.begin(), collapses.end(), [](Collapse const &a, Collapse const &b) {
+      return a.cost < b.cost;
+    });
+
+    // Apply the cheapest collapses, touching every position at most once per pass. Every collapse locks the one-ring of the
+    // vertex it removes, so the triangles its flip check saw keep their corners until the next pass. As that locks the
+    // neighbours out of the pass, the pass error is limited to a little above that of the collapse that would reach the goal if none were locked
+    size_t const triangleGoal = destination.size() / 3 - targetTriangleCount;
+    size_t const collapseGoal = (triangleGoal + 1) / 2;
+    float passErrorLimit = errorLimit;
+    if (collapseGoal < collapses.size())
+    {
+      passErrorLimit = (glm::min)(passErrorLimit, 1.5f * collapses[collapseGoal].cost);
+    }
+
+    size_t removedTriangles = 0;
+    size_t appliedCount = 0;
+    std::vector<uint32_t> changed;
+    for (auto const &collapse : collapses)
+    {
+      // Each collapse is expected to lock about six others, so a pass that gets less than a sixth of the way below its limit, for
+      // instance because the cheapest collapses flip triangles, may continue up to the error limit
+      if (collapse.cost > errorLimit || (collapse.cost > passErrorLimit && appliedCount * 6 >= collapseGoal) || removedTriangles >= triangleGoal)
+      {
+        break;
+      }
+
+      uint32_t vertexPosition = remap[collapse.vertex];
+      uint32_t targetPosition = remap[collapse.target];
+      if (collapseLocked[vertexPosition] || collapseLocked[targetPosition])
+      {
+        continue;
+      }
+
+      if (hasTriangleFlips(collapse.vertex, collapse.target))
+      {
+        continue;
+      }
+
+      collapseRemap[collapse.vertex] = collapse.target;
+      changed.push_back(collapse.vertex);
+      if (kinds[collapse.vertex] == VK_Seam)
+      {
+        collapseRemap[wedges[collapse.vertex]] = wedges[collapse.target];
+        changed.push_back(wedges[collapse.vertex]);
+      }
+
+      quadrics[targetPosition].add(quadrics[vertexPosition]);
+      for (uint32_t a = adjacencyOffsets[vertexPosition]; a < adjacencyOffsets[vertexPosition + 1]; a++)
+      {
+        for (uint32_t e = 0; e < 3; e++)
+        {
+          collapseLocked[remap[destination[adjacency[a] * 3 + e]]] = 1;
+        }
+      }
+
+      removedTriangles += kinds[collapse.vertex] == VK_Border ? 1 : 2;
+      resultError = (glm::max)(resultError, collapse.cost);
+      appliedCount++;
+    }
+
+    if (appliedCount == 0)
+    {
+      break;
+    }
+
+    // Rewrite the triangles, dropping the ones that collapsed
+    size_t indexCount = 0;
+    for (size_t i = 0; i < destination.size(); i += 3)
+    {
+      uint32_t a = collapseRemap[destination[i]];
+      uint32_t b = collapseRemap[destination[i + 1]];
+      uint32_t c = collapseRemap[destination[i + 2]];
+      if (remap[a] == remap[b] || remap[b] == remap[c] || remap[c] == remap[a])
+      {
+        continue;
+      }
+
+      destination[indexCount++] = a;
+      destination[indexCount++] = b;
+      destination[indexCount++] = c;
+    }
+    destination.resize(indexCount);
+
+    for (uint32_t vertex : changed)
+    {
+      collapseRemap[vertex] = vertex;
+    }
+    std::fill(collapseLocked.begin(), collapseLocked.end(), 0);
+  }
+
+  return std::sqrt(resultError);
+}
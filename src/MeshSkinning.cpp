@@ -0,0 +1,47 @@
+#include "MeshSkinning.hpp"
+
+void meshing::addBoneInfluence(KXF::Vertex &vertex, uint32_t &influenceCount, uint32_t bone, float weight)
+{
+  uint32_t slot = influenceCount;
+  if (slot >= maxBoneInfluences)
+  {
+    slot = 0;
+    for (uint32_t c = 1; c < maxBoneInfluences; c++)
+    {
+      slot = vertex.weights[c] < vertex.weights[slot] ? c : slot;
+    }
+
+    if (weight <= vertex.weights[slot])
+    {
+      influenceCount++;
+      return;
+    }
+  }
+
+  vertex.bones[slot] = bone;
+  vertex.weights[slot] = weight;
+  influenceCount++;
+}
+
+uint64_t meshing::normalizeBoneWeights(std::vector<KXF::Vertex> &vertices, std::vector<uint32_t> const &influenceCounts)
+{
+  uint64_t overflowCount = 0;
+  for (size_t i = 0; i < vertices.size(); i++)
+  {
+    if (influenceCounts[i] == 0)
+    {
+      continue;
+    }
+
+    overflowCount += influenceCounts[i] > maxBoneInfluences ? 1 : 0;
+
+    glm::vec4 &weights = vertices[i].weights;
+    float sum = weights.x + weights.y + weights.z + weights.w;
+    if (sum > 0.0f)
+    {
+      weights = weights * (1.0f / sum);
+    }
+  }
+
+  return overflowCount;
+}
@@ -0,0 +1,207 @@
+#include "MeshWelding.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+  // Position, normal, tangent, four texture coordinates and four bone/weight pairs
+  constexpr uint32_t maxKeySize = 3 + 3 + 4 + 4 * 2 + 4 * 2;
+
+  struct VertexKey
+  {
+    int64_t values[maxKeySize];
+    uint32_t size = 0;
+
+    bool operator==(VertexKey const &other) const
+    {
+      return size == other.size && std::memcmp(values, other.values, size * sizeof(int64_t)) == 0;
+    }
+  };
+
+  /** Snaps a value to a multiple of epsilon, or to its exact bit pattern if epsilon is 0 */
+  int64_t quantize(float value, float epsilon)
+  {
+    if (epsilon > 0.0f)
+    {
+      return int64_t(std::floor(double(value) / double(epsilon) + 0.5));
+    }
+
+    // -0 and 0 are the same value
+    if (value == 0.0f)
+    {
+      return 0;
+    }
+
+    int32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+
+  /** Quantizes the attributes the vertex flags enable */
+  void buildKey(KXF::Vertex const &vertex, KXF::VertexFlags flags, meshing::WeldSettings const &settings, VertexKey &key)
+  {
+    key.size = 0;
+    auto add = [&](float value, float epsilon) {
+      key.values[key.size++] = quantize(value, epsilon);
+    };
+
+    add(vertex.position.x, settings.position);
+    add(vertex.position.y, settings.position);
+    add(vertex.position.z, settings.position);
+
+    if (flags & KXF::VF_Normal)
+    {
+      add(vertex.normal.x, settings.normal);
+      add(vertex.normal.y, settings.normal);
+      add(vertex.normal.z, settings.normal);
+    }
+
+    // The tangent w holds the bitangent sign, so mirrored UV seams stay split
+    if (flags & KXF::VF_Tangent)
+    {
+      add(vertex.tangent.x, settings.tangent);
+      add(vertex.tangent.y, settings.tangent);
+      add(vertex.tangent.z, settings.tangent);
+      add(vertex.tangent.w, settings.tangent);
+    }
+
+    KXF::VertexFlags const texCoordFlags[4] = {KXF::VF_TexCoords1, KXF::VF_TexCoords2, KXF::VF_TexCoords3, KXF::VF_TexCoords4};
+    glm::vec4 const *texCoords[4] = {&vertex.texCoords1, &vertex.texCoords2, &vertex.texCoords3, &vertex.texCoords4};
+    for (uint32_t i = 0; i < 4; i++)
+    {
+      if (flags & texCoordFlags[i])
+      {
+        add(texCoords[i]->x, settings.texCoord);
+        add(texCoords[i]->y, settings.texCoord);
+      }
+    }
+
+    if (flags & KXF::VF_Bones)
+    {
+      for (uint32_t i = 0; i < 4; i++)
+      {
+        int64_t weight = quantize(vertex.weights[i], settings.weight);
+        key.values[key.size++] = weight;
+
+        // The bone of an unused slot doesn't affect the vertex
+        key.values[key.size++] = weight != 0 ? int64_t(vertex.bones[i]) : 0;
+      }
+    }
+  }
+
+  uint64_t hashKey(VertexKey const &key)
+  {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (uint32_t i = 0; i < key.size; i++)
+    {
+      hash ^= uint64_t(key.values[i]) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    }
+
+    // Finalize, so that the low bits used for the table slot depend on every value
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    return hash;
+  }
+} // namespace
+
+uint64_t meshing::weldVertices(KXF::Submesh *submesh, WeldSettings const &settings)
+{
+  auto &vertices = submesh->vertices;
+  auto &indices = submesh->indices;
+  size_t vertexCount = vertices.size();
+  if (vertexCount == 0)
+  {
+    return 0;
+  }
+
+  // Open addressing table of welded vertex indices, kept at most half full
+  size_t tableSize = 1;
+  while (tableSize < vertexCount * 2)
+  {
+    tableSize <<= 1;
+  }
+  size_t const tableMask = tableSize - 1;
+  constexpr uint32_t emptySlot = UINT32_MAX;
+
+  std::vector<uint32_t> table(tableSize, emptySlot);
+  std::vector<uint64_t> weldedHashes(vertexCount);
+  std::vector<uint32_t> remap(vertexCount);
+
+  VertexKey key;
+  VertexKey candidateKey;
+  uint32_t weldedCount = 0;
+  for (size_t i = 0; i < vertexCount; i++)
+  {
+    buildKey(vertices[i], submesh->vertexFlags, settings, key);
+    uint64_t hash = hashKey(key);
+
+    for (size_t slot = hash & tableMask;; slot = (slot + 1) & tableMask)
+    {
+      uint32_t candidate = table[slot];
+      if (candidate == emptySlot)
+      {
+        // Welded vertices are compacted in place, in the order they first appear
+        table[slot] = weldedCount;
+        weldedHashes[weldedCount] = hash;
+        if (weldedCount != i)
+        {
+          vertices[weldedCount] = vertices[i];
+        }
+        remap[i] = weldedCount++;
+        break;
+      }
+
+      if (weldedHashes[candidate] == hash)
+      {
+        buildKey(vertices[candidate], submesh->vertexFlags, settings, candidateKey);
+        if (candidateKey == key)
+        {
+          remap[i] = candidate;
+          break;
+        }
+      }
+    }
+  }
+
+  // Remap the triangles, dropping the ones whose corners were merged together
+  size_t indexCount = 0;
+  for (size_t i = 0; i + 2 < indices.size(); i += 3)
+  {
+    uint32_t a = remap[indices[i]];
+    uint32_t b = remap[indices[i + 1]];
+    uint32_t c = remap[indices[i + 2]];
+    if (a == b || b == c || c == a)
+    {
+      continue;
+    }
+
+    indices[indexCount++] = a;
+    indices[indexCount++] = b;
+    indices[indexCount++] = c;
+  }
+  indices.resize(indexCount);
+
+  vertices.resize(weldedCount);
+  vertices.shrink_to_fit();
+
+  return vertexCount - weldedCount;
+}
+
+uint64_t meshing::weldVertices(std::vector<KXF::Submesh *> const &submeshes, WeldSettings const &settings)
+{
+  uint64_t removedCount = 0;
+  int64_t submeshCount = int64_t(submeshes.size());
+
+  // Submeshes share nothing, so each one is welded on a single thread
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) reduction(+ : removedCount)
+#endif
+  for (int64_t i = 0; i < submeshCount; i++)
+  {
+    removedCount += weldVertices(submeshes[i], settings);
+  }
+
+  return removedCount;
+}
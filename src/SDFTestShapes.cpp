@@ -0,0 +1,86 @@
+#include "SDFTestShapes.hpp"
+
+#include "MSDF/msdfgen.h"
+
+#include <WIR/Math.hpp>
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+  constexpr double pi = 3.14159265358979323846;
+
+  /** Vertex of the wavy outline at an angle, every eighth one sticks out into an acute spike */
+  msdfgen::Point2 wavyPoint(msdfgen::Point2 const &center, double radius, double angle, int vertex)
+  {
+    double wave = radius * (1.0 + 0.12 * std::sin(5.0 * angle) + 0.03 * std::sin(13.0 * angle) + (vertex % 8 == 4 ? 0.35 : 0.0));
+    return msdfgen::Point2(center.x + wave * std::cos(angle), center.y + wave * std::sin(angle));
+  }
+
+  /**
+   * Adds a closed contour of edgeCount edges around the center. Every third edge is linear, the others bulge their control
+   * points off the chord, alternately outwards and inwards, and the cubic ones into an S so they carry an inflection. Bulges
+   * are sized by the spacing of the vertices rather than the chord, which keeps the long sides of the spikes from crossing.
+   */
+  void addWavyContour(msdfgen::Shape &shape, msdfgen::Point2 const &center, double radius, int edgeCount, double phase)
+  {
+    std::vector<msdfgen::Point2> vertices;
+    for (int i = 0; i < edgeCount; i++)
+    {
+      vertices.push_back(wavyPoint(center, radius, phase + 2.0 * pi * i / edgeCount, i));
+    }
+
+    double spacing = 2.0 * pi * radius / edgeCount;
+
+    msdfgen::Contour &contour = shape.addContour();
+    for (int i = 0; i < edgeCount; i++)
+    {
+      msdfgen::Point2 const &from = vertices[i];
+      msdfgen::Point2 const &to = vertices[(i + 1) % edgeCount];
+
+      msdfgen::Vector2 chord = to - from;
+      msdfgen::Vector2 bulge = chord.getOrthonormal() * (spacing * (i % 2 == 0 ? 0.25 : -0.2));
+
+      switch (i % 3)
+      {
+      case 0:
+        contour.addEdge(msdfgen::EdgeHolder(from, to));
+        break;
+      case 1:
+        contour.addEdge(msdfgen::EdgeHolder(from, from + 0.5 * chord + bulge, to));
+        break;
+      default:
+        contour.addEdge(msdfgen::EdgeHolder(from, from + chord / 3.0 + bulge, from + 2.0 * chord / 3.0 - 0.5 * bulge, to));
+        break;
+      }
+    }
+  }
+} // namespace
+
+void sdftest::createWavyShape(msdfgen::Shape &shape, int edgeCount)
+{
+  shape.contours.clear();
+  shape.inverseYAxis = false;
+
+  addWavyContour(shape, msdfgen::Point2(500.0, 500.0), 450.0, edgeCount, 0.1);
+
+  int holeEdgeCount = (glm::max)(3, edgeCount / 6);
+  addWavyContour(shape, msdfgen::Point2(280.0, 500.0), 90.0, holeEdgeCount, 0.7);
+  addWavyContour(shape, msdfgen::Point2(720.0, 530.0), 90.0, holeEdgeCount, 1.9);
+
+  shape.normalize();
+  shape.orientContours();
+  msdfgen::edgeColoringSimple(shape, 3.0);
+}
+
+void sdftest::frameShape(msdfgen::Shape const &shape, int width, int height, double pixelRange, msdfgen::Vector2 &scale, msdfgen::Vector2 &translate, double &range)
+{
+  double left = 1e240, bottom = 1e240, right = -1e240, top = -1e240;
+  shape.bound(left, bottom, right, top);
+
+  double fit = (glm::min)((width - 2.0 * pixelRange) / (right - left), (height - 2.0 * pixelRange) / (top - bottom));
+  scale = msdfgen::Vector2(fit, fit);
+  translate = msdfgen::Vector2(0.5 * (width / fit - (right - left)) - left, 0.5 * (height / fit - (top - bottom)) - bottom);
+  range = pixelRange / fit;
+}